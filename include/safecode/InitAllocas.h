@@ -19,8 +19,11 @@
 
 #include "llvm/Pass.h"
 #include "llvm/InstVisitor.h"
+#include "llvm/Analysis/Dominators.h"
 #include "llvm/IR/DataLayout.h"
 
+#include <vector>
+
 namespace llvm {
 
 //
@@ -33,6 +36,9 @@ namespace llvm {
 //  allocation (since the heap allocator must provide similar protection for
 //  heap allocated memory) or be inserting special initialization code.
 //
+//  Only allocas that may hold pointers are initialized, and allocas that are
+//  always completely written before they are read are left alone.
+//
 struct InitAllocas : public FunctionPass, InstVisitor<InitAllocas> {
   public:
     static char ID;
@@ -42,9 +48,17 @@ struct InitAllocas : public FunctionPass, InstVisitor<InitAllocas> {
     bool doInitialization (Module & M);
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.addRequired<DataLayout>();
+      AU.addRequired<DominatorTree>();
       AU.setPreservesCFG();
     }
     void visitAllocaInst (AllocaInst & AI);
+
+  private:
+    bool isInitializedBeforeRead (AllocaInst & AI);
+    void initPointerFields (AllocaInst & AI,
+                            std::vector<std::vector<Value *> > & Fields,
+                            Instruction * InsertPt);
+    void initWholeAlloca (AllocaInst & AI, Instruction * InsertPt);
 };
 
 }
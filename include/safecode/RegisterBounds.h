@@ -56,7 +56,10 @@ protected:
 };
 
 /// Register the bound information of global variables.
-/// All registeration are placed at sc.register_globals
+/// All registeration are placed at sc.register_globals.  With
+/// -sc-bulk-register-globals, the globals are listed in a single read-only
+/// table (sc.global_table) registered by one call to
+/// pool_register_globals_bulk.
 class RegisterGlobalVariables : public RegisterVariables {
 public:
   static char ID;
@@ -77,7 +80,11 @@ private:
   DataLayout * TD;
 
   // Private methods
+  unsigned getRegistrationSize(GlobalVariable * GV);
   void registerGV(GlobalVariable * GV, Instruction * InsertBefore);
+  void registerGlobalTable(Module & M,
+                           const std::vector<GlobalVariable *> & Globals,
+                           Instruction * InsertBefore);
 };
 
 /// Register the bound information of argv[] in main().
@@ -0,0 +1,67 @@
+//===- UnsafeStack.h - Move escaping allocas to the unsafe stack -------------//
+//
+//                          The SAFECode Compiler
+//
+// This file was developed by the LLVM research group and is distributed under
+// the University of Illinois Open Source License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a pass that moves stack allocations whose address may
+// escape from their function onto the per-thread unsafe stack implemented by
+// the SAFECode run-time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SAFECODE_UNSAFESTACK_H
+#define SAFECODE_UNSAFESTACK_H
+
+#include "llvm/Pass.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Instructions.h"
+
+namespace llvm {
+
+//
+// Pass: USConvertUnsafeAllocas
+//
+// Description:
+//  This pass moves stack allocations that are unsafe to leave on the native
+//  stack onto a separate, per-thread "unsafe stack" managed by the SAFECode
+//  run-time.  An allocation is unsafe if its address may escape into memory
+//  or into another function, from where it could be used after the function
+//  returns.  This replaces the promotion of such allocations to the heap.
+//
+// Notes:
+//  o) Each function with moved allocations saves the top of the unsafe
+//     stack on entry and restores it on every return, popping all of its
+//     unsafe objects at once.  No heap allocator calls are made.
+//  o) The run-time records the bounds of unsafe stack objects itself, so the
+//     stack registrations of the moved allocations are removed.
+//
+struct USConvertUnsafeAllocas : public ModulePass {
+  public:
+    static char ID;
+    USConvertUnsafeAllocas () : ModulePass (ID) {}
+    const char *getPassName() const {
+      return "Convert Unsafe Allocas to the Unsafe Stack";
+    }
+    virtual bool runOnModule (Module & M);
+    virtual void getAnalysisUsage (AnalysisUsage & AU) const {
+      AU.addRequired<DataLayout>();
+    }
+
+  private:
+    DataLayout * TD;
+    Constant * UnsafeStackSave;
+    Constant * UnsafeStackAlloc;
+    Constant * UnsafeStackRestore;
+
+    bool convertFunction (Function & F);
+    void removeRegistrations (AllocaInst * AI);
+    void promoteAlloca (AllocaInst * AI);
+};
+
+}
+
+#endif
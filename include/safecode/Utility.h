@@ -319,6 +319,34 @@ destroyFunction (Function * F) {
   return;
 }
 
+//
+// Function: isGlobalRegistrationEntry()
+//
+// Description:
+//  Determine whether the specified constant is an entry of the global
+//  registration table (sc.global_table) built by the RegisterGlobalVariables
+//  pass.  Such an entry registers a global without letting it escape.
+//
+static inline bool
+isGlobalRegistrationEntry (Constant * C) {
+  if (!isa<ConstantStruct>(C))
+    return false;
+
+  for (Value::use_iterator UI = C->use_begin(); UI != C->use_end(); ++UI) {
+    ConstantArray * CA = dyn_cast<ConstantArray>(*UI);
+    if (!CA)
+      return false;
+
+    for (Value::use_iterator AI = CA->use_begin(); AI != CA->use_end(); ++AI) {
+      GlobalVariable * GV = dyn_cast<GlobalVariable>(*AI);
+      if (!GV || (GV->getName() != "sc.global_table"))
+        return false;
+    }
+  }
+
+  return true;
+}
+
 //
 // Function: escapesToMemory()
 //
@@ -395,6 +423,15 @@ escapesToMemory (Value * V) {
         continue;
       }
 
+      //
+      // Entries of the global registration table are okay.
+      //
+      if (isa<ConstantStruct>(*UI)) {
+        if (isGlobalRegistrationEntry (cast<Constant>(*UI)))
+          continue;
+        return true;
+      }
+
       //
       // Constant expressions are okay, too.
       //
@@ -449,6 +486,8 @@ escapesToMemory (Value * V) {
                    (FuncName == "pool_register_debug")  ||
                    (FuncName == "pool_register_stack_debug")  ||
                    (FuncName == "pool_register_global_debug")  ||
+                   (FuncName == "pool_unregister_stack")  ||
+                   (FuncName == "pool_unregister_stack_debug")  ||
                    (FuncName == "memcmp")) {
           continue;
         } else {
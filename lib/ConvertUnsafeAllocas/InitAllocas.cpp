@@ -15,7 +15,9 @@
 //   o) Insert code to initialize the newly allocated memory.
 //
 // The current implementation implements the latter, but code for the former is
-// available but disabled.
+// available but disabled.  Only allocas that may hold pointers are
+// initialized; allocas that are always completely written before being read
+// are skipped, and objects with few pointers have just those pointers nulled.
 //
 //===----------------------------------------------------------------------===//
 
@@ -32,9 +34,11 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/Debug.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace llvm;
@@ -45,9 +49,15 @@ static RegisterPass<InitAllocas>
 Z ("initallocas", "Initialize stack allocations containing pointers");
 
 namespace {
-  STATISTIC (InitedAllocas, "Allocas Initialized");
+  STATISTIC (InitedAllocas,  "Allocas Initialized");
+  STATISTIC (SkippedAllocas, "Allocas Not Needing Initialization");
+  STATISTIC (PointerStores,  "Pointer Fields Initialized with Stores");
+  STATISTIC (MemsetBytes,    "Bytes Initialized with memset");
 }
 
+// Maximum number of pointers in an alloca initialized with separate stores
+static const unsigned MaxPointerStores = 8;
+
 //
 // Function: getInsertionPoint()
 //
@@ -71,6 +81,174 @@ getInsertionPoint (AllocaInst & AI) {
   return InsertPt;
 }
 
+
+//
+// Function: getInt32Type()
+//
+// Description:
+//  Return the 32-bit integer type used for indexing into aggregates.
+//
+static inline Type *
+getInt32Type (AllocaInst & AI) {
+  return IntegerType::getInt32Ty (AI.getContext());
+}
+
+//
+// Function: containsPointer()
+//
+// Description:
+//  Determine whether the specified type is or contains a pointer.
+//
+static bool
+containsPointer (Type * Ty) {
+  if (isa<PointerType>(Ty))
+    return true;
+
+  if (StructType * ST = dyn_cast<StructType>(Ty)) {
+    for (unsigned index = 0; index < ST->getNumElements(); ++index)
+      if (containsPointer (ST->getElementType (index)))
+        return true;
+    return false;
+  }
+
+  if (SequentialType * ST = dyn_cast<SequentialType>(Ty))
+    return containsPointer (ST->getElementType());
+
+  return false;
+}
+
+//
+// Function: findPointerFields()
+//
+// Description:
+//  Find the indices of all pointers within a value of the specified type.
+//
+// Inputs:
+//  Ty   - The type to search.
+//  Path - The GEP indices leading to a value of the specified type.
+//
+// Outputs:
+//  Fields - The GEP indices of each pointer is appended to this vector.
+//
+// Return value:
+//  true  - All pointers were found.
+//  false - There are too many pointers to initialize them one by one, or
+//          some are inside of vectors.
+//
+static bool
+findPointerFields (Type * Ty,
+                   std::vector<Value *> & Path,
+                   std::vector<std::vector<Value *> > & Fields) {
+  if (isa<PointerType>(Ty)) {
+    Fields.push_back (Path);
+    return (Fields.size() <= MaxPointerStores);
+  }
+
+  if (!containsPointer (Ty))
+    return true;
+
+  Type * Int32Type = IntegerType::getInt32Ty (Ty->getContext());
+  if (StructType * ST = dyn_cast<StructType>(Ty)) {
+    for (unsigned index = 0; index < ST->getNumElements(); ++index) {
+      Path.push_back (ConstantInt::get (Int32Type, index));
+      bool Found = findPointerFields (ST->getElementType (index), Path, Fields);
+      Path.pop_back();
+      if (!Found)
+        return false;
+    }
+    return true;
+  }
+
+  if (ArrayType * AT = dyn_cast<ArrayType>(Ty)) {
+    if (AT->getNumElements() > MaxPointerStores)
+      return false;
+    for (unsigned index = 0; index < AT->getNumElements(); ++index) {
+      Path.push_back (ConstantInt::get (Int32Type, index));
+      bool Found = findPointerFields (AT->getElementType(), Path, Fields);
+      Path.pop_back();
+      if (!Found)
+        return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+//
+// Function: mayHoldPointer()
+//
+// Description:
+//  Determine whether the memory allocated by the alloca may hold a pointer.
+//  This is the case if its type contains a pointer or if the program accesses
+//  it as a type containing a pointer (e.g., a union lowered to a byte array).
+//
+// Notes:
+//  Only loads, stores, memset()s, casts, and indexing of the alloca are
+//  understood.  Any other use (e.g., passing the alloca to a function, a phi,
+//  a select, or a memcpy()) may put a pointer into the memory, so the alloca
+//  is assumed to hold pointers.
+//
+static bool
+mayHoldPointer (AllocaInst & AI) {
+  if (containsPointer (AI.getAllocatedType()))
+    return true;
+
+  std::vector<Value *> Worklist (1, &AI);
+  while (Worklist.size()) {
+    Value * V = Worklist.back();
+    Worklist.pop_back();
+    for (Value::use_iterator UI = V->use_begin(), UE = V->use_end();
+         UI != UE;
+         ++UI) {
+      if (LoadInst * LI = dyn_cast<LoadInst>(*UI)) {
+        if (containsPointer (LI->getType()))
+          return true;
+        continue;
+      }
+
+      if (StoreInst * SI = dyn_cast<StoreInst>(*UI)) {
+        //
+        // Storing the pointer itself lets it escape.
+        //
+        if (SI->getValueOperand() == V)
+          return true;
+        if (containsPointer (SI->getValueOperand()->getType()))
+          return true;
+        continue;
+      }
+
+      if (isa<BitCastInst>(*UI) || isa<GetElementPtrInst>(*UI)) {
+        Type * ElemType = cast<PointerType>(UI->getType())->getElementType();
+        if (containsPointer (ElemType))
+          return true;
+        Worklist.push_back (*UI);
+        continue;
+      }
+
+      //
+      // A memset() only writes plain bytes into the memory.
+      //
+      if (MemSetInst * MS = dyn_cast<MemSetInst>(*UI)) {
+        if (MS->getRawDest() == V)
+          continue;
+        return true;
+      }
+
+      if (IntrinsicInst * II = dyn_cast<IntrinsicInst>(*UI)) {
+        if ((II->getIntrinsicID() == Intrinsic::lifetime_start) ||
+            (II->getIntrinsicID() == Intrinsic::lifetime_end) ||
+            isa<DbgInfoIntrinsic>(II))
+          continue;
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
 namespace llvm {
 
 bool
@@ -100,24 +278,178 @@ InitAllocas::doInitialization (Module & M) {
 }
 
 //
-// Method: visitAllocaInst()
+// Method: isInitializedBeforeRead()
 //
 // Description:
-//  This method instruments an alloca instruction so that it is zero'ed out
-//  before any data is loaded from it.
+//  Determine whether the memory allocated by the given alloca is completely
+//  written on every path before any of it can be read.  Such allocas never
+//  expose uninitialized pointers and need no initialization.
 //
-void
-InitAllocas::visitAllocaInst (AllocaInst & AI) {
+// Notes:
+//  The analysis is conservative.  An instruction initializes the alloca only
+//  if it writes the whole object (a store of the allocated type or a
+//  memset()/memcpy() of at least its size to its beginning).  Every other use
+//  that may read the memory or let the pointer escape must be dominated by
+//  such an instruction.  Stores of part of the object neither read nor
+//  initialize it.
+//
+bool
+InitAllocas::isInitializedBeforeRead (AllocaInst & AI) {
   //
-  // Scan for a place to insert the instruction to initialize the
-  // allocated memory.
+  // We cannot reason about the size of dynamically sized allocations.
   //
-  Instruction * InsertPt = getInsertionPoint (AI);
+  if (AI.isArrayAllocation())
+    return false;
+
+  DataLayout & TD = getAnalysis<DataLayout>();
+  uint64_t Size = TD.getTypeAllocSize (AI.getAllocatedType());
+
+  //
+  // Find all uses of pointers derived from the alloca.  Each worklist entry
+  // records whether the pointer points to the beginning of the alloca.
+  //
+  std::vector<Instruction *> Inits;
+  std::vector<Instruction *> Reads;
+  std::vector<std::pair<Value *, bool> > Worklist;
+  Worklist.push_back (std::make_pair (&AI, true));
+  while (Worklist.size()) {
+    Value * V = Worklist.back().first;
+    bool AtStart = Worklist.back().second;
+    Worklist.pop_back();
+
+    for (Value::use_iterator UI = V->use_begin(), UE = V->use_end();
+         UI != UE;
+         ++UI) {
+      Instruction * I = dyn_cast<Instruction>(*UI);
+      if (!I)
+        return false;
+
+      if (StoreInst * SI = dyn_cast<StoreInst>(I)) {
+        //
+        // Storing the pointer itself lets it escape.
+        //
+        if (SI->getValueOperand() == V) {
+          Reads.push_back (SI);
+          continue;
+        }
+
+        Type * StoredType = SI->getValueOperand()->getType();
+        if (AtStart && (TD.getTypeStoreSize (StoredType) >= Size))
+          Inits.push_back (SI);
+        continue;
+      }
+
+      if (isa<LoadInst>(I)) {
+        Reads.push_back (I);
+        continue;
+      }
+
+      if (isa<BitCastInst>(I)) {
+        Worklist.push_back (std::make_pair (I, AtStart));
+        continue;
+      }
+
+      if (GetElementPtrInst * GEP = dyn_cast<GetElementPtrInst>(I)) {
+        bool GEPAtStart = AtStart && GEP->hasAllZeroIndices();
+        Worklist.push_back (std::make_pair (I, GEPAtStart));
+        continue;
+      }
+
+      if (MemIntrinsic * MI = dyn_cast<MemIntrinsic>(I)) {
+        //
+        // Reading from the alloca with memcpy() or memmove() is a read.
+        //
+        if (MI->getRawDest() != V) {
+          Reads.push_back (I);
+          continue;
+        }
+
+        ConstantInt * Length = dyn_cast<ConstantInt>(MI->getLength());
+        if (AtStart && Length && (Length->getZExtValue() >= Size))
+          Inits.push_back (I);
+        continue;
+      }
+
+      //
+      // Markers of the object's lifetime and debug information neither read
+      // nor write the memory.
+      //
+      if (IntrinsicInst * II = dyn_cast<IntrinsicInst>(I)) {
+        if ((II->getIntrinsicID() == Intrinsic::lifetime_start) ||
+            (II->getIntrinsicID() == Intrinsic::lifetime_end) ||
+            isa<DbgInfoIntrinsic>(II))
+          continue;
+      }
+
+      //
+      // Anything else (calls, comparisons, phis, etc.) may read the memory or
+      // let the pointer escape.
+      //
+      Reads.push_back (I);
+    }
+  }
+
+  if (Inits.empty())
+    return false;
 
   //
-  // Zero the alloca with a memset.  If this is done more efficiently with stores
-  // SelectionDAG will lower it appropriately based on target information.
+  // Ensure that each read is dominated by an instruction that initializes
+  // the whole object.
   //
+  DominatorTree & DT = getAnalysis<DominatorTree>();
+  for (unsigned index = 0; index < Reads.size(); ++index) {
+    bool Dominated = false;
+    for (unsigned init = 0; init < Inits.size() && !Dominated; ++init) {
+      if ((Inits[init] != Reads[index]) &&
+          DT.dominates (Inits[init], Reads[index]))
+        Dominated = true;
+    }
+    if (!Dominated)
+      return false;
+  }
+
+  return true;
+}
+
+//
+// Method: initPointerFields()
+//
+// Description:
+//  Initialize each pointer within the allocated object with a separate store
+//  of a null pointer.
+//
+// Inputs:
+//  AI       - The alloca to initialize.
+//  Fields   - The GEP indices of each pointer within the allocated object.
+//  InsertPt - The instruction before which to insert the stores.
+//
+void
+InitAllocas::initPointerFields (AllocaInst & AI,
+                                std::vector<std::vector<Value *> > & Fields,
+                                Instruction * InsertPt) {
+  for (unsigned index = 0; index < Fields.size(); ++index) {
+    Value * FieldPtr = &AI;
+    if (Fields[index].size() > 1)
+      FieldPtr = GetElementPtrInst::CreateInBounds (&AI,
+                                                    Fields[index],
+                                                    AI.getName().str(),
+                                                    InsertPt);
+    Type * FieldType = cast<PointerType>(FieldPtr->getType())->getElementType();
+    new StoreInst (Constant::getNullValue (FieldType), FieldPtr, InsertPt);
+    ++PointerStores;
+  }
+}
+
+//
+// Method: initWholeAlloca()
+//
+// Description:
+//  Zero the entire allocated object with a memset.  If this is done more
+//  efficiently with stores SelectionDAG will lower it appropriately based on
+//  target information.
+//
+void
+InitAllocas::initWholeAlloca (AllocaInst & AI, Instruction * InsertPt) {
   DataLayout & TD = getAnalysis<DataLayout>();
 
   //
@@ -129,6 +461,33 @@ InitAllocas::visitAllocaInst (AllocaInst & AI) {
   Type * VoidPtrType = getVoidPtrType (AI.getContext());
   Type * AllocType = AI.getAllocatedType();
 
+  //
+  // Determine the number of bytes to zero.  Dynamically sized allocas need
+  // a multiplication by the number of elements.
+  //
+  uint64_t TypeSize = TD.getTypeAllocSize (AllocType);
+  Value * Length = ConstantInt::get (Int32Type, TypeSize);
+  if (AI.isArrayAllocation()) {
+    Value * Count = AI.getArraySize();
+    if (ConstantInt * C = dyn_cast<ConstantInt>(Count)) {
+      Length = ConstantInt::get (Int32Type, TypeSize * C->getZExtValue());
+    } else {
+      Count = CastInst::CreateIntegerCast (Count, Int32Type, false,
+                                           Count->getName(), InsertPt);
+      Length = BinaryOperator::Create (Instruction::Mul, Length, Count,
+                                       "sizetmp", InsertPt);
+    }
+  }
+  if (ConstantInt * C = dyn_cast<ConstantInt>(Length))
+    MemsetBytes += C->getZExtValue();
+
+  //
+  // Tell the code generator the real alignment of the alloca so that it can
+  // zero the memory with the widest stores the target has.
+  //
+  unsigned Alignment = std::max (AI.getAlignment(),
+                                 TD.getABITypeAlignment (AllocType));
+
   //
   // Create a call to memset.
   //
@@ -137,11 +496,49 @@ InitAllocas::visitAllocaInst (AllocaInst & AI) {
   std::vector<Value *> args;
   args.push_back (castTo (&AI, VoidPtrType, AI.getName().str(), InsertPt));
   args.push_back (ConstantInt::get(Int8Type, 0));
-  args.push_back (ConstantInt::get(Int32Type,TD.getTypeAllocSize(AllocType)));
-  args.push_back (ConstantInt::get(Int32Type,
-                                   TD.getABITypeAlignment(AllocType)));
+  args.push_back (Length);
+  args.push_back (ConstantInt::get(Int32Type, Alignment));
   args.push_back (ConstantInt::get(Int1Type, 0));
   CallInst::Create (Memset, args, "", InsertPt);
+}
+
+//
+// Method: visitAllocaInst()
+//
+// Description:
+//  This method instruments an alloca instruction so that any pointers within
+//  it are zero'ed out before any data is loaded from it.
+//
+void
+InitAllocas::visitAllocaInst (AllocaInst & AI) {
+  //
+  // Allocas that can never hold a pointer or that are always written before
+  // they are read do not need to be initialized.
+  //
+  if (!mayHoldPointer (AI) || isInitializedBeforeRead (AI)) {
+    ++SkippedAllocas;
+    return;
+  }
+
+  //
+  // Scan for a place to insert the instruction to initialize the
+  // allocated memory.
+  //
+  Instruction * InsertPt = getInsertionPoint (AI);
+
+  //
+  // If the object has only a few pointers at statically known locations,
+  // store null into each of them.  Otherwise, zero the whole object.
+  //
+  std::vector<std::vector<Value *> > Fields;
+  std::vector<Value *> Path (1, ConstantInt::get (getInt32Type (AI), 0));
+  if (!AI.isArrayAllocation() &&
+      containsPointer (AI.getAllocatedType()) &&
+      findPointerFields (AI.getAllocatedType(), Path, Fields)) {
+    initPointerFields (AI, Fields, InsertPt);
+  } else {
+    initWholeAlloca (AI, InsertPt);
+  }
 
   //
   // Update statistics.
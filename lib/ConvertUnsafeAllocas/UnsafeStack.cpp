@@ -0,0 +1,216 @@
+//===- UnsafeStack.cpp - Move escaping allocas to the unsafe stack --------===//
+//
+//                          The SAFECode Compiler
+//
+// This file was developed by the LLVM research group and is distributed under
+// the University of Illinois Open Source License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass that moves stack allocations whose address may
+// escape from their function onto the per-thread unsafe stack implemented by
+// the SAFECode run-time (runtime/DebugRuntime/UnsafeStack.cpp).  An escaping
+// stack object could be used after its function returns; on the unsafe stack,
+// its bounds are known to the run-time until the function returns, and a
+// dangling pointer to it can never point into a live native stack frame.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "unsafe-stack"
+
+#include "safecode/UnsafeStack.h"
+#include "safecode/Utility.h"
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Debug.h"
+
+#include <vector>
+
+using namespace llvm;
+
+char llvm::USConvertUnsafeAllocas::ID = 0;
+
+static RegisterPass<USConvertUnsafeAllocas>
+X ("usconvalloca", "Converts Unsafe Allocas to Unsafe Stack Allocations");
+
+namespace {
+  STATISTIC (ConvAllocas,   "Allocas Moved to the Unsafe Stack");
+  STATISTIC (RemovedCalls,  "Stack Registrations Removed");
+}
+
+//
+// Function: isStackRegistration()
+//
+// Description:
+//  Determine whether the given value is a call that registers or unregisters
+//  a stack object with the run-time.
+//
+static bool
+isStackRegistration (Value * V) {
+  CallInst * CI = dyn_cast<CallInst>(V);
+  if (!CI)
+    return false;
+
+  Function * F = CI->getCalledFunction();
+  if (!F)
+    return false;
+
+  StringRef Name = F->getName();
+  return ((Name == "pool_register_stack") ||
+          (Name == "pool_register_stack_debug") ||
+          (Name == "pool_unregister_stack") ||
+          (Name == "pool_unregister_stack_debug"));
+}
+
+namespace llvm {
+
+//
+// Method: removeRegistrations()
+//
+// Description:
+//  Remove the calls that register and unregister the given alloca with the
+//  run-time; the run-time knows the bounds of objects on the unsafe stack.
+//
+void
+USConvertUnsafeAllocas::removeRegistrations (AllocaInst * AI) {
+  std::vector<Instruction *> Dead;
+  for (Value::use_iterator UI = AI->use_begin(); UI != AI->use_end(); ++UI) {
+    if (isStackRegistration (*UI)) {
+      Dead.push_back (cast<Instruction>(*UI));
+      continue;
+    }
+
+    if (CastInst * CI = dyn_cast<CastInst>(*UI)) {
+      for (Value::use_iterator CUI = CI->use_begin(); CUI != CI->use_end();
+           ++CUI) {
+        if (isStackRegistration (*CUI))
+          Dead.push_back (cast<Instruction>(*CUI));
+      }
+    }
+  }
+
+  for (unsigned index = 0; index < Dead.size(); ++index) {
+    Dead[index]->eraseFromParent();
+    ++RemovedCalls;
+  }
+}
+
+//
+// Method: promoteAlloca()
+//
+// Description:
+//  Rewrite the given alloca instruction into an allocation of the same size
+//  on the unsafe stack.
+//
+void
+USConvertUnsafeAllocas::promoteAlloca (AllocaInst * AI) {
+  //
+  // Create the size argument to the allocation.
+  //
+  Type * Int32Type = IntegerType::getInt32Ty (AI->getContext());
+  Value * AllocSize;
+  AllocSize = ConstantInt::get (Int32Type,
+                                TD->getTypeAllocSize(AI->getAllocatedType()));
+  if (AI->isArrayAllocation()) {
+    Value * Count = castTo (AI->getArraySize(), Int32Type, "count", AI);
+    AllocSize = BinaryOperator::Create (Instruction::Mul, AllocSize, Count,
+                                        "sizetmp", AI);
+  }
+
+  //
+  // Allocate the object on the unsafe stack and replace all uses of the old
+  // alloca instruction with it.
+  //
+  Instruction * Obj = CallInst::Create (UnsafeStackAlloc, AllocSize, "", AI);
+  Value * NewAI = castTo (Obj, AI->getType(), AI->getName(), AI);
+  AI->replaceAllUsesWith (NewAI);
+  AI->eraseFromParent();
+  ++ConvAllocas;
+}
+
+//
+// Method: convertFunction()
+//
+// Description:
+//  Move the unsafe allocas of the given function to the unsafe stack.
+//
+// Return value:
+//  true  - The function was modified.
+//  false - The function has no unsafe allocas.
+//
+bool
+USConvertUnsafeAllocas::convertFunction (Function & F) {
+  //
+  // Find the allocas whose address may escape.  The run-time calls that
+  // register the allocas don't let them escape.
+  //
+  std::vector<AllocaInst *> Unsafe;
+  for (Function::iterator BB = F.begin(); BB != F.end(); ++BB) {
+    for (BasicBlock::iterator I = BB->begin(); I != BB->end(); ++I) {
+      if (AllocaInst * AI = dyn_cast<AllocaInst>(I))
+        if (escapesToMemory (AI))
+          Unsafe.push_back (AI);
+    }
+  }
+
+  if (Unsafe.empty())
+    return false;
+
+  //
+  // Save the top of the unsafe stack before anything else is done in the
+  // function, and pop everything allocated by the function (and any callee
+  // that did not clean up after itself) on all exits from the function.
+  //
+  Value * Top = CallInst::Create (UnsafeStackSave, "top",
+                                  F.getEntryBlock().begin());
+  for (Function::iterator BB = F.begin(); BB != F.end(); ++BB) {
+    TerminatorInst * T = BB->getTerminator();
+    if (isa<ReturnInst>(T) || isa<ResumeInst>(T))
+      CallInst::Create (UnsafeStackRestore, Top, "", T);
+  }
+
+  for (unsigned index = 0; index < Unsafe.size(); ++index) {
+    removeRegistrations (Unsafe[index]);
+    promoteAlloca (Unsafe[index]);
+  }
+
+  return true;
+}
+
+bool
+USConvertUnsafeAllocas::runOnModule (Module & M) {
+  TD = &getAnalysis<DataLayout>();
+
+  //
+  // Get references to the unsafe stack run-time functions.
+  //
+  Type * VoidType    = Type::getVoidTy (M.getContext());
+  Type * Int32Type   = IntegerType::getInt32Ty (M.getContext());
+  Type * VoidPtrType = getVoidPtrType (M);
+  UnsafeStackSave = M.getOrInsertFunction ("__sc_unsafestack_save",
+                                           VoidPtrType,
+                                           NULL);
+  UnsafeStackAlloc = M.getOrInsertFunction ("__sc_unsafestack_alloc",
+                                            VoidPtrType,
+                                            Int32Type,
+                                            NULL);
+  UnsafeStackRestore = M.getOrInsertFunction ("__sc_unsafestack_restore",
+                                              VoidType,
+                                              VoidPtrType,
+                                              NULL);
+
+  bool modified = false;
+  for (Module::iterator F = M.begin(); F != M.end(); ++F) {
+    if (!(F->isDeclaration()))
+      modified |= convertFunction (*F);
+  }
+
+  return modified;
+}
+
+}
@@ -15,6 +15,7 @@
 
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InstIterator.h"
 #include "safecode/RegisterBounds.h"
 #include "safecode/AllocatorInfo.h"
@@ -29,6 +30,12 @@ namespace {
   STATISTIC (RegisteredGVs,      "Number of registered global variables");
   STATISTIC (RegisteredByVals,   "Number of registered byval arguments");
   STATISTIC (RegisteredHeapObjs, "Number of registered heap objects");
+
+  // Command line options
+  cl::opt<bool> BulkRegisterGlobals ("sc-bulk-register-globals", cl::Hidden,
+                                     cl::init(false),
+                                     cl::desc("Register globals with a single "
+                                              "registration table"));
 }
 
 namespace llvm {
@@ -52,15 +59,14 @@ static llvm::RegisterPass<RegisterFunctionByvalArguments>
 X4 ("reg-byval-args", "Register byval arguments for functions", true);
 
 //
-// Method: registerGV()
+// Method: getRegistrationSize()
 //
 // Description:
-//  This method adds code into a program to register a global variable into its
-//  pool.
+//  Return the number of bytes to register for the specified global variable,
+//  or zero if the global variable cannot be registered.
 //
-void
-RegisterGlobalVariables::registerGV (GlobalVariable * GV,
-                                     Instruction * InsertBefore) {
+unsigned
+RegisterGlobalVariables::getRegistrationSize (GlobalVariable * GV) {
   //
   // Do not register the global variable if it has opaque type.  This is
   // because we cannot determine the size of an opaque type.
@@ -68,19 +74,35 @@ RegisterGlobalVariables::registerGV (GlobalVariable * GV,
   Type * GlobalType = GV->getType()->getElementType();
   if (StructType * ST = dyn_cast<StructType>(GlobalType))
     if (ST->isOpaque())
-      return;
+      return 0;
 
-  //
-  // Get the pool into which the global should be registered.
-  //
-  Value * PH = ConstantPointerNull::get (getVoidPtrType(GV->getContext()));
-  Type* csiType = IntegerType::getInt32Ty(GV->getContext());
   unsigned TypeSize = TD->getTypeAllocSize((GlobalType));
   if (!TypeSize) {
     llvm::errs() << "FIXME: Ignoring global of size zero: ";
     GV->dump();
-    return;
   }
+  return TypeSize;
+}
+
+//
+// Method: registerGV()
+//
+// Description:
+//  This method adds code into a program to register a global variable into its
+//  pool.
+//
+void
+RegisterGlobalVariables::registerGV (GlobalVariable * GV,
+                                     Instruction * InsertBefore) {
+  unsigned TypeSize = getRegistrationSize (GV);
+  if (!TypeSize)
+    return;
+
+  //
+  // Get the pool into which the global should be registered.
+  //
+  Value * PH = ConstantPointerNull::get (getVoidPtrType(GV->getContext()));
+  Type* csiType = IntegerType::getInt32Ty(GV->getContext());
   Value * AllocSize = ConstantInt::get (csiType, TypeSize);
   RegisterVariableIntoPool(PH, GV, AllocSize, InsertBefore);
 
@@ -88,6 +110,75 @@ RegisterGlobalVariables::registerGV (GlobalVariable * GV,
   ++RegisteredGVs;
 }
 
+//
+// Method: registerGlobalTable()
+//
+// Description:
+//  This method creates a read-only table holding the address and size of each
+//  of the specified global variables and adds code into a program to register
+//  all of them with a single call to pool_register_globals_bulk().  This
+//  avoids one run-time call and one splay tree insertion per global.
+//
+void
+RegisterGlobalVariables::registerGlobalTable (Module & M,
+                                  const std::vector<GlobalVariable *> & Globals,
+                                              Instruction * InsertBefore) {
+  Type * VoidTy      = Type::getVoidTy (M.getContext());
+  Type * VoidPtrType = getVoidPtrType (M.getContext());
+  Type * Int32Type   = IntegerType::getInt32Ty (M.getContext());
+
+  //
+  // Create an entry for each global.  The layout of an entry must match the
+  // GlobalRegistration structure of the run-time.
+  //
+  StructType * EntryType = StructType::get (VoidPtrType, Int32Type, NULL);
+  std::vector<Constant *> Entries;
+  for (unsigned index = 0; index < Globals.size(); ++index) {
+    GlobalVariable * GV = Globals[index];
+    unsigned TypeSize = getRegistrationSize (GV);
+    if (!TypeSize)
+      continue;
+
+    Constant * Fields[] = {
+      ConstantExpr::getPointerCast (GV, VoidPtrType),
+      ConstantInt::get (Int32Type, TypeSize)
+    };
+    Entries.push_back (ConstantStruct::get (EntryType, Fields));
+
+    // Update statistics
+    ++RegisteredGVs;
+  }
+
+  if (Entries.empty())
+    return;
+
+  //
+  // Create the table.
+  //
+  ArrayType * TableType = ArrayType::get (EntryType, Entries.size());
+  GlobalVariable * Table = new GlobalVariable (M,
+                                               TableType,
+                                               true,
+                                               GlobalValue::InternalLinkage,
+                                               ConstantArray::get (TableType,
+                                                                   Entries),
+                                               "sc.global_table");
+
+  //
+  // Register the whole table.
+  //
+  Constant * CF = M.getOrInsertFunction ("pool_register_globals_bulk",
+                                         VoidTy,
+                                         VoidPtrType,
+                                         Int32Type,
+                                         NULL);
+  Value * Args[] = {
+    ConstantExpr::getPointerCast (Table, VoidPtrType),
+    ConstantInt::get (Int32Type, Entries.size())
+  };
+  CallInst::Create (CF, Args, "", InsertBefore);
+}
+
 bool
 RegisterGlobalVariables::runOnModule(Module & M) {
   init(M, "pool_register_global");
@@ -122,6 +213,7 @@ RegisterGlobalVariables::runOnModule(Module & M) {
   // within the program.  This transform must ensure, then, that it is
   // never used, even if such a use would otherwise be innocuous.
   //
+  std::vector<GlobalVariable *> Globals;
   Module::global_iterator GI = M.global_begin(), GE = M.global_end();
   for ( ; GI != GE; ++GI) {
     GlobalVariable *GV = dyn_cast<GlobalVariable>(GI);
@@ -146,9 +238,16 @@ RegisterGlobalVariables::runOnModule(Module & M) {
     // Skip globals that may not be emitted into the final executable.
     //
     if (GV->hasAvailableExternallyLinkage()) continue;
-    registerGV(GV, InsertPt);    
+
+    if (BulkRegisterGlobals)
+      Globals.push_back (GV);
+    else
+      registerGV(GV, InsertPt);    
   }
 
+  if (BulkRegisterGlobals)
+    registerGlobalTable (M, Globals, InsertPt);
+
   return true;
 }
 
@@ -185,7 +185,7 @@ pool_find(DebugPoolTy *pool, void *address, void *&poolBegin, void *&poolEnd) {
 
   // Retrieve memory area's bounds from pool handle.
   if ((pool && pool->Objects.find(address, poolBegin, poolEnd)) || 
-      ExternalObjects->find(address, poolBegin, poolEnd))
+      findExternalObject(address, poolBegin, poolEnd))
     return true;
 
   return false;
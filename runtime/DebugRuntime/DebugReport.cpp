@@ -47,6 +47,13 @@ DebugViolationInfo::print(std::ostream & OS) const {
   }
 }
 
+void
+DebugViolationInfo::getSourceLocation(const char *& file,
+                                      unsigned & line) const {
+  file = this->SourceFile;
+  line = this->lineNo;
+}
+
 void
 OutOfBoundsViolation::print(std::ostream & OS) const {
   //
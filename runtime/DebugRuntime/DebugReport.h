@@ -29,6 +29,7 @@ struct DebugViolationInfo : public ViolationInfo {
   const char * SourceFile;
   unsigned int lineNo;
   virtual void print (std::ostream & OS) const;
+  virtual void getSourceLocation (const char *& file, unsigned & line) const;
   DebugViolationInfo() : dbgMetaData(0), SourceFile(0), lineNo(0) {}
 };
 
@@ -0,0 +1,206 @@
+//===- GlobalTable.cpp - Bulk registration of global variables ------------===//
+//
+//                          The SAFECode Compiler
+//
+// This file was developed by the LLVM research group and is distributed under
+// the University of Illinois Open Source License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the bulk registration of global variables.  Instead of
+// calling pool_register_global() once per global, the compiler can emit a
+// read-only table holding the address and size of every global and pass it
+// to pool_register_globals_bulk() at startup.
+//
+// The globals are kept in a flat array of bounds sorted by address and
+// searched with a binary search; they are never inserted into the
+// ExternalObjects splay tree.  Building the array takes linear time when the
+// table is already in address order, which is the case when the linker lays
+// out the globals in the order in which the module defines them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/DebugRuntime.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <pthread.h>
+
+using namespace llvm;
+
+//
+// Structure: GlobalRange
+//
+// Description:
+//  The bounds of one registered global.  The end is the address of the last
+//  byte of the global, as in the splay trees.
+//
+struct GlobalRange {
+  char * start;
+  char * end;
+};
+
+//
+// Structure: GlobalTable
+//
+// Description:
+//  A sorted array of disjoint global bounds.  A table is never modified once
+//  it is published; registering more globals publishes a new table.
+//
+struct GlobalTable {
+  size_t count;
+  GlobalRange ranges[1];
+};
+
+// The current table of registered globals
+static GlobalTable * volatile Globals = 0;
+
+// Lock held while registering globals
+static pthread_mutex_t GlobalsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline bool
+startsBefore (const GlobalRange & a, const GlobalRange & b) {
+  return a.start < b.start;
+}
+
+//
+// Function: allocateTable()
+//
+// Description:
+//  Allocate a table with room for the specified number of globals.
+//
+static GlobalTable *
+allocateTable (size_t count) {
+  GlobalTable * Table = (GlobalTable *)
+    malloc (sizeof (GlobalTable) + count * sizeof (GlobalRange));
+  if (!Table) {
+    fprintf (stderr, "SAFECode: cannot allocate the global table\n");
+    fflush (stderr);
+    abort();
+  }
+  Table->count = 0;
+  return Table;
+}
+
+namespace llvm {
+
+//
+// Function: findGlobalObject()
+//
+// Description:
+//  Find the bounds of the bulk registered global containing the specified
+//  pointer.
+//
+bool
+findGlobalObject (void * p, void *& start, void *& end) {
+  GlobalTable * Table = Globals;
+  if (!Table)
+    return false;
+
+  //
+  // Find the last global starting at or below the pointer and see whether
+  // the pointer falls within it.
+  //
+  char * ptr = (char *) p;
+  size_t low = 0;
+  size_t high = Table->count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (Table->ranges[mid].start <= ptr)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if (low == 0)
+    return false;
+
+  GlobalRange & Range = Table->ranges[low - 1];
+  if (ptr > Range.end)
+    return false;
+
+  start = Range.start;
+  end   = Range.end;
+  return true;
+}
+
+}
+
+//
+// Function: pool_register_globals_bulk()
+//
+// Description:
+//  Register all of the globals in a table emitted by the compiler.  Globals of
+//  size zero are ignored.  Overlapping globals (e.g., strings merged by the
+//  linker) are combined into a single object, just as the splay tree would
+//  combine them.
+//
+// Notes:
+//  A table being replaced may still be searched by another thread, so it is
+//  never freed.  Tables are only replaced when more than one module registers
+//  its globals.
+//
+void
+pool_register_globals_bulk (GlobalRegistration * Table, unsigned Count) {
+  RuntimeAllocScope Scope;
+
+  //
+  // Convert the entries into bounds, noting whether they are already sorted.
+  //
+  GlobalRange * Ranges;
+  Ranges = (GlobalRange *) malloc ((Count + 1) * sizeof (GlobalRange));
+  unsigned NumRanges = 0;
+  bool sorted = true;
+  for (unsigned index = 0; index < Count; ++index) {
+    if (!Table[index].size)
+      continue;
+
+    GlobalRange & Range = Ranges[NumRanges];
+    Range.start = (char *) Table[index].start;
+    Range.end   = Range.start + Table[index].size - 1;
+    if (NumRanges && (Range.start < Ranges[NumRanges - 1].start))
+      sorted = false;
+    ++NumRanges;
+  }
+
+  if (!sorted)
+    std::sort (Ranges, Ranges + NumRanges, startsBefore);
+
+  //
+  // Merge the new globals with those already registered and coalesce
+  // overlapping globals.
+  //
+  pthread_mutex_lock (&GlobalsLock);
+  GlobalTable * Old = Globals;
+  size_t OldCount = Old ? Old->count : 0;
+  GlobalTable * New = allocateTable (OldCount + NumRanges);
+  GlobalRange * Merged = New->ranges;
+  if (Old)
+    std::merge (Old->ranges, Old->ranges + OldCount,
+                Ranges, Ranges + NumRanges,
+                Merged, startsBefore);
+  else
+    std::copy (Ranges, Ranges + NumRanges, Merged);
+
+  size_t last = 0;
+  for (size_t index = 0; index < OldCount + NumRanges; ++index) {
+    if (last && (Merged[index].start <= Merged[last - 1].end)) {
+      if (Merged[index].end > Merged[last - 1].end)
+        Merged[last - 1].end = Merged[index].end;
+      continue;
+    }
+    Merged[last++] = Merged[index];
+  }
+  New->count = last;
+
+  //
+  // Publish the new table only after it has been completely written.
+  //
+  __sync_synchronize();
+  Globals = New;
+  pthread_mutex_unlock (&GlobalsLock);
+
+  free (Ranges);
+}
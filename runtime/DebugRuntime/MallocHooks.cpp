@@ -11,19 +11,42 @@
 // by the system's original memory allocators.  This allows the SAFECode
 // compiler to work with external code.
 //
+// On Darwin, the hooks are installed into the default malloc zone.  On Linux,
+// the allocation functions are interposed by defining them within the
+// run-time library.
+//
 //===----------------------------------------------------------------------===//
 
+#include "../include/DebugRuntime.h"
 #include "../include/SplayTree.h"
 
 #if defined(__APPLE__)
 #include <malloc/malloc.h>
 #endif
 
+#if defined(__linux__)
+#include <errno.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#endif
+
 namespace llvm {
 
 // Splay tree for recording external allocations
 RangeSplaySet<> * ExternalObjects;
 
+// Flags whether the current thread is within the run-time's own bookkeeping
+static __thread unsigned InHook = 0;
+
+RuntimeAllocScope::RuntimeAllocScope () {
+  ++InHook;
+}
+
+RuntimeAllocScope::~RuntimeAllocScope () {
+  --InHook;
+}
+
 #if defined(__APPLE__)
 // The real allocation functions
 static void * (*real_malloc)  (malloc_zone_t *, size_t);
@@ -70,6 +93,13 @@ track_malloc (malloc_zone_t * zone, size_t size) {
   // Pointer to the allocated object
   char * objp;
 
+  //
+  // Allocations made while recording another one are the splay tree's own.
+  //
+  if (InHook)
+    return real_malloc (zone, size);
+  RuntimeAllocScope Scope;
+
   //
   // Perform the allocation.
   //
@@ -87,6 +117,13 @@ track_valloc (malloc_zone_t * zone, size_t size) {
   // Pointer to the allocated object
   char * objp;
 
+  //
+  // Allocations made while recording another one are the splay tree's own.
+  //
+  if (InHook)
+    return real_valloc (zone, size);
+  RuntimeAllocScope Scope;
+
   //
   // Perform the allocation.
   //
@@ -104,6 +141,13 @@ track_calloc (malloc_zone_t * zone, size_t num, size_t size) {
   // Pointer to the allocated object
   char * objp;
 
+  //
+  // Allocations made while recording another one are the splay tree's own.
+  //
+  if (InHook)
+    return real_calloc (zone, num, size);
+  RuntimeAllocScope Scope;
+
   //
   // Perform the allocation.
   //
@@ -121,6 +165,13 @@ track_realloc (malloc_zone_t * zone, void * oldp, size_t size) {
   // Pointer to the allocated object
   char * objp;
 
+  //
+  // Allocations made while recording another one are the splay tree's own.
+  //
+  if (InHook)
+    return real_realloc (zone, oldp, size);
+  RuntimeAllocScope Scope;
+
   //
   // Perform the allocation.
   //
@@ -135,6 +186,12 @@ track_realloc (malloc_zone_t * zone, void * oldp, size_t size) {
 
 static void
 track_free (malloc_zone_t * zone, void * p) {
+  if (InHook) {
+    real_free (zone, p);
+    return;
+  }
+  RuntimeAllocScope Scope;
+
   //
   // Perform the allocation.
   //
@@ -146,11 +203,398 @@ track_free (malloc_zone_t * zone, void * p) {
   ExternalObjects->remove(p);
   return;
 }
+
+//
+// Darwin records allocations directly in the splay tree, so there is never
+// anything pending.
+//
+void
+syncExternalObjects (void) {
+  return;
+}
+
+bool
+findLargeExternalObject (void * p, void *& start, void *& end) {
+  return false;
+}
+#elif defined(__linux__)
+//
+// On Linux, we interpose malloc() and friends by defining them within the
+// run-time library and forwarding to the glibc implementations.  The hooks
+// may be entered from any thread and from within the run-time itself (the
+// splay tree allocates its nodes with malloc()), so they never touch the
+// splay tree directly.  Instead, they record allocations and deallocations in
+// a lock-free queue that is drained into ExternalObjects by whichever thread
+// next needs to look up an external object.  Memory that the run-time
+// allocates for itself within a RuntimeAllocScope is not recorded.
+//
+
+//
+// Structure: ExternalRecord
+//
+// Description:
+//  One slot of the pending allocation queue.  The queue is a bounded
+//  multi-producer queue in which each slot carries a sequence number telling
+//  producers and the consumer whether the slot is free or filled.
+//
+// Fields:
+//  seq   : The sequence number of the slot.
+//  start : The first byte of the object.
+//  end   : The last byte of the object; NULL if the object was deallocated.
+//
+struct ExternalRecord {
+  volatile uintptr_t seq;
+  void * start;
+  void * end;
+};
+
+// Number of slots in the pending queue; must be a power of two
+static const uintptr_t PendingSize = 4096;
+
+// Objects of at least this size are registered in the large object table
+static const size_t LargeObjectSize = 128 * 1024;
+
+// Number of entries in the large object table
+static const unsigned LargeTableSize = 64;
+
+// Queue of allocations and deallocations not yet in ExternalObjects
+static ExternalRecord Pending[PendingSize];
+static volatile uintptr_t PendingHead = 0;
+static volatile uintptr_t PendingTail = 0;
+
+// Lock held by the thread draining the pending queue
+static volatile int DrainLock = 0;
+
+//
+// Table of large externally allocated objects.  Large objects are typically
+// long-lived buffers handed out by libraries (e.g., image and I/O buffers);
+// registering them costs a single compare-and-swap and looking them up is a
+// short linear scan.  An entry is in use when its start field is non-NULL and
+// is valid once its end field is non-NULL.
+//
+static struct {
+  void * volatile start;
+  void * volatile end;
+} LargeObjects[LargeTableSize];
+static volatile unsigned LargeObjectCount = 0;
+
+// Flags whether the hooks should record allocations
+static volatile bool HooksInstalled = false;
+
+//
+// Function: enqueueRecord()
+//
+// Description:
+//  Append an allocation record to the pending queue without taking a lock.
+//
+// Return value:
+//  true  - The record was added to the queue.
+//  false - The queue is full.
+//
+static bool
+enqueueRecord (void * start, void * end) {
+  uintptr_t pos = PendingTail;
+  while (1) {
+    ExternalRecord & slot = Pending[pos & (PendingSize - 1)];
+    intptr_t diff = (intptr_t) slot.seq - (intptr_t) pos;
+    if (diff == 0) {
+      if (__sync_bool_compare_and_swap (&PendingTail, pos, pos + 1)) {
+        slot.start = start;
+        slot.end   = end;
+        __sync_synchronize();
+        slot.seq = pos + 1;
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;
+    }
+    pos = PendingTail;
+  }
+}
+
+//
+// Function: recordExternal()
+//
+// Description:
+//  Record an allocation (end is non-NULL) or deallocation (end is NULL) of an
+//  external object.  If the queue is full, drain it on the current thread and
+//  try again.
+//
+static void
+recordExternal (void * start, void * end) {
+  while (!enqueueRecord (start, end)) {
+    syncExternalObjects();
+  }
+}
+
+//
+// Function: registerLargeObject()
+//
+// Description:
+//  Try to register a large object in the large object table.
+//
+// Return value:
+//  true  - The object was added to the table.
+//  false - The table is full; the object must be recorded in the queue.
+//
+static bool
+registerLargeObject (void * start, void * end) {
+  for (unsigned index = 0; index < LargeTableSize; ++index) {
+    if (LargeObjects[index].start)
+      continue;
+    if (__sync_bool_compare_and_swap (&(LargeObjects[index].start), 0, start)) {
+      LargeObjects[index].end = end;
+      __sync_fetch_and_add (&LargeObjectCount, 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// Function: unregisterLargeObject()
+//
+// Description:
+//  Remove the object starting at the specified address from the large object
+//  table.
+//
+// Return value:
+//  true  - The object was found and removed.
+//  false - The object was not in the table.
+//
+static bool
+unregisterLargeObject (void * start) {
+  if (!LargeObjectCount)
+    return false;
+
+  for (unsigned index = 0; index < LargeTableSize; ++index) {
+    if (LargeObjects[index].start == start) {
+      LargeObjects[index].end = 0;
+      __sync_synchronize();
+      LargeObjects[index].start = 0;
+      __sync_fetch_and_sub (&LargeObjectCount, 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+// Function: trackAlloc()
+//
+// Description:
+//  Record a newly allocated external object of the specified size.
+//
+static inline void
+trackAlloc (void * objp, size_t size) {
+  if (!objp || !size || !HooksInstalled || InHook)
+    return;
+
+  //
+  // Draining a full queue allocates splay tree nodes; don't record them.
+  //
+  RuntimeAllocScope Scope;
+  void * end = (char *) objp + size - 1;
+  if ((size >= LargeObjectSize) && registerLargeObject (objp, end))
+    return;
+  recordExternal (objp, end);
+}
+
+//
+// Function: trackFree()
+//
+// Description:
+//  Record that the specified external object is about to be deallocated.
+//  This must be done before the memory is returned to the allocator;
+//  otherwise, another thread could receive the same address and record its
+//  allocation before our deallocation record.
+//
+static inline void
+trackFree (void * objp) {
+  if (!objp || !HooksInstalled || InHook)
+    return;
+
+  RuntimeAllocScope Scope;
+  if (!unregisterLargeObject (objp))
+    recordExternal (objp, 0);
+}
+
+void
+installAllocHooks (void) {
+  //
+  // Initialize the sequence numbers of the pending queue before allowing any
+  // hook to use it.
+  //
+  for (uintptr_t index = 0; index < PendingSize; ++index)
+    Pending[index].seq = index;
+  __sync_synchronize();
+  HooksInstalled = true;
+}
+
+//
+// Function: syncExternalObjects()
+//
+// Description:
+//  Move all pending allocation records into the ExternalObjects splay tree.
+//  If another thread is already doing so, return immediately; that thread
+//  will finish the job.
+//
+void
+syncExternalObjects (void) {
+  //
+  // Avoid the lock in the common case in which nothing has changed.
+  //
+  if (PendingHead == PendingTail)
+    return;
+
+  if (__sync_lock_test_and_set (&DrainLock, 1))
+    return;
+
+  //
+  // Splay tree nodes are allocated with malloc(); don't record them.
+  //
+  RuntimeAllocScope Scope;
+  while (1) {
+    uintptr_t pos = PendingHead;
+    ExternalRecord & slot = Pending[pos & (PendingSize - 1)];
+    if (slot.seq != pos + 1)
+      break;
+    __sync_synchronize();
+    void * start = slot.start;
+    void * end   = slot.end;
+    slot.seq = pos + PendingSize;
+    PendingHead = pos + 1;
+
+    if (end) {
+      //
+      // A stale entry may remain if memory was freed behind our back (e.g.,
+      // by a library calling munmap() on a region it allocated); replace it.
+      //
+      if (!(ExternalObjects->insert (start, end))) {
+        ExternalObjects->remove (start);
+        ExternalObjects->insert (start, end);
+      }
+    } else {
+      ExternalObjects->remove (start);
+    }
+  }
+
+  __sync_lock_release (&DrainLock);
+}
+
+//
+// Function: findLargeExternalObject()
+//
+// Description:
+//  Search the large object table for the object containing the specified
+//  pointer.
+//
+bool
+findLargeExternalObject (void * p, void *& start, void *& end) {
+  if (!LargeObjectCount)
+    return false;
+
+  for (unsigned index = 0; index < LargeTableSize; ++index) {
+    void * objStart = LargeObjects[index].start;
+    void * objEnd   = LargeObjects[index].end;
+    if (objStart && objEnd && (objStart <= p) && (p <= objEnd)) {
+      start = objStart;
+      end   = objEnd;
+      return true;
+    }
+  }
+  return false;
+}
 #else
 void
 installAllocHooks (void) {
   return;
 }
+
+void
+syncExternalObjects (void) {
+  return;
+}
+
+bool
+findLargeExternalObject (void * p, void *& start, void *& end) {
+  return false;
+}
 #endif
 
 }
+
+#if defined(__linux__)
+using namespace llvm;
+
+//
+// The real allocation functions provided by glibc.  Calling these directly
+// (rather than looking up the next definition with dlsym()) avoids recursing
+// into our own malloc() while the dynamic linker allocates memory.
+//
+extern "C" {
+  void * __libc_malloc   (size_t);
+  void * __libc_calloc   (size_t, size_t);
+  void * __libc_realloc  (void *, size_t);
+  void * __libc_memalign (size_t, size_t);
+  void   __libc_free     (void *);
+}
+
+extern "C" void *
+malloc (size_t size) {
+  void * objp = __libc_malloc (size);
+  trackAlloc (objp, size);
+  return objp;
+}
+
+extern "C" void *
+calloc (size_t num, size_t size) {
+  void * objp = __libc_calloc (num, size);
+  trackAlloc (objp, num * size);
+  return objp;
+}
+
+extern "C" void *
+realloc (void * oldp, size_t size) {
+  //
+  // Record the deallocation before the old object can be reused.
+  //
+  trackFree (oldp);
+  void * objp = __libc_realloc (oldp, size);
+
+  //
+  // If reallocation failed, the old object is still valid; register it again.
+  //
+  if (!objp && oldp && size)
+    trackAlloc (oldp, malloc_usable_size (oldp));
+  else
+    trackAlloc (objp, size);
+  return objp;
+}
+
+extern "C" void *
+memalign (size_t alignment, size_t size) {
+  void * objp = __libc_memalign (alignment, size);
+  trackAlloc (objp, size);
+  return objp;
+}
+
+extern "C" int
+posix_memalign (void ** memptr, size_t alignment, size_t size) {
+  if ((alignment % sizeof (void *)) || (alignment & (alignment - 1)))
+    return EINVAL;
+
+  void * objp = __libc_memalign (alignment, size);
+  if (!objp)
+    return ENOMEM;
+  trackAlloc (objp, size);
+  *memptr = objp;
+  return 0;
+}
+
+extern "C" void
+free (void * p) {
+  trackFree (p);
+  __libc_free (p);
+}
+#endif
@@ -28,6 +28,30 @@ extern DebugPoolTy dummyPool;
 // Splay tree of external objects
 extern RangeSplaySet<> * ExternalObjects;
 
+//
+// Function: findExternalObject()
+//
+// Description:
+//  Find the bounds of the external object containing the specified pointer.
+//  Allocations recorded by the malloc() hooks but not yet added to the splay
+//  tree are added first.  Objects on the current thread's unsafe stack and
+//  bulk registered globals are found here as well since they belong to no
+//  pool.
+//
+static inline bool
+findExternalObject (void * p, void *& start, void *& end) {
+  if (findUnsafeStackObject (p, start, end))
+    return true;
+
+  if (findGlobalObject (p, start, end))
+    return true;
+
+  syncExternalObjects();
+  if (ExternalObjects->find (p, start, end))
+    return true;
+  return findLargeExternalObject (p, start, end);
+}
+
 // Records Out of Bounds pointer rewrites; also used by OOB rewrites for
 // exactcheck() calls
 extern DebugPoolTy OOBPool;
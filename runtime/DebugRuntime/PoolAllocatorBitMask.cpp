@@ -144,6 +144,7 @@ static PDebugMetaData createPtrMetaData (unsigned,
 extern "C" void __poolalloc_init();
 void
 pool_init_runtime (unsigned Dangling, unsigned RewriteOOB, unsigned Terminate) {
+  RuntimeAllocScope Scope;
   // Flag for whether we've already initialized the run-time
   static int initialized = 0;
 
@@ -197,9 +198,19 @@ pool_init_runtime (unsigned Dangling, unsigned RewriteOOB, unsigned Terminate) {
   ReportLog = stderr;
   ErrorLog = &(std::cerr);
 
+  //
+  // Initialize the splay tree of external objects.  This must be done before
+  // the allocation hooks are installed since they record objects within it.
+  //
+  ExternalObjects = new RangeSplaySet<>;
+
   //
   // Install hooks for catching allocations outside the scope of SAFECode.
+  // The environment may request this for programs linked against
+  // uninstrumented libraries.
   //
+  if (getenv ("SC_TRACK_EXTERNAL_MALLOCS"))
+    ConfigData.TrackExternalMallocs = true;
   if (ConfigData.TrackExternalMallocs) {
     installAllocHooks();
   }
@@ -239,10 +250,6 @@ pool_init_runtime (unsigned Dangling, unsigned RewriteOOB, unsigned Terminate) {
   __poolalloc_init();
 #endif
 
-  //
-  // Initialize the splay tree of external objects.
-  //
-  ExternalObjects = new RangeSplaySet<>;
   return;
 }
 
@@ -287,6 +294,7 @@ pool_init_logfile (const char * name) {
 //
 void *
 __sc_dbg_newpool(unsigned NodeSize) {
+  RuntimeAllocScope Scope;
   DebugPoolTy * Pool = new DebugPoolTy();
   poolinit(static_cast<BitmapPoolTy*>(Pool), NodeSize);
   return Pool;
@@ -304,6 +312,7 @@ __sc_dbg_newpool(unsigned NodeSize) {
 //        pooldestroy is called
 void
 __sc_dbg_pooldestroy(DebugPoolTy * Pool) {
+  RuntimeAllocScope Scope;
   assert(Pool && "Null pool pointer passed in to pooldestroy!\n");
 
   //
@@ -330,6 +339,7 @@ extern char ** environ;
 //
 void *
 poolargvregister (int argc, char ** argv) {
+  RuntimeAllocScope Scope;
   if (logregs) {
     fprintf (stderr, "poolargvregister: %p - %p\n", (void *) argv,
              (void *) (((unsigned char *)(&(argv[argc+1]))) - 1));
@@ -397,6 +407,7 @@ _internal_poolregister (DebugPoolTy *Pool,
                         const char * SourceFilep,
                         unsigned lineno,
                         allocType allocationType) {
+  RuntimeAllocScope Scope;
   // Do some initial casting for type goodness
   const char * SourceFile = (const char *)(SourceFilep);
 
@@ -554,6 +565,7 @@ pool_register_debug (DebugPoolTy *Pool,
                      unsigned NumBytes, TAG,
                      const char * SourceFilep,
                      unsigned lineno) {
+  RuntimeAllocScope Scope;
   //
   // Use the common registration function.  Mark the allocation as a heap
   // allocation.  However, only do this if the object is not a singleton object
@@ -685,6 +697,7 @@ pool_register_stack_debug (DebugPoolTy *Pool,
                            unsigned NumBytes, TAG,
                            const char * SourceFilep,
                            unsigned lineno) {
+  RuntimeAllocScope Scope;
   //
   // Use the common registration function.  Mark the allocation as a stack
   // allocation.
@@ -770,6 +783,7 @@ pool_register_global_debug (DebugPoolTy *Pool,
                             unsigned NumBytes, TAG,
                             const char * SourceFilep,
                             unsigned lineno) {
+  RuntimeAllocScope Scope;
   //
   // Use the common registration function.  Mark the "allocation" as a global
   // object.
@@ -1002,7 +1016,7 @@ poolcheck_free (DebugPoolTy *Pool, void * ptr) {
   bool found = false;
   if (Pool) found = Pool->Objects.find (ptr, ObjStart, ObjEnd);
   if (!found)
-    found = ExternalObjects->find (ptr, ObjStart, ObjEnd);
+    found = findExternalObject (ptr, ObjStart, ObjEnd);
 
   //
   // This may be a singleton object, so search for it within the pool slabs
@@ -1076,7 +1090,7 @@ poolcheck_freeui (DebugPoolTy *Pool, void * ptr) {
   bool found = false;
   if (Pool) found = Pool->Objects.find (ptr, ObjStart, ObjEnd);
   if (!found)
-    found = ExternalObjects->find (ptr, ObjStart, ObjEnd);
+    found = findExternalObject (ptr, ObjStart, ObjEnd);
 
   //
   // This may be a singleton object, so search for it within the pool slabs
@@ -1133,6 +1147,7 @@ updateMDOnFree (DebugPoolTy *Pool,
                 unsigned tag,
                 const char * SourceFilep,
                 unsigned lineno) {
+  RuntimeAllocScope Scope;
   //
   // Increment the ID number for this deallocation.
   //
@@ -1219,6 +1234,7 @@ _internal_poolunregister (DebugPoolTy *Pool,
                           unsigned tag,
                           const char * SourceFilep,
                           unsigned lineno) {
+  RuntimeAllocScope Scope;
   if (logregs) {
     fprintf (stderr, "pool_unregister: Start: %p: %s %d\n", allocaptr, SourceFilep, lineno);
     fflush (stderr);
@@ -1308,6 +1324,7 @@ __sc_dbg_src_poolalloc (DebugPoolTy *Pool,
                         unsigned NumBytes, TAG,
                         const char * SourceFilep,
                         unsigned lineno) {
+  RuntimeAllocScope Scope;
   //
   // Ensure that we're allocating at least one byte.
   //
@@ -1330,6 +1347,7 @@ __sc_dbg_src_poolfree (DebugPoolTy *Pool,
                        void * Node, TAG,
                        const char * SourceFile,
                        unsigned int lineno) {
+  RuntimeAllocScope Scope;
   //
   // Free the object within the pool; the poolunregister() function will
   // detect invalid frees.
@@ -1366,10 +1384,11 @@ createPtrMetaData (unsigned AllocID,
                    void * Canon,
                    const char * SourceFile,
                    unsigned lineno) {
-  // FIXME:
-  //  This will cause an allocation that is registered as an external
-  //  allocation.  We need to use some internal allocation routine.
   //
+  // The metadata belongs to the run-time; don't record it as an external
+  // allocation.
+  //
+  RuntimeAllocScope Scope;
   PDebugMetaData ret = (PDebugMetaData) malloc (sizeof(DebugMetaData));
   ret->allocID = AllocID;
   ret->freeID = FreeID;
@@ -1637,6 +1656,7 @@ getCanonicalPtr (void * ShadowPtr) {
 //
 void *
 pool_shadow (void * CanonPtr, unsigned NumBytes) {
+  RuntimeAllocScope Scope;
   //
   // Calculate the offset of the object from the beginning of the page.
   //
@@ -1683,6 +1703,7 @@ pool_shadow (void * CanonPtr, unsigned NumBytes) {
 //
 void *
 pool_unshadow (void * Node) {
+  RuntimeAllocScope Scope;
   // The start and end of the object as registered in the dangling pointer
   // object metapool
   void * start = 0, * end = 0;
@@ -2061,6 +2082,7 @@ __sc_dbg_poolstrdup_debug (DebugPoolTy * Pool,
 //
 void *
 __sc_dbg_poolinit(DebugPoolTy *Pool, unsigned NodeSize, unsigned) {
+  RuntimeAllocScope Scope;
   //
   // Create a record if necessary.
   if (logregs) {
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "../include/Report.h"
+#include "../include/ViolationLog.h"
 
 #include <iostream>
 #include <cstdlib>
@@ -39,60 +40,7 @@ ViolationInfo::print(std::ostream & OS) const {
   //
   // Determine which descriptive string to use to describe the error.
   //
-  const char * typestring;
-  switch (type) {
-    case FAULT_DANGLING_PTR:
-      typestring = "Use After Free Error";
-      break;
-
-    case FAULT_INVALID_FREE:
-      typestring = "Invalid Free Error";
-      break;
-
-    case FAULT_NOTHEAP_FREE:
-      typestring = "Freeing Non-Heap Object Error";
-      break;
-
-    case FAULT_DOUBLE_FREE:
-      typestring = "Double Free Error";
-      break;
-
-    case FAULT_OUT_OF_BOUNDS:
-      typestring = "Out of Bounds Error";
-      break;
-
-    case FAULT_WRITE_OUT_OF_BOUNDS:
-      typestring = "Writing Out of Bounds Error";
-      break;
-
-    case FAULT_LOAD_STORE:
-      typestring = "Load/Store Error";
-      break;
-
-    case WARN_LOAD_STORE:
-      typestring = "Potential Load/Store Error";
-      break;
-
-    case FAULT_ALIGN:
-      typestring = "Alignment Error";
-      break;
-
-    case FAULT_UNINIT:
-      typestring = "Uninitialized/NULL Pointer Error";
-      break;
-
-    case FAULT_CSTDLIB:
-      typestring = "C Library Undefined Behavior";
-      break;
-
-    case FAULT_CALL:
-      typestring = "Invalid Call Target Error";
-      break;
-
-    default:
-      typestring = "Unknown Error";
-      break;
-  }
+  const char * typestring = getViolationTypeString (type);
 
   //
   // Now print a more human readable version of the error.
@@ -108,30 +56,52 @@ ViolationInfo::print(std::ostream & OS) const {
   OS << "= Program counter                       :\t" << this->faultPC << "\n";
 }
 
+void
+ViolationInfo::getSourceLocation(const char *& file, unsigned & line) const {
+  file = 0;
+  line = 0;
+}
+
 void
 ReportMemoryViolation(const ViolationInfo *v) {
   // Flag for whether to terminate when an error is detected.
   extern unsigned StopOnError;
 
   //
-  // Print the error to the error log.
-  //
-  v->print(*ErrorLog);
-  *ErrorLog << std::flush;
-
+  // If the program keeps running after errors, hand the report to the
+  // buffered violation log if one is in use.  The log takes care of
+  // duplicate reports, so only the first occurrence of a violation counts
+  // towards the error limit.
   //
-  // If we need to terminate now, do that.
-  //
-  if (StopOnError)
-    abort();
+  LogResult logged = StopOnError ? NotLogged : logViolation (v);
+  if (logged == LoggedRepeat)
+    return;
+
+  if (logged == NotLogged) {
+    //
+    // Print the error to the error log.
+    //
+    v->print(*ErrorLog);
+    *ErrorLog << std::flush;
+
+    //
+    // If we need to terminate now, do that.
+    //
+    if (StopOnError)
+      abort();
+  }
 
   //
   // Otherwise, report a certain number of errors before terminating the
-  // program.
+  // program.  abort() does not run the handler that completes the log, so
+  // write out what is buffered first.
   //
   static unsigned count = 20;
   --count;
-  if (!count) abort();
+  if (!count) {
+    flushViolationLog();
+    abort();
+  }
   return;
 }
 
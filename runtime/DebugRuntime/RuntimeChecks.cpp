@@ -218,7 +218,7 @@ poolcheck_debug (DebugPoolTy *Pool,
   //
   // Look for the object within the splay tree of external objects.
   //
-  if (ExternalObjects->find (Node, ObjStart, ObjEnd)) {
+  if (findExternalObject (Node, ObjStart, ObjEnd)) {
     if ((ObjStart <= Node) && (Node <= ObjEnd)) {
       if (!((ObjStart <= NodeEnd) && (NodeEnd <= ObjEnd))) {
         DebugViolationInfo v;
@@ -421,7 +421,7 @@ poolcheckui_debug (DebugPoolTy *Pool,
   // are stored in this splay tree.
   //
   int fs = 0;
-  if ((fs = ExternalObjects->find (Node, ObjStart, ObjEnd))) {
+  if ((fs = findExternalObject (Node, ObjStart, ObjEnd))) {
     if ((ObjStart <= Node) && (Node <= ObjEnd)) {
       if (!((ObjStart <= NodeEnd) && (NodeEnd <= ObjEnd))) {
         DebugViolationInfo v;
@@ -747,7 +747,7 @@ boundscheck_check (bool found, void * ObjStart, void * ObjEnd,
   //
   if (1) {
     void * S, * end;
-    bool fs = ExternalObjects->find(Source, S, end);
+    bool fs = findExternalObject(Source, S, end);
     if (fs) {
       if ((S <= Dest) && (Dest <= end)) {
         return Dest;
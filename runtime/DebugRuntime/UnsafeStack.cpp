@@ -0,0 +1,238 @@
+//===- UnsafeStack.cpp - Per-thread stack for promoted stack objects ------===//
+//
+//                          The SAFECode Compiler
+//
+// This file was developed by the LLVM research group and is distributed under
+// the University of Illinois Open Source License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the "unsafe stack": a separate, per-thread,
+// bump-pointer allocated stack used for stack objects that the compiler
+// cannot prove safe to leave on the native stack.  It replaces the
+// malloc()/free() pair that the ConvertUnsafeAllocas pass would otherwise
+// insert for each such object.
+//
+// A function using the unsafe stack saves the stack top in its prologue,
+// allocates its unsafe objects from the stack, and restores the saved top on
+// every exit.  Restoring the top pops all objects allocated since the save in
+// one step, including those of callees that exited abnormally (e.g., via
+// longjmp()).
+//
+// Objects are never registered in a splay tree.  Since the stack grows
+// upward, the objects of a thread are allocated at increasing addresses; a
+// per-thread array of object bounds is therefore always sorted and can be
+// searched with a binary search.  Popping a frame simply truncates the array.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/DebugRuntime.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include <stdint.h>
+#include <sys/mman.h>
+
+#if defined(MAP_ANON) && !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+using namespace llvm;
+
+// Size of the address space reserved for each thread's unsafe stack
+static const size_t UnsafeStackSize = 64 * 1024 * 1024;
+
+// Maximum number of live objects on each thread's unsafe stack
+static const size_t MaxUnsafeObjects = 4 * 1024 * 1024;
+
+// Alignment of objects allocated on the unsafe stack
+static const uintptr_t UnsafeStackAlign = 16;
+
+//
+// Structure: UnsafeObject
+//
+// Description:
+//  The bounds of one object on the unsafe stack.  The end is the address of
+//  the last byte of the object, as in the splay trees.
+//
+struct UnsafeObject {
+  char * start;
+  char * end;
+};
+
+//
+// Per-thread unsafe stack state.  The stack and its object table are
+// reserved lazily the first time a thread allocates an unsafe object; the
+// operating system only commits the pages that are touched.
+//
+static __thread char * StackBase = 0;
+static __thread char * StackTop = 0;
+static __thread UnsafeObject * Objects = 0;
+static __thread size_t NumObjects = 0;
+
+//
+// Function: reserve()
+//
+// Description:
+//  Reserve a region of address space that is committed on demand.
+//
+static void *
+reserve (size_t size) {
+  void * Addr = mmap (0, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (Addr == MAP_FAILED) {
+    perror ("mmap:");
+    fflush (stderr);
+    abort();
+  }
+  return Addr;
+}
+
+//
+// Function: initUnsafeStack()
+//
+// Description:
+//  Create the unsafe stack for the current thread.
+//
+static void
+initUnsafeStack (void) {
+  StackBase = StackTop = (char *) reserve (UnsafeStackSize);
+  Objects = (UnsafeObject *) reserve (MaxUnsafeObjects * sizeof (UnsafeObject));
+  NumObjects = 0;
+}
+
+//
+// Function: firstObjectAtOrAbove()
+//
+// Description:
+//  Return the index of the first object on the current thread's unsafe stack
+//  that starts at or above the specified address.
+//
+static inline size_t
+firstObjectAtOrAbove (const char * p) {
+  size_t low = 0;
+  size_t high = NumObjects;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (Objects[mid].start < p)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+namespace llvm {
+
+//
+// Function: findUnsafeStackObject()
+//
+// Description:
+//  Find the bounds of the object on the current thread's unsafe stack that
+//  contains the specified pointer.
+//
+// Notes:
+//  Only the current thread's unsafe stack is searched.  Pointers to objects
+//  on another thread's unsafe stack are treated like other unregistered
+//  pointers.
+//
+bool
+findUnsafeStackObject (void * p, void *& start, void *& end) {
+  char * ptr = (char *) p;
+  if ((ptr < StackBase) || (ptr >= StackTop))
+    return false;
+
+  //
+  // Find the last object starting at or below the pointer and see whether
+  // the pointer falls within it.  The pointer may point into the padding
+  // between two objects.
+  //
+  size_t index = firstObjectAtOrAbove (ptr + 1);
+  if (index == 0)
+    return false;
+
+  UnsafeObject & Obj = Objects[index - 1];
+  if (ptr > Obj.end)
+    return false;
+
+  start = Obj.start;
+  end   = Obj.end;
+  return true;
+}
+
+}
+
+//
+// Function: __sc_unsafestack_save()
+//
+// Description:
+//  Return the current top of the unsafe stack.  The compiler inserts a call
+//  to this function in the prologue of each function that allocates objects
+//  on the unsafe stack.
+//
+void *
+__sc_unsafestack_save (void) {
+  return StackTop;
+}
+
+//
+// Function: __sc_unsafestack_alloc()
+//
+// Description:
+//  Allocate an object on the current thread's unsafe stack and record its
+//  bounds.
+//
+void *
+__sc_unsafestack_alloc (unsigned NumBytes) {
+  if (!StackBase)
+    initUnsafeStack();
+
+  //
+  // Ensure that we're always allocating at least 1 byte so that each object
+  // has a distinct address.
+  //
+  if (NumBytes == 0)
+    NumBytes = 1;
+
+  char * obj = StackTop;
+  char * newTop = (char *)(((uintptr_t)(obj + NumBytes) + UnsafeStackAlign - 1)
+                           & ~(UnsafeStackAlign - 1));
+  if ((newTop > StackBase + UnsafeStackSize) ||
+      (NumObjects == MaxUnsafeObjects)) {
+    fprintf (stderr, "SAFECode: unsafe stack overflow\n");
+    fflush (stderr);
+    abort();
+  }
+
+  StackTop = newTop;
+  Objects[NumObjects].start = obj;
+  Objects[NumObjects].end   = obj + NumBytes - 1;
+  ++NumObjects;
+  return obj;
+}
+
+//
+// Function: __sc_unsafestack_restore()
+//
+// Description:
+//  Pop all objects allocated on the current thread's unsafe stack since the
+//  specified top was saved.  The compiler inserts a call to this function on
+//  every exit of a function that allocates objects on the unsafe stack.
+//
+void
+__sc_unsafestack_restore (void * Top) {
+  char * top = (char *) Top;
+
+  //
+  // A function that saved the top before this thread's first unsafe
+  // allocation saved a NULL top; pop everything.
+  //
+  if (!top)
+    top = StackBase;
+
+  assert ((top <= StackTop) && "unsafe stack restored to a popped frame!\n");
+  NumObjects = firstObjectAtOrAbove (top);
+  StackTop = top;
+}
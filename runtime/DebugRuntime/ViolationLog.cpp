@@ -0,0 +1,408 @@
+//===- ViolationLog.cpp - Buffered binary log of violations ---------------===//
+//
+//                       The SAFECode Compiler Project
+//
+// This file was developed by the LLVM research group and is distributed under
+// the University of Illinois Open Source License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a reporting backend for programs that keep running
+// after memory safety violations.  Instead of formatting each report on the
+// faulting thread, violations are:
+//
+//   o) Deduplicated by program counter and type.  Repeated violations only
+//      increment a counter.
+//   o) Queued in a lock-free ring owned by the faulting thread.
+//   o) Written to a binary log by a background thread that drains the rings.
+//
+// The sc-decode-log tool converts the log into human readable reports.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/DebugRuntime.h"
+#include "../include/Report.h"
+#include "../include/ViolationLog.h"
+
+#include <map>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace llvm {
+
+//
+// Structure: PendingViolation
+//
+// Description:
+//  A violation waiting in a thread's ring to be written to the log.
+//
+struct PendingViolation {
+  unsigned type;
+  unsigned CWE;
+  unsigned lineNo;
+  const char * SourceFile;
+  const void * faultPC;
+  const void * faultPtr;
+};
+
+// Number of violations that each thread's ring can hold; a power of two
+static const unsigned RingSize = 256;
+
+//
+// Structure: ViolationRing
+//
+// Description:
+//  A single-producer, single-consumer ring of violations.  The owning thread
+//  is the only producer; the thread holding DrainLock is the only consumer.
+//  If the ring is full, the violation is dropped; a faulting thread never
+//  waits for the writer.  Its occurrences are still counted in the
+//  deduplication table.
+//
+struct ViolationRing {
+  PendingViolation slots[RingSize];
+  volatile unsigned head;
+  volatile unsigned tail;
+  ViolationRing * next;
+};
+
+//
+// Structure: DedupEntry
+//
+// Description:
+//  An entry of the table that counts the occurrences of each violation.  The
+//  key combines the program counter and violation type; zero marks a free
+//  entry.
+//
+struct DedupEntry {
+  volatile uintptr_t key;
+  volatile uint64_t count;
+  uint64_t logged;
+  uint32_t type;
+  const void * faultPC;
+};
+
+// Number of entries in the deduplication table; a power of two
+static const unsigned DedupSize = 4096;
+
+// Microseconds between drains of the rings by the writer thread
+static const unsigned DrainInterval = 50000;
+
+// Deduplication table
+static DedupEntry DedupTable[DedupSize];
+
+// List of the rings of all running threads that have reported a violation
+static ViolationRing * volatile Rings = 0;
+
+// The ring of the current thread
+static __thread ViolationRing * ThreadRing = 0;
+
+// File descriptor of the log; -1 if the log is disabled
+static int LogFD = -1;
+
+// Lock held by the thread draining the rings; never taken by a producer
+static pthread_mutex_t DrainLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Map from source file name pointers to string IDs; guarded by DrainLock
+static std::map<const char *, uint32_t> * FileIDs = 0;
+
+static pthread_once_t LogOnce = PTHREAD_ONCE_INIT;
+
+// Key whose destructor releases the ring of an exiting thread
+static pthread_key_t RingKey;
+
+//
+// Function: writeBytes()
+//
+// Description:
+//  Write the specified bytes to the log, retrying after partial writes.
+//
+static void
+writeBytes (const void * buf, size_t len) {
+  const char * p = (const char *) buf;
+  while (len) {
+    ssize_t written = write (LogFD, p, len);
+    if (written <= 0)
+      return;
+    p   += written;
+    len -= written;
+  }
+}
+
+//
+// Function: getFileID()
+//
+// Description:
+//  Return the string ID of the specified source file name, writing a string
+//  record for it to the log if this is its first use.  The caller must hold
+//  DrainLock.
+//
+static uint32_t
+getFileID (const char * SourceFile) {
+  if (!SourceFile)
+    return 0;
+
+  std::map<const char *, uint32_t>::iterator i = FileIDs->find (SourceFile);
+  if (i != FileIDs->end())
+    return i->second;
+
+  uint32_t id = FileIDs->size() + 1;
+  (*FileIDs)[SourceFile] = id;
+
+  ViolationLogRecord r;
+  memset (&r, 0, sizeof (r));
+  r.kind   = LogString;
+  r.fileID = id;
+  r.length = strlen (SourceFile);
+  writeBytes (&r, sizeof (r));
+  writeBytes (SourceFile, r.length);
+  return id;
+}
+
+//
+// Function: writeRings()
+//
+// Description:
+//  Write all queued violations and all changed counts to the log.  The
+//  caller must hold DrainLock.
+//
+static void
+writeRings (void) {
+  RuntimeAllocScope Scope;
+
+  for (ViolationRing * Ring = Rings; Ring; Ring = Ring->next) {
+    while (Ring->head != Ring->tail) {
+      __sync_synchronize();
+      PendingViolation & pv = Ring->slots[Ring->head & (RingSize - 1)];
+
+      ViolationLogRecord r;
+      memset (&r, 0, sizeof (r));
+      r.kind     = LogViolation;
+      r.type     = pv.type;
+      r.CWE      = pv.CWE;
+      r.lineNo   = pv.lineNo;
+      r.fileID   = getFileID (pv.SourceFile);
+      r.faultPC  = (uintptr_t) pv.faultPC;
+      r.faultPtr = (uintptr_t) pv.faultPtr;
+      r.count    = 1;
+
+      __sync_synchronize();
+      Ring->head = Ring->head + 1;
+      writeBytes (&r, sizeof (r));
+    }
+  }
+
+  //
+  // Write the counts of violations that have occurred again.
+  //
+  for (unsigned index = 0; index < DedupSize; ++index) {
+    DedupEntry & Entry = DedupTable[index];
+    if (!Entry.key)
+      continue;
+
+    uint64_t count = Entry.count;
+    if (count <= 1 || count == Entry.logged)
+      continue;
+
+    ViolationLogRecord r;
+    memset (&r, 0, sizeof (r));
+    r.kind    = LogCount;
+    r.type    = Entry.type;
+    r.faultPC = (uintptr_t) Entry.faultPC;
+    r.count   = count;
+    writeBytes (&r, sizeof (r));
+    Entry.logged = count;
+  }
+}
+
+//
+// Function: drainRings()
+//
+// Description:
+//  Write all queued violations and all changed counts to the log.
+//
+static void
+drainRings (void) {
+  pthread_mutex_lock (&DrainLock);
+  writeRings();
+  pthread_mutex_unlock (&DrainLock);
+}
+
+//
+// Function: releaseThreadRing()
+//
+// Description:
+//  Write out the violations still queued in the ring of an exiting thread,
+//  remove the ring from the list of rings, and free it.
+//
+// Notes:
+//  Only the head of the list is changed by threads adding their rings; the
+//  links after it are only changed while holding DrainLock.
+//
+static void
+releaseThreadRing (void * p) {
+  ViolationRing * Ring = (ViolationRing *) p;
+  ThreadRing = 0;
+
+  pthread_mutex_lock (&DrainLock);
+  writeRings();
+  if (!__sync_bool_compare_and_swap (&Rings, Ring, Ring->next)) {
+    ViolationRing * Prev = Rings;
+    while (Prev->next != Ring)
+      Prev = Prev->next;
+    Prev->next = Ring->next;
+  }
+  pthread_mutex_unlock (&DrainLock);
+
+  RuntimeAllocScope Scope;
+  delete Ring;
+}
+
+//
+// Function: writerThread()
+//
+// Description:
+//  Periodically drain the rings of all threads into the log.
+//
+static void *
+writerThread (void *) {
+  while (1) {
+    usleep (DrainInterval);
+    drainRings();
+  }
+  return 0;
+}
+
+//
+// Function: initViolationLog()
+//
+// Description:
+//  Open the violation log named by the SCREPORTLOG environment variable and
+//  start the writer thread.  The log stays disabled if the variable is not
+//  set or the log cannot be created.
+//
+static void
+initViolationLog (void) {
+  const char * name = getenv ("SCREPORTLOG");
+  if (!name)
+    return;
+
+  int fd = open (name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1)
+    return;
+
+  RuntimeAllocScope Scope;
+  LogFD = fd;
+  FileIDs = new std::map<const char *, uint32_t>;
+  writeBytes (ViolationLogMagic, sizeof (ViolationLogMagic));
+  pthread_key_create (&RingKey, releaseThreadRing);
+
+  //
+  // Write whatever remains in the rings when the program exits.
+  //
+  atexit (drainRings);
+
+  pthread_t writer;
+  pthread_attr_t attr;
+  pthread_attr_init (&attr);
+  pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+  pthread_create (&writer, &attr, writerThread, 0);
+  pthread_attr_destroy (&attr);
+}
+
+//
+// Function: countViolation()
+//
+// Description:
+//  Count an occurrence of the violation with the specified program counter
+//  and type.
+//
+// Return value:
+//  true  - This is the first occurrence of the violation (or the table is
+//          full); it should be queued for the log.
+//  false - The violation has been seen before; only its count was updated.
+//
+static bool
+countViolation (const void * faultPC, unsigned type) {
+  uintptr_t key = (((uintptr_t) faultPC) << 4) + type + 1;
+  unsigned hash = (unsigned)((key * 2654435761u) >> 8);
+  for (unsigned probe = 0; probe < DedupSize; ++probe) {
+    DedupEntry & Entry = DedupTable[(hash + probe) & (DedupSize - 1)];
+    uintptr_t EntryKey = Entry.key;
+    if (EntryKey == 0) {
+      if (__sync_bool_compare_and_swap (&(Entry.key), 0, key)) {
+        Entry.type    = type;
+        Entry.faultPC = faultPC;
+        __sync_fetch_and_add (&(Entry.count), 1);
+        return true;
+      }
+      EntryKey = Entry.key;
+    }
+
+    if (EntryKey == key) {
+      __sync_fetch_and_add (&(Entry.count), 1);
+      return false;
+    }
+  }
+  return true;
+}
+
+//
+// Function: getThreadRing()
+//
+// Description:
+//  Return the ring of the current thread, creating it if necessary.
+//
+static ViolationRing *
+getThreadRing (void) {
+  if (ThreadRing)
+    return ThreadRing;
+
+  RuntimeAllocScope Scope;
+  ViolationRing * Ring = new ViolationRing;
+  Ring->head = Ring->tail = 0;
+  do {
+    Ring->next = Rings;
+  } while (!__sync_bool_compare_and_swap (&Rings, Ring->next, Ring));
+
+  pthread_setspecific (RingKey, Ring);
+  ThreadRing = Ring;
+  return Ring;
+}
+
+LogResult
+logViolation (const ViolationInfo * v) {
+  pthread_once (&LogOnce, initViolationLog);
+  if (LogFD == -1)
+    return NotLogged;
+
+  if (!countViolation (v->faultPC, v->type))
+    return LoggedRepeat;
+
+  ViolationRing * Ring = getThreadRing();
+  unsigned tail = Ring->tail;
+  if (tail - Ring->head == RingSize)
+    return LoggedFirst;
+
+  PendingViolation & pv = Ring->slots[tail & (RingSize - 1)];
+  pv.type     = v->type;
+  pv.CWE      = v->CWE;
+  pv.faultPC  = v->faultPC;
+  pv.faultPtr = v->faultPtr;
+  v->getSourceLocation (pv.SourceFile, pv.lineNo);
+
+  __sync_synchronize();
+  Ring->tail = tail + 1;
+  return LoggedFirst;
+}
+
+void
+flushViolationLog (void) {
+  if (LogFD != -1)
+    drainRings();
+}
+
+}
@@ -100,6 +100,36 @@ struct DebugPoolTy : public BitmapPoolTy {
 void * rewrite_ptr (DebugPoolTy * Pool, const void * p, void * ObjStart,
 void * ObjEnd, const char * SourceFile, unsigned lineno);
 void installAllocHooks (void);
+void syncExternalObjects (void);
+bool findLargeExternalObject (void * p, void *& start, void *& end);
+
+//
+// Class: RuntimeAllocScope
+//
+// Description:
+//  While an object of this class exists, the memory that the current thread
+//  allocates belongs to the run-time (e.g., splay tree nodes and debug
+//  metadata) and is not recorded as an external object.
+//
+struct RuntimeAllocScope {
+  RuntimeAllocScope ();
+  ~RuntimeAllocScope ();
+};
+bool findUnsafeStackObject (void * p, void *& start, void *& end);
+bool findGlobalObject (void * p, void *& start, void *& end);
+
+//
+// Structure: GlobalRegistration
+//
+// Description:
+//  One entry of the global registration table emitted by the compiler: the
+//  address and size of a global variable.  The layout must match the
+//  { i8 *, i32 } entries created by the RegisterGlobalVariables pass.
+//
+struct GlobalRegistration {
+  void * start;
+  unsigned size;
+};
 
 }
 
@@ -123,12 +153,19 @@ extern "C" {
 
   void * poolargvregister (int argc, char ** argv);
 
+  // Unsafe stack for stack objects promoted off of the native stack
+  void * __sc_unsafestack_save (void);
+  void * __sc_unsafestack_alloc (unsigned NumBytes);
+  void __sc_unsafestack_restore (void * Top);
+
   void pool_register       (PPOOL, void *allocaptr, unsigned NumBytes);
   void pool_register_debug (PPOOL, void * p, unsigned size, TAG, SRC_INFO);
   void pool_register_stack      (PPOOL, void * p, unsigned size);
   void pool_register_stack_debug(PPOOL, void * p, unsigned size, TAG, SRC_INFO);
   void pool_register_global (PPOOL, void * p, unsigned size);
   void pool_register_global_debug(PPOOL, void * p, unsigned size, TAG, SRC_INFO);
+  void pool_register_globals_bulk (llvm::GlobalRegistration * Table,
+                                   unsigned Count);
 
   void pool_reregister (PPOOL, void * p, void * q, unsigned size);
   void pool_reregister_debug (PPOOL, void * p, void * q, unsigned size, TAG, SRC_INFO);
@@ -49,9 +49,63 @@ struct ViolationInfo {
   unsigned CWE;
 
   virtual void print(std::ostream & OS) const;
+
+  /// Get the source file and line at which the violation occurred, if known
+  virtual void getSourceLocation(const char *& file, unsigned & line) const;
+
   virtual ~ViolationInfo();
 };
 
+//
+// Function: getViolationTypeString()
+//
+// Description:
+//  Return a string describing the specified type of violation.
+//
+static inline const char *
+getViolationTypeString (unsigned type) {
+  switch (type) {
+    case ViolationInfo::FAULT_DANGLING_PTR:
+      return "Use After Free Error";
+
+    case ViolationInfo::FAULT_INVALID_FREE:
+      return "Invalid Free Error";
+
+    case ViolationInfo::FAULT_NOTHEAP_FREE:
+      return "Freeing Non-Heap Object Error";
+
+    case ViolationInfo::FAULT_DOUBLE_FREE:
+      return "Double Free Error";
+
+    case ViolationInfo::FAULT_OUT_OF_BOUNDS:
+      return "Out of Bounds Error";
+
+    case ViolationInfo::FAULT_WRITE_OUT_OF_BOUNDS:
+      return "Writing Out of Bounds Error";
+
+    case ViolationInfo::FAULT_LOAD_STORE:
+      return "Load/Store Error";
+
+    case ViolationInfo::WARN_LOAD_STORE:
+      return "Potential Load/Store Error";
+
+    case ViolationInfo::FAULT_ALIGN:
+      return "Alignment Error";
+
+    case ViolationInfo::FAULT_UNINIT:
+      return "Uninitialized/NULL Pointer Error";
+
+    case ViolationInfo::FAULT_CSTDLIB:
+      return "C Library Undefined Behavior";
+
+    case ViolationInfo::FAULT_CALL:
+      return "Invalid Call Target Error";
+
+    default:
+      return "Unknown Error";
+  }
+}
+
 
 //
 // Function: ReportMemoryViolation()
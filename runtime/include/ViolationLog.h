@@ -0,0 +1,102 @@
+//===- ViolationLog.h - Binary log of memory safety violations --*- C++ -*-===//
+//
+//                       The SAFECode Compiler Project
+//
+// This file was developed by the LLVM research group and is distributed under
+// the University of Illinois Open Source License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the format of the binary violation log written by the
+// SAFECode run-time when it is asked to buffer its reports, as well as the
+// run-time interface for writing it.
+//
+// A log starts with ViolationLogMagic and is followed by a sequence of
+// fixed-size ViolationLogRecords in host byte order.  A string record is
+// followed by the bytes of the string it defines.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _VIOLATIONLOG_H_
+#define _VIOLATIONLOG_H_
+
+#include <stdint.h>
+
+namespace llvm {
+
+struct ViolationInfo;
+
+// Magic number at the beginning of every violation log
+static const char ViolationLogMagic[8] = {'S', 'C', 'V', 'L', 'O', 'G', '0', '1'};
+
+//
+// Enumerated Type: ViolationLogKind
+//
+// Description:
+//  The kinds of records in a violation log.
+//
+enum ViolationLogKind {
+  LogString    = 1,   // Defines the string with ID fileID; length bytes follow
+  LogViolation = 2,   // The first occurrence of a violation
+  LogCount     = 3    // The number of occurrences of a violation so far
+};
+
+//
+// Structure: ViolationLogRecord
+//
+// Description:
+//  One record of the violation log.  Violations are identified by their
+//  program counter and type; a count record supersedes any earlier count
+//  record for the same violation.
+//
+struct ViolationLogRecord {
+  uint32_t kind;
+  uint32_t type;
+  uint32_t CWE;
+  uint32_t lineNo;
+  uint32_t fileID;      // 0 if the source file is unknown
+  uint32_t length;
+  uint64_t faultPC;
+  uint64_t faultPtr;
+  uint64_t count;
+};
+
+//
+// Enumerated Type: LogResult
+//
+// Description:
+//  What became of a violation handed to the violation log.
+//
+enum LogResult {
+  NotLogged    = 0,   // The log is not enabled
+  LoggedFirst  = 1,   // The first occurrence of the violation was logged
+  LoggedRepeat = 2    // The violation was seen before; only its count changed
+};
+
+//
+// Function: logViolation()
+//
+// Description:
+//  Record a violation in the buffered violation log.  The log is enabled by
+//  setting the SCREPORTLOG environment variable to the name of the file to
+//  which to write it.
+//
+// Return value:
+//  NotLogged if the caller should report the violation itself; otherwise,
+//  whether this was the first occurrence of the violation.
+//
+LogResult logViolation (const ViolationInfo * v);
+
+//
+// Function: flushViolationLog()
+//
+// Description:
+//  Write all buffered violations to the log.  This must be called before the
+//  program terminates abnormally since the log is otherwise only completed
+//  by an exit handler.
+//
+void flushViolationLog (void);
+
+}
+
+#endif
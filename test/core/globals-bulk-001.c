@@ -0,0 +1,27 @@
+// RUN: test.sh -e -m -sc-bulk-register-globals -t %t %s
+//
+// TEST: globals-bulk-001
+//
+// Description:
+//  Test that a global registered through the global registration table is
+//  found by the run-time: indexing past the end of it is caught.
+//
+
+#include <stdio.h>
+
+int before[4];
+int array[10];
+int after[4];
+
+int
+main (int argc, char ** argv) {
+  int index;
+  for (index = 0; index < 10; ++index)
+    array[index] = index;
+
+  // Use a pointer so that the check cannot be resolved statically.
+  int * p = array;
+  volatile int limit = 11;
+  printf ("%d\n", p[limit]);
+  return 0;
+}
@@ -0,0 +1,32 @@
+// RUN: test.sh -p -m -sc-bulk-register-globals -s "pool_register_globals_bulk" -t %t %s
+//
+// TEST: globals-bulk-002
+//
+// Description:
+//  Test that accesses within globals registered through the global
+//  registration table are not reported as errors.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+char first[16];
+int numbers[32];
+char second[64];
+struct { int a; char name[8]; } record;
+
+int
+main (int argc, char ** argv) {
+  volatile int last = 31;
+  int * p = numbers;
+  int index;
+  for (index = 0; index <= last; ++index)
+    p[index] = index;
+
+  strcpy (first, "fifteen chars..");
+  memcpy (second, first, sizeof (first));
+  strncpy (record.name, "seven..", sizeof (record.name));
+
+  printf ("%s %s %d\n", second, record.name, p[last]);
+  return 0;
+}
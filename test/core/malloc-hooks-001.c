@@ -0,0 +1,47 @@
+// RUN: env SC_TRACK_EXTERNAL_MALLOCS=1 test.sh -e -t %t %s
+//
+// TEST: malloc-hooks-001
+//
+// Description:
+//  Test that an object allocated within the C library is tracked as an
+//  external object once the run-time has made many allocations of its own:
+//  indexing past its end must be reported.
+//
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int
+touch (int n) {
+  char buf[64];
+  memset (buf, n, sizeof (buf));
+  return buf[n % sizeof (buf)];
+}
+
+int
+main (int argc, char ** argv) {
+  char * text;
+  size_t size;
+  FILE * f;
+  int index;
+  int sum = 0;
+
+  //
+  // Make the run-time register and unregister many stack objects, which
+  // allocates and frees splay tree nodes.
+  //
+  for (index = 0; index < 10000; ++index)
+    sum += touch (index);
+
+  //
+  // open_memstream() allocates its buffer with the C library's malloc().
+  //
+  f = open_memstream (&text, &size);
+  fprintf (f, "%d", sum);
+  fclose (f);
+
+  printf ("%c\n", text[size + (argc << 20)]);
+  return 0;
+}
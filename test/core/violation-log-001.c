@@ -0,0 +1,30 @@
+// RUN: test.sh -r -e -t %t %s
+// RUN: grep -q "Occurrences.*[^0-9]100$" %t/violation-log-001.sc.output
+// RUN: grep -q "finished" %t/violation-log-001.sc.output
+//
+// TEST: violation-log-001
+//
+// Description:
+//  Test that a program that keeps running after errors records a violation
+//  that occurs many times once in the violation log, with its count, and
+//  that the repeated reports do not count towards the error limit.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int
+main (int argc, char ** argv) {
+  int array[10];
+  int index;
+  int sum = 0;
+
+  for (index = 0; index < 10; ++index)
+    array[index] = index;
+
+  for (index = 0; index < 100; ++index)
+    sum += array[argc + 20];
+
+  printf ("finished %d\n", sum != 0);
+  return 0;
+}
@@ -0,0 +1,32 @@
+// RUN: test.sh -r -e -t %t %s
+// RUN: grep -c "SAFECode:Violation" %t/violation-log-002.sc.output | grep -x 20
+// RUN: not grep -q "finished" %t/violation-log-002.sc.output
+//
+// TEST: violation-log-002
+//
+// Description:
+//  Test that distinct violations recorded in the violation log count
+//  towards the error limit, and that the log holds all of them when the
+//  program is terminated after the twentieth.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OOB(n) sum += array[argc + 20 + n];
+#define OOB5(n) OOB(n) OOB(n + 1) OOB(n + 2) OOB(n + 3) OOB(n + 4)
+
+int
+main (int argc, char ** argv) {
+  int array[10];
+  int index;
+  int sum = 0;
+
+  for (index = 0; index < 10; ++index)
+    array[index] = index;
+
+  OOB5(0) OOB5(5) OOB5(10) OOB5(15) OOB5(20)
+
+  printf ("finished %d\n", sum != 0);
+  return 0;
+}
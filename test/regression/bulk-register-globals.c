@@ -0,0 +1,27 @@
+// RUN: clang -S -emit-llvm -fmemsafety -mllvm -sc-bulk-register-globals %s -o - | FileCheck %s
+//
+// Test that -sc-bulk-register-globals registers the globals with a single
+// call to pool_register_globals_bulk() on a table of their addresses and
+// sizes, rather than with one pool_register_global() call per global.
+
+// CHECK: @sc.global_table = internal constant [{{[0-9]+}} x { i8*, i32 }]
+// CHECK-SAME: { i8* bitcast ([10 x i32]* @ints to i8*), i32 40 }
+// CHECK-SAME: { i8* bitcast ([24 x i8]* @chars to i8*), i32 24 }
+// CHECK-SAME: { i8* bitcast (double* @value to i8*), i32 8 }
+
+// CHECK: define {{.*}}@sc.register_globals
+// CHECK-NOT: pool_register_global(
+// CHECK: call void @pool_register_globals_bulk(i8* bitcast ([{{[0-9]+}} x { i8*, i32 }]* @sc.global_table to i8*), i32 {{[0-9]+}})
+// CHECK-NOT: pool_register_global(
+// CHECK-NOT: pool_register_globals_bulk
+// CHECK: ret void
+
+int ints[10];
+char chars[24];
+double value;
+
+int
+main (int argc, char ** argv) {
+  ints[argc] = chars[argc];
+  return ints[argc] + (int) value;
+}
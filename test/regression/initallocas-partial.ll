@@ -0,0 +1,56 @@
+; RUN: clang -S -emit-llvm -fmemsafety %s -o - | FileCheck %s
+; RUN: clang -S -emit-llvm -fmemsafety %s -o - | FileCheck %s --check-prefix=SKIP
+;
+; Exercise the InitAllocas pass on allocas that need only their pointer fields
+; initialized, allocas written completely before being read, buffers that
+; hold no pointers, and buffers that may receive pointers from elsewhere.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.node = type { i32, %struct.node*, [4096 x i8], i8* }
+
+@g = global i8 0
+@src = global [16 x i8] zeroinitializer
+
+; The pointer fields of %n are nulled with separate stores.
+; CHECK: %ints = alloca [16 x i32]
+; CHECK: store %struct.node* null, %struct.node** %n{{[0-9]+}}
+; CHECK: store i8* null, i8** %n{{[0-9]+}}
+
+; %buf is filled by read() and %cp partly by memcpy(), so either may receive
+; pointers and is zeroed.
+; CHECK: call void @llvm.memset.p0i8.i32(i8* %{{[^,]*}}, i8 0, i32 4096, i32 16, i1 false)
+; CHECK: call void @llvm.memset.p0i8.i32(i8* %{{[^,]*}}, i8 0, i32 32, i32 8, i1 false)
+
+; %p is written before it is read, and %ints only ever holds integers. The
+; initialization is inserted after the allocas, before the first store to %p.
+; SKIP: %ints = alloca [16 x i32]
+; SKIP-NOT: store i8* null, i8** %p
+; SKIP-NOT: i32 64, i32 {{[0-9]+}}, i1 false)
+; SKIP: store i8* @g, i8** %p
+
+define i32 @main() nounwind uwtable {
+entry:
+  %n = alloca %struct.node, align 8
+  %p = alloca i8*, align 8
+  %buf = alloca [4096 x i8], align 16
+  %cp = alloca [32 x i8], align 8
+  %ints = alloca [16 x i32], align 4
+  store i8* @g, i8** %p
+  %q = load i8** %p
+  %next = getelementptr inbounds %struct.node* %n, i32 0, i32 1
+  %r = load %struct.node** %next
+  %b = getelementptr inbounds [4096 x i8]* %buf, i32 0, i32 0
+  %call = call i64 @read(i32 0, i8* %b, i64 4096) nounwind
+  %c = getelementptr inbounds [32 x i8]* %cp, i32 0, i32 0
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %c, i8* getelementptr inbounds ([16 x i8]* @src, i32 0, i32 0), i64 16, i32 1, i1 false)
+  %i = getelementptr inbounds [16 x i32]* %ints, i32 0, i32 3
+  store i32 7, i32* %i
+  %v = load i32* %i
+  ret i32 %v
+}
+
+declare i64 @read(i32, i8*, i64) nounwind
+
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* nocapture, i8* nocapture, i64, i32, i1) nounwind
@@ -0,0 +1,27 @@
+// RUN: clang -fmemsafety -flto -fPIC -c %s -o %t.o
+// RUN: env PA_BITCODE_FILE=%t.sc.bc \
+// RUN:   clang -fmemsafety -use-gold-plugin -flto -shared \
+// RUN:   -Wl,-plugin-opt=-sc-unsafe-stack %t.o -o %t.so
+// RUN: llvm-dis %t.sc.bc -o - | FileCheck %s
+//
+// Test that a stack object whose address escapes from its function is moved
+// to the unsafe stack when linking with -sc-unsafe-stack, that the function
+// pops it on return, and that it is no longer registered as a stack object.
+
+// CHECK: define void @escape(
+// CHECK: %top = call i8* @__sc_unsafestack_save()
+// CHECK-NOT: alloca [16 x i32]
+// CHECK-NOT: pool_register_stack
+// CHECK: call i8* @__sc_unsafestack_alloc(i32 64)
+// CHECK-NOT: pool_unregister_stack
+// CHECK: call void @__sc_unsafestack_restore(i8* %top)
+// CHECK-NEXT: ret void
+
+int * saved;
+
+void
+escape (int n) {
+  int local[16];
+  local[n] = n;
+  saved = local;
+}
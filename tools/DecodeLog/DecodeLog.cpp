@@ -0,0 +1,191 @@
+//===-- sc-decode-log - Decode SAFECode binary violation logs -------------===//
+//
+//                     The SAFECode Project
+//
+// This file was developed by the LLVM research group and is distributed
+// under the University of Illinois Open Source License. See LICENSE.TXT for
+// details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program reads a binary violation log written by the SAFECode debug
+// run-time (see runtime/include/ViolationLog.h) and prints each distinct
+// violation in the same format that the run-time uses for its immediate
+// reports, followed by the number of times that it occurred.
+//
+// Usage: sc-decode-log <logfile>
+//
+//===----------------------------------------------------------------------===//
+
+#include "../../runtime/include/Report.h"
+#include "../../runtime/include/ViolationLog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+//
+// Structure: Violation
+//
+// Description:
+//  Everything known about one distinct violation.
+//
+struct Violation {
+  bool seen;
+  ViolationLogRecord first;
+  uint64_t count;
+  Violation() : seen(false), count(0) {}
+};
+
+// Violations keyed by program counter and type, in order of first appearance
+typedef std::pair<uint64_t, uint32_t> ViolationKey;
+static std::map<ViolationKey, unsigned> ViolationIndex;
+static std::vector<Violation> Violations;
+
+// Source file names by string ID
+static std::map<uint32_t, std::string> Files;
+
+//
+// Function: getViolation()
+//
+// Description:
+//  Return the violation with the specified program counter and type,
+//  creating a new one if necessary.
+//
+static Violation &
+getViolation (uint64_t faultPC, uint32_t type) {
+  ViolationKey key (faultPC, type);
+  std::map<ViolationKey, unsigned>::iterator i = ViolationIndex.find (key);
+  if (i != ViolationIndex.end())
+    return Violations[i->second];
+
+  ViolationIndex[key] = Violations.size();
+  Violations.push_back (Violation());
+  Violations.back().first.faultPC = faultPC;
+  Violations.back().first.type = type;
+  return Violations.back();
+}
+
+//
+// Function: readLog()
+//
+// Description:
+//  Read all records from the log.
+//
+// Return value:
+//  true  - The log was read successfully.
+//  false - The file is not a violation log.
+//
+static bool
+readLog (FILE * fp) {
+  char magic[sizeof (ViolationLogMagic)];
+  if ((fread (magic, sizeof (magic), 1, fp) != 1) ||
+      (memcmp (magic, ViolationLogMagic, sizeof (magic)) != 0))
+    return false;
+
+  ViolationLogRecord r;
+  while (fread (&r, sizeof (r), 1, fp) == 1) {
+    switch (r.kind) {
+      case LogString: {
+        std::string name (r.length, '\0');
+        if (r.length && (fread (&name[0], r.length, 1, fp) != 1))
+          return true;
+        Files[r.fileID] = name;
+        break;
+      }
+
+      case LogViolation: {
+        Violation & V = getViolation (r.faultPC, r.type);
+        V.seen  = true;
+        V.first = r;
+        if (V.count < r.count)
+          V.count = r.count;
+        break;
+      }
+
+      case LogCount: {
+        Violation & V = getViolation (r.faultPC, r.type);
+        if (V.count < r.count)
+          V.count = r.count;
+        break;
+      }
+
+      default:
+        fprintf (stderr, "sc-decode-log: unknown record kind %u\n", r.kind);
+        return true;
+    }
+  }
+
+  return true;
+}
+
+//
+// Function: printViolation()
+//
+// Description:
+//  Print a violation in the format used by the run-time.
+//
+static void
+printViolation (const Violation & V) {
+  const ViolationLogRecord & r = V.first;
+  printf ("SAFECode:Violation Type %#x when accessing  %#llx at IP=%#llx\n",
+          r.type,
+          (unsigned long long) r.faultPtr,
+          (unsigned long long) r.faultPC);
+  printf ("\n");
+  printf ("=======+++++++    SAFECODE RUNTIME ALERT +++++++=======\n");
+  printf ("= Error type                            :\t%s\n",
+          getViolationTypeString (r.type));
+
+  //
+  // Only the program counter and type of violations whose first report was
+  // dropped are known.
+  //
+  if (V.seen) {
+    printf ("= CWE ID                                :\t%u\n", r.CWE);
+    printf ("= Faulting pointer                      :\t%#llx\n",
+            (unsigned long long) r.faultPtr);
+  }
+  printf ("= Program counter                       :\t%#llx\n",
+          (unsigned long long) r.faultPC);
+  if (V.seen) {
+    std::map<uint32_t, std::string>::iterator i = Files.find (r.fileID);
+    printf ("= Fault PC Source                       :\t%s:%u\n",
+            (i != Files.end()) ? i->second.c_str() : "UNKNOWN",
+            r.lineNo);
+  }
+  printf ("= Occurrences                           :\t%llu\n",
+          (unsigned long long) V.count);
+  printf ("\n");
+}
+
+int
+main (int argc, char ** argv) {
+  if (argc != 2) {
+    fprintf (stderr, "Usage: %s <logfile>\n", argv[0]);
+    return 1;
+  }
+
+  FILE * fp = fopen (argv[1], "rb");
+  if (!fp) {
+    perror (argv[1]);
+    return 1;
+  }
+
+  bool valid = readLog (fp);
+  fclose (fp);
+  if (!valid) {
+    fprintf (stderr, "%s: not a SAFECode violation log\n", argv[1]);
+    return 1;
+  }
+
+  for (unsigned index = 0; index < Violations.size(); ++index)
+    printViolation (Violations[index]);
+
+  return 0;
+}
@@ -54,6 +54,7 @@
 #include "safecode/OptimizeChecks.h"
 #include "safecode/SAFECodeMSCInfo.h"
 #include "safecode/SafeLoadStoreOpts.h"
+#include "safecode/UnsafeStack.h"
 
 #include "CommonMemorySafetyPasses.h"
 
@@ -75,6 +76,10 @@ static cl::opt<bool>
 DisableGVNLoadPRE("disable-gvn-loadpre", cl::init(false),
   cl::desc("Do not run the GVN load PRE pass"));
 
+static cl::opt<bool>
+SCUnsafeStack("sc-unsafe-stack", cl::init(false),
+  cl::desc("Move stack objects whose address escapes to the unsafe stack"));
+
 const char* LTOCodeGenerator::getVersionString() {
 #ifdef LLVM_VERSION_INFO
   return PACKAGE_NAME " version " PACKAGE_VERSION ", " LLVM_VERSION_INFO;
@@ -463,6 +468,11 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
       passes.add(new ScalarEvolution());
       passes.add(createOptimizeImpliedFastLSChecksPass());
 
+      // Move escaping stack objects to the unsafe stack before the checks
+      // are completed, so that they are checked against its bounds.
+      if (SCUnsafeStack)
+        passes.add(new USConvertUnsafeAllocas());
+
       if (mergedModule->getFunction("main")) {
         passes.add(new CompleteChecks());
       }
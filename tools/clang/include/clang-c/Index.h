@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 30
+#define CINDEX_VERSION_MINOR 32
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -4857,6 +4857,40 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             unsigned num_unsaved_files,
                                             unsigned options);
 
+/**
+ * \brief Perform code completion at a given location in a translation unit,
+ * returning only the results that match what the user has typed so far.
+ *
+ * This function behaves like \c clang_codeCompleteAt(), except that results
+ * are filtered while they are collected, and code-completion strings are
+ * only built for the results that are returned. When completion produces a
+ * large number of results, this is much faster than retrieving all of them
+ * and filtering on the client side.
+ *
+ * \param filter_prefix If non-NULL and non-empty, only the results whose
+ * typed text starts with this prefix, ignoring case, are returned.
+ *
+ * \param max_results If non-zero, at most this many results are returned.
+ * When there are more matching results, the most likely ones (those with the
+ * lowest priority value) are kept, and they are returned in order from the
+ * most to the least likely. Otherwise, results are returned in no particular
+ * order, as with \c clang_codeCompleteAt().
+ *
+ * See \c clang_codeCompleteAt() for the remaining parameters and the
+ * result.
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *
+clang_codeCompleteAtWithFilter(CXTranslationUnit TU,
+                               const char *complete_filename,
+                               unsigned complete_line,
+                               unsigned complete_column,
+                               struct CXUnsavedFile *unsaved_files,
+                               unsigned num_unsaved_files,
+                               unsigned options,
+                               const char *filter_prefix,
+                               unsigned max_results);
+
 /**
  * \brief Sort the code-completion results in case-insensitive alphabetical 
  * order.
@@ -5573,6 +5607,25 @@ typedef void *CXIndexAction;
  */
 CINDEX_LINKAGE CXIndexAction clang_IndexAction_create(CXIndex CIdx);
 
+/**
+ * \brief Create an index action that belongs to the same indexing session as
+ * an existing one.
+ *
+ * The actions of a session share the record of which function bodies were
+ * already indexed, so that \c CXIndexOpt_SkipParsedBodiesInSession skips
+ * the bodies indexed by any of them. Each thread indexing a project can use
+ * its own action, and the actions of a session can index concurrently.
+ *
+ * The session lives as long as any of its actions.
+ *
+ * \param CIdx The index object with which the index action will be associated.
+ *
+ * \param session An index action of the session to join. If it is NULL, the
+ * new action starts a new session.
+ */
+CINDEX_LINKAGE CXIndexAction
+clang_IndexAction_createInSession(CXIndex CIdx, CXIndexAction session);
+
 /**
  * \brief Destroy the given index action.
  *
@@ -59,6 +59,7 @@ namespace clang {
   class SelectorTable;
   class TargetInfo;
   class CXXABI;
+  class ConstexprCallCache;
   class MangleNumberingContext;
   // Decls
   class MangleContext;
@@ -1831,6 +1832,10 @@ public:
 
   VTableContextBase *getVTableContext();
 
+  /// \brief Retrieve the results of constexpr function calls that constant
+  /// expression evaluation may reuse.
+  ConstexprCallCache &getConstexprCallCache();
+
   MangleContext *createMangleContext();
   
   void DeepCollectObjCIvars(const ObjCInterfaceDecl *OI, bool leafClass,
@@ -2447,6 +2452,10 @@ private:
 
   std::unique_ptr<VTableContextBase> VTContext;
 
+  /// \brief The results of constexpr function calls, reused by the constant
+  /// expression evaluator.
+  std::unique_ptr<ConstexprCallCache> ConstexprCalls;
+
 public:
   enum PragmaSectionFlag : unsigned {
     PSF_None = 0,
@@ -0,0 +1,95 @@
+//===--- ConstexprCallCache.h - Results of constexpr calls ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the ConstexprCallCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_AST_CONSTEXPRCALLCACHE_H
+#define LLVM_CLANG_AST_CONSTEXPRCALLCACHE_H
+
+#include "clang/AST/APValue.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/Allocator.h"
+
+namespace clang {
+
+/// \brief The results of calls to constexpr functions, as computed by the
+/// constant expression evaluator.
+///
+/// Constant evaluation has no memory of earlier evaluations, so a recursive
+/// constexpr function, or a constexpr table built by calling the same
+/// function over and over, repeats the same calls many times.  The evaluator
+/// records here the result of each call that depends on nothing but its
+/// callee and its arguments, and reuses it for later calls with the same
+/// key.
+///
+/// Each result records the number of evaluation steps and the depth of the
+/// call stack it took to compute, so that a reused result is subject to the
+/// same limits as evaluating the call again.
+class ConstexprCallCache {
+public:
+  /// \brief The result of one call.
+  struct Result {
+    APValue Value;
+
+    /// \brief The number of evaluation steps taken by the call.
+    unsigned Steps;
+
+    /// \brief The number of nested calls below the call, at the deepest
+    /// point of its evaluation.
+    unsigned Depth;
+  };
+
+  ConstexprCallCache() : NumHits(0), NumMisses(0) {}
+  ~ConstexprCallCache();
+
+  /// \brief Looks up the result of the call identified by \p Key, or returns
+  /// null if it is not known.
+  const Result *lookup(const llvm::FoldingSetNodeID &Key);
+
+  /// \brief Records the result of the call identified by \p Key.
+  void insert(const llvm::FoldingSetNodeID &Key, const APValue &Value,
+              unsigned Steps, unsigned Depth);
+
+  /// \brief Counts a call whose result was reused.
+  void noteHit() { ++NumHits; }
+
+  /// \brief Counts a call that had to be evaluated.
+  void noteMiss() { ++NumMisses; }
+
+  void PrintStats() const;
+
+private:
+  ConstexprCallCache(const ConstexprCallCache &) = delete;
+  void operator=(const ConstexprCallCache &) = delete;
+
+  class Entry : public llvm::FoldingSetNode {
+    llvm::FoldingSetNodeIDRef Key;
+
+  public:
+    Entry(llvm::FoldingSetNodeIDRef Key) : Key(Key) {}
+
+    Result R;
+
+    void Profile(llvm::FoldingSetNodeID &ID) const { ID = Key; }
+  };
+
+  llvm::FoldingSet<Entry> Entries;
+
+  /// \brief The storage of the keys.
+  llvm::BumpPtrAllocator KeyAlloc;
+
+  unsigned NumHits;
+  unsigned NumMisses;
+};
+
+} // end namespace clang
+
+#endif
@@ -217,6 +217,13 @@ public:
   const FileEntry *getFile(StringRef Filename, bool OpenFile = false,
                            bool CacheFailure = true);
 
+  /// \brief Returns whether \p Path has already been looked up as a file or
+  /// directory, or was created as a virtual file or directory, so that
+  /// looking it up again does not touch the file system.
+  bool hasCachedLookup(StringRef Path) const {
+    return SeenFileEntries.count(Path) || SeenDirEntries.count(Path);
+  }
+
   /// \brief Returns the current file system options
   const FileSystemOptions &getFileSystemOptions() { return FileSystemOpts; }
 
@@ -25,6 +25,10 @@ public:
   /// \brief If set, paths are resolved as if the working directory was
   /// set to the value of WorkingDir.
   std::string WorkingDir;
+
+  /// \brief If set, the results of 'stat' calls on system headers are shared
+  /// with other compilations through the cache file StatCachePath.
+  std::string StatCachePath;
 };
 
 } // end namespace clang
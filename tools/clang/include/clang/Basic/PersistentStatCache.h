@@ -0,0 +1,122 @@
+//===--- PersistentStatCache.h - 'stat' cache shared on disk ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the PersistentStatCache interface.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_PERSISTENTSTATCACHE_H
+#define LLVM_CLANG_BASIC_PERSISTENTSTATCACHE_H
+
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+
+/// \brief The paths below system directories that 'stat' found missing,
+/// shared by all compilations that use the same cache file.
+///
+/// A build runs the compiler thousands of times, and each run searches the
+/// same system and SDK include directories for headers that are mostly found
+/// in another one.  This cache records, for each path below one of a set of
+/// system roots that does not exist, the modification time of its directory.
+/// A later compilation knows the path is still missing as long as the
+/// directory has not changed, which costs one 'stat' per directory instead of
+/// one per missing header.
+///
+/// Only missing paths are cached: creating or renaming a file changes the
+/// modification time of its directory, but editing a file in place does not,
+/// so the 'stat' data of a path that exists could be served stale.
+///
+/// The cache file is memory-mapped and never modified in place: a writer
+/// holds a lock file, merges its results with the current file, and renames
+/// a new file over it, so any number of compilations can read it while
+/// another one writes it.  The file records the version of the compiler that
+/// wrote it and is ignored by other versions.
+class PersistentStatCache : public RefCountedBase<PersistentStatCache> {
+public:
+  /// \brief One missing path, as stored in the cache file.
+  struct Entry {
+    uint32_t PathOffset;
+    uint32_t PathLength;
+    int64_t DirModTime;
+  };
+
+  /// \brief Opens the cache file \p CachePath, if it exists, for caching the
+  /// paths below the absolute paths in \p Roots.
+  PersistentStatCache(StringRef CachePath, ArrayRef<std::string> Roots);
+  ~PersistentStatCache();
+
+  /// \brief Returns whether the results for \p Path may be cached.
+  bool isCacheable(StringRef Path) const;
+
+  /// \brief Returns whether the cache file records \p Path as missing and
+  /// its directory has not changed since.
+  bool isKnownMissing(StringRef Path, vfs::FileSystem &FS);
+
+  /// \brief Records that \p Path, which was looked up before, does not exist,
+  /// to be saved in the cache file.
+  void recordMissing(StringRef Path);
+
+  /// \brief Merges the recorded results into the cache file.
+  ///
+  /// \returns \c false if the cache file could not be written.
+  bool save();
+
+private:
+  /// \brief The modification time of a directory and whether it changed too
+  /// recently for results below it to be cached.
+  struct DirState {
+    int64_t ModTime;
+    bool Recent;
+  };
+
+  const DirState &getDirState(StringRef Dir, vfs::FileSystem &FS);
+
+  std::string CachePath;
+  std::vector<std::string> Roots;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  const Entry *Entries;
+  uint32_t NumEntries;
+  const char *Strings;
+
+  /// \brief The directories whose modification time this compilation knows.
+  llvm::StringMap<DirState> Dirs;
+
+  /// \brief The results recorded by this compilation.
+  llvm::StringMap<Entry> NewEntries;
+};
+
+/// \brief A FileSystemStatCache that answers 'stat' calls on missing paths of
+/// the real file system from a PersistentStatCache.
+class PersistentStatCalls : public FileSystemStatCache {
+  IntrusiveRefCntPtr<PersistentStatCache> Cache;
+
+public:
+  explicit PersistentStatCalls(IntrusiveRefCntPtr<PersistentStatCache> Cache)
+      : Cache(Cache) {}
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
+} // end namespace clang
+
+#endif
@@ -72,6 +72,23 @@ class Compilation {
   /// Whether we're compiling for diagnostic purposes.
   bool ForDiagnostics;
 
+  /// The number of jobs which may run at the same time.
+  unsigned ParallelJobs;
+
+  /// PrintCommand - Print the command if the driver was asked to (-v or
+  /// CC_PRINT_OPTIONS).  Returns false if the log file cannot be opened.
+  bool PrintCommand(const Command &C) const;
+
+  /// FinishCommand - Diagnose the result of an executed command.
+  int FinishCommand(const Command &C, int Res, const std::string &Error,
+                    bool ExecutionFailed, const Command *&FailingCommand) const;
+
+  /// ExecuteJobsInParallel - Execute the jobs on up to ParallelJobs threads,
+  /// reporting their output and results in the order of the jobs.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -107,6 +124,11 @@ public:
   /// Returns the sysroot path.
   StringRef getSysRoot() const;
 
+  unsigned getParallelJobs() const { return ParallelJobs; }
+
+  /// Set the number of jobs which may run at the same time.
+  void setParallelJobs(unsigned N) { ParallelJobs = N; }
+
   /// getArgsForToolChain - Return the derived argument list for the
   /// tool chain \p TC (or the default tool chain, if TC is not specified).
   ///
@@ -165,7 +187,8 @@ public:
   /// \return The result code of the subprocess.
   int ExecuteCommand(const Command &C, const Command *&FailingCommand) const;
 
-  /// ExecuteJob - Execute a single job.
+  /// ExecuteJobs - Execute the jobs, running independent jobs at the same
+  /// time if ParallelJobs allows it.
   ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
   /// failing commands and their associated result code.
@@ -157,6 +157,16 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Runs a -cc1 command line, given with the executable as its first
+  /// element, in the driver's own process.  Crashes and fatal errors must
+  /// not end the driver: a crash returns a negative status, and a fatal
+  /// error the status the compiler would have exited with.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// The function which runs -cc1 jobs in the driver's process, if the
+  /// executable embeds the compiler; null otherwise.
+  CC1ToolFunc CC1Main;
+
 private:
   /// Name to use when invoking gcc/g++.
   std::string CCCGenericGCCName;
@@ -129,6 +129,26 @@ private:
   std::unique_ptr<Command> Fallback;
 };
 
+/// Like Command, but runs the compiler in the driver's own process, which
+/// saves starting a new process for each job.  The driver's CC1Main hook
+/// recovers from crashes and fatal errors, so that they are reported like
+/// those of a separate process.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source, const Tool &Creator,
+             const char *Executable, const ArgStringList &Arguments);
+
+  void Print(llvm::raw_ostream &OS, const char *Terminator, bool Quote,
+             CrashReportInfo *CrashInfo = nullptr) const override;
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+
+private:
+  /// Whether the command can run in the driver's process.
+  bool canRunInProcess(const StringRef **Redirects) const;
+};
+
 /// JobList - A sequence of jobs to perform.
 class JobList {
 public:
@@ -28,6 +28,8 @@ class DiagnosticConsumer;
 
 namespace format {
 
+class FormattingCache;
+
 enum class ParseError { Success = 0, Error, Unsuitable };
 class ParseErrorCategory final : public std::error_category {
 public:
@@ -581,10 +583,14 @@ std::string configurationAsText(const FormatStyle &Style);
 /// If \c IncompleteFormat is non-null, its value will be set to true if any
 /// of the affected ranges were not formatted due to a non-recoverable syntax
 /// error.
+///
+/// If \c Cache is non-null, the line breaking decisions it holds are reused
+/// for unchanged lines, and the decisions taken for other lines are added.
 tooling::Replacements reformat(const FormatStyle &Style,
                                SourceManager &SourceMgr, FileID ID,
                                ArrayRef<CharSourceRange> Ranges,
-                               bool *IncompleteFormat = nullptr);
+                               bool *IncompleteFormat = nullptr,
+                               FormattingCache *Cache = nullptr);
 
 /// \brief Reformats the given \p Ranges in \p Code.
 ///
@@ -0,0 +1,76 @@
+//===--- FormattingCache.h - Line breaking decisions across runs -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the FormattingCache, which lets the formatter reuse the line
+/// breaking decisions of earlier runs.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FORMAT_FORMATTINGCACHE_H
+#define LLVM_CLANG_FORMAT_FORMATTINGCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include <mutex>
+#include <vector>
+
+namespace clang {
+namespace format {
+
+/// \brief The line breaking decisions taken for lines that did not fit into
+/// the column limit.
+///
+/// Searching for the best line breaks of such a line is by far the most
+/// expensive part of formatting.  The cache remembers the decisions, keyed by
+/// a digest of the line's tokens and of everything else the search depends
+/// on, so that formatting an unchanged line again only replays them.
+///
+/// The cache can be shared by threads formatting different files, and saved
+/// to a file for later runs.
+class FormattingCache {
+public:
+  /// \brief Loads the entries saved in the file \p Path.
+  ///
+  /// Files written by other versions of the formatter are ignored.  Returns
+  /// \c false if the file exists but cannot be read.
+  bool load(StringRef Path);
+
+  /// \brief Saves the entries to the file \p Path, replacing it atomically.
+  ///
+  /// Returns \c false if the file cannot be written.
+  bool save(StringRef Path);
+
+  /// \brief Looks up the decisions for the line with the digest \p Key.
+  ///
+  /// \p NewLines receives one entry per token after the first, telling
+  /// whether the token starts a new line.
+  bool lookup(StringRef Key, std::vector<bool> &NewLines);
+
+  /// \brief Records the decisions for the line with the digest \p Key.
+  void insert(StringRef Key, ArrayRef<bool> NewLines);
+
+  /// \brief Returns the number of lines in the cache.
+  unsigned size();
+
+private:
+  struct Entry {
+    std::vector<bool> NewLines;
+    /// \brief Whether this run looked up or recorded the entry.
+    bool Used;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+};
+
+} // end namespace format
+} // end namespace clang
+
+#endif
@@ -129,6 +129,10 @@ public:
   /// The name of the bitcode file to link before optzns.
   std::string LinkBitcodeFile;
 
+  /// The linker that merges the objects of the module partitions into one
+  /// relocatable object, if code is generated for them in parallel.
+  std::string BackendPartitionLinker;
+
   /// The user provided name for the "main file", if non-empty. This is useful
   /// in situations where the input file name does not match the original input
   /// file, for example with -save-temps.
@@ -13,6 +13,7 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/PersistentStatCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Frontend/Utils.h"
@@ -84,6 +85,9 @@ class CompilerInstance : public ModuleLoader {
   /// The file manager.
   IntrusiveRefCntPtr<FileManager> FileMgr;
 
+  /// The 'stat' cache shared with other compilations, if any.
+  IntrusiveRefCntPtr<PersistentStatCache> PersistentStats;
+
   /// The source manager.
   IntrusiveRefCntPtr<SourceManager> SourceMgr;
 
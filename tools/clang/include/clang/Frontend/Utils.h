@@ -43,6 +43,7 @@ class ExternalSemaSource;
 class FileManager;
 class HeaderSearch;
 class HeaderSearchOptions;
+class HeaderTokenCache;
 class IdentifierTable;
 class LangOptions;
 class PCHContainerReader;
@@ -163,6 +164,12 @@ void AttachHeaderIncludeGen(Preprocessor &PP, bool ShowAllHeaders = false,
 /// Cache tokens for use with PCH. Note that this requires a seekable stream.
 void CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS);
 
+/// Create a cache of the tokens of system headers, kept as one PTH file per
+/// header in the directory \p CachePath.  Headers that are not in the cache
+/// yet are added to it when they are first entered.
+std::unique_ptr<HeaderTokenCache> createPTHHeaderCache(Preprocessor &PP,
+                                                       StringRef CachePath);
+
 /// The ChainedIncludesSource class converts headers to chained PCHs in
 /// memory, mainly for testing.
 IntrusiveRefCntPtr<ExternalSemaSource>
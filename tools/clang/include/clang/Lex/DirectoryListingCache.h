@@ -0,0 +1,92 @@
+//===--- DirectoryListingCache.h - Cached directory contents ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the DirectoryListingCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+#define LLVM_CLANG_LEX_DIRECTORYLISTINGCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/TimeValue.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+namespace vfs {
+class FileSystem;
+}
+
+/// \brief A cache of the contents of the directories searched for headers.
+///
+/// Header search probes every search directory for every \#include, and most
+/// of those probes are for files that do not exist.  With the listing of a
+/// directory at hand, such probes can be answered without a 'stat'.
+///
+/// Each listing records the modification time of its directory and is read
+/// again once the directory changes.  The cache is thread-safe, so a single
+/// cache can be shared by all translation units of a process that see the
+/// same file system, such as those parsed by libclang or a Tooling tool.
+class DirectoryListingCache
+    : public llvm::ThreadSafeRefCountedBase<DirectoryListingCache> {
+public:
+  /// \brief The contents of one directory.
+  struct Listing {
+    enum ListingKind {
+      /// The directory does not exist, so nothing below it does.
+      LK_Missing,
+      /// The directory could not be read; its contents are unknown.
+      LK_Unknown,
+      /// The directory was read; \c Names holds its contents.
+      LK_Listed
+    };
+    ListingKind Kind;
+
+    /// \brief Whether the listing may be reused as long as the modification
+    /// time of the directory does not change.  Listings of directories that
+    /// were modified very recently are not, since the modification time
+    /// may not change again within its granularity.
+    bool Stable;
+
+    /// \brief The modification time of the directory when it was read.
+    llvm::sys::TimeValue ModTime;
+
+    /// \brief The lowercased names of the entries of the directory.
+    ///
+    /// Names are lowercased so that lookups stay correct on case-insensitive
+    /// file systems.
+    llvm::StringSet<> Names;
+
+    /// \brief Returns false if \p Name is known not to be in the directory.
+    bool mayContain(StringRef Name) const;
+  };
+
+  /// \brief Returns the current listing of the directory \p Dir.
+  ///
+  /// This costs one 'stat' of \p Dir if the cached listing is up to date, and
+  /// reads the directory otherwise.
+  std::shared_ptr<const Listing> getListing(vfs::FileSystem &FS,
+                                            StringRef Dir);
+
+  /// \brief Returns the cache shared by all users of the real file system.
+  static IntrusiveRefCntPtr<DirectoryListingCache> getShared();
+
+private:
+  std::mutex Mutex;
+  llvm::StringMap<std::shared_ptr<const Listing>> Listings;
+};
+
+} // end namespace clang
+
+#endif
@@ -14,6 +14,7 @@
 #ifndef LLVM_CLANG_LEX_HEADERSEARCH_H
 #define LLVM_CLANG_LEX_HEADERSEARCH_H
 
+#include "clang/Lex/DirectoryListingCache.h"
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/ModuleMap.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -238,6 +239,15 @@ class HeaderSearch {
   /// whether they were valid or not.
   llvm::DenseMap<const FileEntry *, bool> LoadedModuleMaps;
 
+  /// \brief The listings of the directories searched for headers, if
+  /// HeaderSearchOptions::UseDirectoryListingCache is set.
+  IntrusiveRefCntPtr<DirectoryListingCache> DirListings;
+
+  /// \brief The directory listings used by this header search.  Each one is
+  /// brought up to date the first time it is used.
+  llvm::StringMap<std::shared_ptr<const DirectoryListingCache::Listing>>
+      UsedDirListings;
+
   /// \brief Uniqued set of framework names, which is used to track which 
   /// headers were included as framework headers.
   llvm::StringSet<llvm::BumpPtrAllocator> FrameworkNames;
@@ -275,6 +285,12 @@ public:
   
   FileManager &getFileMgr() const { return FileMgr; }
 
+  /// \brief Returns false if the file or directory \p Path is known not to
+  /// exist.
+  ///
+  /// Without a directory listing cache, every path may exist.
+  bool mayExist(StringRef Path);
+
   /// \brief Interface for setting the file search paths.
   void SetSearchPaths(const std::vector<DirectoryLookup> &dirs,
                       unsigned angledDirIdx, unsigned systemDirIdx,
@@ -0,0 +1,45 @@
+//===--- HeaderTokenCache.h - Cached tokens of headers ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the HeaderTokenCache interface, which lets the
+//  preprocessor read the tokens of headers from a cache instead of lexing
+//  them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_HEADERTOKENCACHE_H
+#define LLVM_CLANG_LEX_HEADERTOKENCACHE_H
+
+#include "clang/Basic/SourceLocation.h"
+
+namespace clang {
+
+class PTHLexer;
+
+/// \brief A cache of the tokens of individual headers.
+///
+/// Unlike a PTH file given with -include-pth, which holds the tokens of the
+/// headers seen while building one prefix header, the cache holds the tokens
+/// of each header separately, and is filled in as headers are lexed.  The
+/// preprocessor consults it when it enters a system header.
+class HeaderTokenCache {
+public:
+  virtual ~HeaderTokenCache();
+
+  /// \brief Returns a lexer for the cached tokens of the file \p FID, or null
+  /// if the file has to be lexed from its source.
+  ///
+  /// When the file is not in the cache, the cache may record its tokens for
+  /// later compilations.
+  virtual PTHLexer *CreateLexer(FileID FID) = 0;
+};
+
+} // end namespace clang
+
+#endif
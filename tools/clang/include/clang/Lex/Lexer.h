@@ -207,6 +207,13 @@ public:
   /// uninterpreted string.  This switches the lexer out of directive mode.
   void ReadToEndOfLine(SmallVectorImpl<char> *Result = nullptr);
 
+  /// SkipExcludedLines - Skip the text of an excluded conditional block up to
+  /// the next '#' that may start a preprocessor directive, without forming
+  /// tokens.  Comments, string literals and escaped newlines are skipped so
+  /// that only a '#' at the start of a line stops the scan.  The scan also
+  /// stops early at constructs that must be lexed to be skipped correctly,
+  /// such as raw string literals.  The lexer must be in raw mode.
+  void SkipExcludedLines();
 
   /// Diag - Forwarding function for diagnostics.  This translate a source
   /// position in the current buffer into a SourceLocation object for rendering.
@@ -83,6 +83,11 @@ class PTHManager : public IdentifierInfoLookup {
   ///  if the file (if any) that was to used to generate the PTH cache.
   const char* OriginalSourceFile;
 
+  /// UsesPPIdentifiers - Whether identifiers are looked up in the identifier
+  ///  table of the preprocessor, instead of being created by this PTHManager
+  ///  for an identifier table that uses it as its external lookup.
+  bool UsesPPIdentifiers;
+
   /// This constructor is intended to only be called by the static 'Create'
   /// method.
   PTHManager(std::unique_ptr<const llvm::MemoryBuffer> buf,
@@ -95,6 +100,11 @@ class PTHManager : public IdentifierInfoLookup {
   PTHManager(const PTHManager &) = delete;
   void operator=(const PTHManager &) = delete;
 
+  /// Load - Validates the PTH data in the buffer and creates a PTHManager
+  ///  for it.  Problems are reported to Diags, if it is non-null.
+  static PTHManager *Load(std::unique_ptr<llvm::MemoryBuffer> File,
+                          StringRef FileName, DiagnosticsEngine *Diags);
+
   /// getSpellingAtPTHOffset - Used by PTHLexer classes to get the cached
   ///  spelling for a token.
   unsigned getSpellingAtPTHOffset(unsigned PTHOffset, const char*& Buffer);
@@ -131,6 +141,14 @@ public:
   ///  is the name of the PTH file.  This method returns NULL upon failure.
   static PTHManager *Create(StringRef file, DiagnosticsEngine &Diags);
 
+  /// CreateForHeader - Creates a PTHManager for a file of the header token
+  ///  cache, which holds the tokens of a single header.  The identifiers of
+  ///  its tokens are those of the preprocessor's identifier table.  This
+  ///  method returns NULL, without reporting anything, if the file is not a
+  ///  valid PTH file.
+  static PTHManager *CreateForHeader(std::unique_ptr<llvm::MemoryBuffer> File,
+                                     Preprocessor &PP);
+
   void setPreprocessor(Preprocessor *pp) { PP = pp; }
 
   /// CreateLexer - Return a PTHLexer that "lexes" the cached tokens for the
@@ -19,6 +19,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/SourceLocation.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/ModuleMap.h"
@@ -112,6 +113,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// a token cache rather than lexing the original source file.
   std::unique_ptr<PTHManager> PTH;
 
+  /// An optional cache of the tokens of system headers, consulted when a
+  /// system header is entered.
+  std::unique_ptr<HeaderTokenCache> HeaderTokens;
+
   /// A BumpPtrAllocator object used to quickly allocate and release
   /// objects internal to the Preprocessor.
   llvm::BumpPtrAllocator BP;
@@ -570,6 +575,7 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   unsigned NumDirectives, NumDefined, NumUndefined, NumPragma;
   unsigned NumIf, NumElse, NumEndif;
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
+  unsigned NumCachedSourceFiles;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
   unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
   unsigned NumSkipped;
@@ -692,6 +698,13 @@ public:
 
   PTHManager *getPTHManager() { return PTH.get(); }
 
+  /// \brief Sets the cache from which the tokens of system headers are read.
+  void setHeaderTokenCache(std::unique_ptr<HeaderTokenCache> Cache) {
+    HeaderTokens = std::move(Cache);
+  }
+
+  HeaderTokenCache *getHeaderTokenCache() { return HeaderTokens.get(); }
+
   void setExternalSource(ExternalPreprocessorSource *Source) {
     ExternalSource = Source;
   }
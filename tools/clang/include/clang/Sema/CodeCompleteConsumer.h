@@ -757,6 +757,12 @@ public:
     return Keyword;
   }
 
+  /// \brief Retrieve the name that should be used to order this result.
+  ///
+  /// If the name needs to be constructed as a string, that string will be
+  /// saved into Saved and the returned StringRef will refer to it.
+  StringRef getOrderedName(std::string &Saved) const;
+
   /// \brief Create a new code-completion string that describes how to insert
   /// this result into a program.
   ///
@@ -913,6 +919,18 @@ public:
 
   /// \name Code-completion callbacks
   //@{
+  /// \brief Determine whether a result should be dropped before it is added
+  /// to the set of results.
+  ///
+  /// Sema consults this while collecting results, before it builds anything
+  /// for them, so that a consumer that only wants some of the results does
+  /// not pay for the rest.  A consumer must give the same answer for results
+  /// with the same name, since Sema decides which results hide others by
+  /// name.
+  virtual bool isResultFilteredOut(const CodeCompletionResult &Result) {
+    return false;
+  }
+
   /// \brief Process the finalized code-completion results.
   virtual void ProcessCodeCompleteResults(Sema &S,
                                           CodeCompletionContext Context,
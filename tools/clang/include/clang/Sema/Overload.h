@@ -635,6 +635,13 @@ namespace clang {
     /// object argument.
     bool IgnoreObjectArgument;
 
+    /// PrefilteredConversion - True to indicate that this candidate was
+    /// found not viable from the kinds of an argument's and a parameter's
+    /// types alone.  The bad conversion sequence then only records the
+    /// argument and the parameter type, and is computed when the candidate
+    /// is diagnosed.
+    bool PrefilteredConversion;
+
     /// FailureKind - The reason why this candidate is not viable.
     /// Actually an OverloadFailureKind.
     unsigned char FailureKind;
@@ -771,6 +778,7 @@ namespace clang {
         new (&C.Conversions[i]) ImplicitConversionSequence();
 
       C.NumConversions = NumConversions;
+      C.PrefilteredConversion = false;
       return C;
     }
 
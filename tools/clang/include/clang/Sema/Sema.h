@@ -932,6 +932,15 @@ public:
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief The number of overload candidates that overload resolution chose
+  /// among, and how many of them were viable.
+  unsigned NumOverloadCandidates;
+  unsigned NumViableOverloadCandidates;
+
+  /// \brief The number of overload candidates found not viable without
+  /// computing conversion sequences.
+  unsigned NumPrefilteredOverloadCandidates;
+
   typedef llvm::DenseMap<ParmVarDecl *, llvm::TinyPtrVector<ParmVarDecl *>>
     UnparsedDefaultArgInstantiationsMap;
 
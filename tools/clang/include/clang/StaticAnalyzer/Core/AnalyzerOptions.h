@@ -256,6 +256,15 @@ private:
   /// \sa getMaxNodesPerTopLevelFunction
   Optional<unsigned> MaxNodesPerTopLevelFunction;
 
+  /// \sa getMaxMemoryPerTopLevelFunction
+  Optional<unsigned> MaxMemoryPerTopLevelFunction;
+
+  /// \sa getAnalysisPartitionCount
+  Optional<unsigned> AnalysisPartitionCount;
+
+  /// \sa getAnalysisPartitionIndex
+  Optional<unsigned> AnalysisPartitionIndex;
+
   /// A helper function that retrieves option for a given full-qualified
   /// checker name.
   /// Options for checkers can be specified via 'analyzer-config' command-line
@@ -509,6 +518,30 @@ public:
   /// This is controlled by the 'max-nodes' config option.
   unsigned getMaxNodesPerTopLevelFunction();
 
+  /// Returns the maximum number of megabytes the exploded graph of a top
+  /// level function may use.  When the graph gets close to the limit,
+  /// uninteresting nodes are reclaimed more aggressively; when it exceeds the
+  /// limit, the analysis of the function stops.
+  ///
+  /// 0 is default, which means no limit.
+  ///
+  /// This is controlled by the 'max-memory' config option.
+  unsigned getMaxMemoryPerTopLevelFunction();
+
+  /// Returns the number of partitions into which the functions of the
+  /// translation unit are divided, so that several analyzer invocations can
+  /// analyze them in parallel.  1 is default.
+  ///
+  /// This is controlled by the 'analysis-partitions' config option.
+  unsigned getAnalysisPartitionCount();
+
+  /// Returns the partition of functions analyzed by this invocation, from 0
+  /// to getAnalysisPartitionCount() - 1.  Only partition 0 runs the AST-based
+  /// checks.
+  ///
+  /// This is controlled by the 'analysis-partition' config option.
+  unsigned getAnalysisPartitionIndex();
+
 public:
   AnalyzerOptions() :
     AnalysisStoreOpt(RegionStoreModel),
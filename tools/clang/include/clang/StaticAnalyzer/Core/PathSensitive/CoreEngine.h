@@ -84,6 +84,17 @@ private:
   /// (This data is owned by AnalysisConsumer.)
   FunctionSummariesTy *FunctionSummaries;
 
+  /// The number of bytes the exploded graph may use, or 0 if its size is not
+  /// limited.
+  size_t MemoryBudget;
+
+  /// The memory usage of the graph when all of its nodes were last reclaimed.
+  size_t LastReclaimMemory;
+
+  /// Returns false if the graph has used up its memory budget, reclaiming
+  /// nodes when it gets close.
+  bool checkMemoryBudget();
+
   void generateNode(const ProgramPoint &Loc,
                     ProgramStateRef State,
                     ExplodedNode *Pred);
@@ -112,11 +123,17 @@ public:
   /// Construct a CoreEngine object to analyze the provided CFG.
   CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS)
       : SubEng(subengine), WList(WorkList::makeDFS()),
-        BCounterFactory(G.getAllocator()), FunctionSummaries(FS) {}
+        BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+        MemoryBudget(0), LastReclaimMemory(0) {}
 
   /// getGraph - Returns the exploded graph.
   ExplodedGraph &getGraph() { return G; }
 
+  /// Limits the memory used by the exploded graph to \p Bytes.  The analysis
+  /// stops once the graph exceeds its budget, as it does when it runs out of
+  /// steps.  A budget of 0 means no limit.
+  void setMemoryBudget(size_t Bytes) { MemoryBudget = Bytes; }
+
   /// ExecuteWorkList - Run the worklist algorithm for a maximum number of
   ///  steps.  Returns true if there is still simulation state on the worklist.
   bool ExecuteWorkList(const LocationContext *L, unsigned Steps,
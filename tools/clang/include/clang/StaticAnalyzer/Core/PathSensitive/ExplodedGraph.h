@@ -270,6 +270,9 @@ protected:
 
   /// NumNodes - The number of nodes in the graph.
   unsigned NumNodes;
+
+  /// The largest number of nodes that the graph has had at any one time.
+  unsigned PeakNumNodes;
   
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
@@ -321,6 +324,10 @@ public:
   bool empty() const { return NumNodes == 0; }
   unsigned size() const { return NumNodes; }
 
+  /// Returns the largest number of nodes that the graph has had, including
+  /// nodes that were reclaimed since.
+  unsigned getPeakSize() const { return PeakNumNodes; }
+
   // Iterators.
   typedef ExplodedNode                        NodeTy;
   typedef llvm::FoldingSet<ExplodedNode>      AllNodesTy;
@@ -358,6 +365,11 @@ public:
   llvm::BumpPtrAllocator & getAllocator() { return BVC.getAllocator(); }
   BumpVectorContext &getNodeAllocator() { return BVC; }
 
+  /// Returns the number of bytes allocated for the graph.  This includes the
+  /// program states, which are allocated by the same allocator.  Memory is
+  /// never returned to the allocator, so this is also the peak usage.
+  size_t getTotalMemory() { return getAllocator().getTotalMemory(); }
+
   typedef llvm::DenseMap<const ExplodedNode*, ExplodedNode*> NodeMap;
 
   /// Creates a trimmed version of the graph that only contains paths leading
@@ -385,6 +397,13 @@ public:
   /// was called.
   void reclaimRecentlyAllocatedNodes();
 
+  /// Reclaim all "uninteresting" nodes in the graph, regardless of when they
+  /// were created.  This is more expensive than
+  /// reclaimRecentlyAllocatedNodes(), and is meant to be used when the graph
+  /// is running out of its memory budget.  Does nothing unless node
+  /// reclamation is enabled.
+  void reclaimAllNodes();
+
   /// \brief Returns true if nodes for the given expression kind are always
   ///        kept around.
   static bool isInterestingLValueExpr(const Expr *Ex);
@@ -21,9 +21,8 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/SourceMgr.h"
-#include "llvm/Support/YAMLParser.h"
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -47,14 +46,27 @@ namespace tooling {
 ///
 /// JSON compilation databases can for example be generated in CMake projects
 /// by setting the flag -DCMAKE_EXPORT_COMPILE_COMMANDS.
+///
+/// Loading only scans the database for the extent of each entry and indexes
+/// the entries by file; the command lines are unescaped and split when the
+/// compile commands are requested. A database loaded from a file can also be
+/// indexed in a binary file next to it, which later loads map instead of
+/// scanning the database, see writeIndex().
 class JSONCompilationDatabase : public CompilationDatabase {
 public:
   /// \brief Loads a JSON compilation database from the specified file.
   ///
+  /// If \p UseIndex is true and the index of the database (see
+  /// getIndexPath()) was written for its current size and modification time,
+  /// the entries are read from the index as they are needed instead of
+  /// scanning the database. Otherwise the database is scanned, and with
+  /// \p UseIndex the index is written for the next load.
+  ///
   /// Returns NULL and sets ErrorMessage if the database could not be
   /// loaded from the given file.
   static std::unique_ptr<JSONCompilationDatabase>
-  loadFromFile(StringRef FilePath, std::string &ErrorMessage);
+  loadFromFile(StringRef FilePath, std::string &ErrorMessage,
+               bool UseIndex = false);
 
   /// \brief Loads a JSON compilation database from a data buffer.
   ///
@@ -79,35 +91,98 @@ public:
   /// database.
   std::vector<CompileCommand> getAllCompileCommands() const override;
 
+  /// \brief Returns the path of the index of the database at \p FilePath.
+  static std::string getIndexPath(StringRef FilePath);
+
+  /// \brief Writes a binary index of the database to getIndexPath(), so that
+  /// later calls to loadFromFile() do not need to scan the database.
+  ///
+  /// The index records the size and modification time of the database, and
+  /// is ignored once either changes. Only databases loaded from a file can be
+  /// indexed.
+  ///
+  /// Returns false and sets ErrorMessage if the index could not be written.
+  bool writeIndex(std::string &ErrorMessage) const;
+
 private:
   /// \brief Constructs a JSON compilation database on a memory buffer.
   JSONCompilationDatabase(std::unique_ptr<llvm::MemoryBuffer> Database)
-      : Database(std::move(Database)),
-        YAMLStream(this->Database->getBuffer(), SM) {}
+      : Database(std::move(Database)), NumIndexFiles(0), NumIndexCommands(0),
+        DatabaseSize(0), DatabaseModTime(0) {}
 
-  /// \brief Parses the database file and creates the index.
+  /// \brief Scans the database buffer and creates the index.
   ///
   /// Returns whether parsing succeeded. Sets ErrorMessage if parsing
   /// failed.
   bool parse(std::string &ErrorMessage);
 
-  // Tuple (directory, commandline) where 'commandline' pointing to the
-  // corresponding nodes in the YAML stream.
-  typedef std::pair<llvm::yaml::ScalarNode*,
-                    llvm::yaml::ScalarNode*> CompileCommandRef;
+  /// \brief Maps the binary index of the database at \p IndexPath.
+  ///
+  /// Returns false if the index is missing, out of date, or malformed.
+  bool readIndex(StringRef IndexPath);
+
+  /// \brief The contents of a JSON string in the database buffer, with any
+  /// escape sequences still in place.
+  struct JSONString {
+    StringRef Raw;
+    bool HasEscapes;
+  };
+
+  // Tuple (directory, commandline) of the strings in the database buffer.
+  typedef std::pair<JSONString, JSONString> CompileCommandRef;
+
+  /// \brief Adds a compile command for the given native file path to the
+  /// index.
+  void addCommand(StringRef NativeFilePath, const CompileCommandRef &Command);
 
   /// \brief Converts the given array of CompileCommandRefs to CompileCommands.
   void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
                    std::vector<CompileCommand> &Commands) const;
 
+  /// \brief Returns the file path of file \p I of the binary index, in
+  /// path order, and the range of its commands in the file command table.
+  bool getIndexFile(uint64_t I, StringRef &Path, uint64_t &FirstCommand,
+                    uint64_t &NumCommands) const;
+
+  /// \brief Returns command \p I of the binary index, in database order,
+  /// and the index of its file.
+  bool getIndexCommand(uint64_t I, uint64_t &File,
+                       CompileCommandRef &Command) const;
+
+  /// \brief Returns the index of the file with the given native path in the
+  /// binary index, or -1 if there is none.
+  int64_t findIndexFile(StringRef NativeFilePath) const;
+
+  /// \brief Appends the commands of file \p I of the binary index.
+  void getIndexFileCommands(uint64_t I,
+                            std::vector<CompileCommand> &Commands) const;
+
   // Maps file paths to the compile command lines for that file.
   llvm::StringMap< std::vector<CompileCommandRef> > IndexByFile;
 
-  FileMatchTrie MatchTrie;
+  // The file paths and compile commands in the order of the database. The
+  // file paths are the keys of IndexByFile.
+  std::vector<StringRef> AllFiles;
+  std::vector<std::pair<StringRef, CompileCommandRef> > AllCommands;
+
+  // With a binary index, the match trie is only filled in once a file path
+  // is not found in the index as it is.
+  mutable FileMatchTrie MatchTrie;
+  mutable std::once_flag MatchTrieFilled;
 
   std::unique_ptr<llvm::MemoryBuffer> Database;
-  llvm::SourceMgr SM;
-  llvm::yaml::Stream YAMLStream;
+
+  // The binary index the entries are read from, if the database was loaded
+  // through one. IndexByFile, AllFiles and AllCommands are then empty.
+  std::unique_ptr<llvm::MemoryBuffer> Index;
+  uint64_t NumIndexFiles;
+  uint64_t NumIndexCommands;
+
+  // The path, size and modification time of the database file, if the
+  // database was loaded from a file.
+  std::string DatabasePath;
+  uint64_t DatabaseSize;
+  uint64_t DatabaseModTime;
 };
 
 } // end namespace tooling
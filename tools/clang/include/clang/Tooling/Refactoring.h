@@ -52,6 +52,31 @@ public:
   /// \returns 0 upon success. Non-zero upon failure.
   int runAndSave(FrontendActionFactory *ActionFactory);
 
+  /// \brief Creates the action run by one worker thread of runInParallel(),
+  /// which records its replacements in the given set.
+  typedef std::function<std::unique_ptr<ToolAction>(Replacements &)>
+      RefactoringActionCreator;
+
+  using ClangTool::runInParallel;
+
+  /// \brief Call ClangTool::runInParallel() and add the replacements of all
+  /// workers to getReplacements().
+  ///
+  /// Each worker records its replacements in a set of its own, so actions do
+  /// not need to synchronize. Since the sets are ordered, the merged result
+  /// does not depend on how the compile commands were scheduled.
+  ///
+  /// \returns 0 upon success. Non-zero upon failure.
+  int runInParallel(RefactoringActionCreator CreateAction,
+                    unsigned NumThreads = 0);
+
+  /// \brief Call runInParallel(), apply all generated replacements, and
+  /// immediately save the results to disk.
+  ///
+  /// \returns 0 upon success. Non-zero upon failure.
+  int runAndSaveInParallel(RefactoringActionCreator CreateAction,
+                           unsigned NumThreads = 0);
+
   /// \brief Apply all stored replacements to the given Rewriter.
   ///
   /// Replacement applications happen independently of the success of other
@@ -61,6 +86,10 @@ public:
   bool applyAllReplacements(Rewriter &Rewrite);
 
 private:
+  /// \brief Apply all stored replacements and write the refactored files to
+  /// disk.
+  int applyAndSave();
+
   /// \brief Write all refactored files to disk.
   int saveRewrittenFiles(Rewriter &Rewrite);
 
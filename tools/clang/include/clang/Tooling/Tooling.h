@@ -43,6 +43,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Option/Option.h"
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -317,6 +318,36 @@ class ClangTool {
   /// \param Action Tool action.
   int run(ToolAction *Action);
 
+  /// \brief Creates the action run by one worker thread of runInParallel().
+  ///
+  /// The argument is the index of the worker thread, which is less than the
+  /// number of threads. The creator is called on the worker thread itself.
+  typedef std::function<std::unique_ptr<ToolAction>(unsigned)>
+      ToolActionCreator;
+
+  /// \brief Runs actions over all files specified in the command line using a
+  /// pool of worker threads.
+  ///
+  /// Each worker thread runs its own action, created by \p CreateAction, on
+  /// the compile commands it picks up, so actions only need to be safe
+  /// against the other threads where they share state. Every worker uses its
+  /// own FileManagers, one per working directory, and the working directory
+  /// of a compile command is resolved through them instead of by changing
+  /// the current directory of the process. The diagnostic consumer set with
+  /// setDiagnosticConsumer(), if any, is shared by all workers and must be
+  /// thread-safe.
+  ///
+  /// Unlike run(), all compile commands are looked up before the first one is
+  /// run, so the compilation database must not rely on the order in which
+  /// getCompileCommands() and the compilations are interleaved.
+  ///
+  /// \param CreateAction Creates the action of each worker thread.
+  /// \param NumThreads The number of worker threads, or 0 to use one per
+  ///        hardware thread.
+  ///
+  /// \returns 0 if all compile commands were processed successfully.
+  int runInParallel(ToolActionCreator CreateAction, unsigned NumThreads = 0);
+
   /// \brief Create an AST for each file specified in the command line and
   /// append them to ASTs.
   int buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs);
@@ -0,0 +1,55 @@
+//===--- ConstexprCallCache.cpp - Results of constexpr calls --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the ConstexprCallCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ConstexprCallCache.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+ConstexprCallCache::~ConstexprCallCache() {
+  // The entries are not owned by the folding set.
+  SmallVector<Entry *, 16> ToDelete;
+  for (Entry &E : Entries)
+    ToDelete.push_back(&E);
+  Entries.clear();
+  for (Entry *E : ToDelete)
+    delete E;
+}
+
+const ConstexprCallCache::Result *
+ConstexprCallCache::lookup(const llvm::FoldingSetNodeID &Key) {
+  void *InsertPos;
+  if (Entry *E = Entries.FindNodeOrInsertPos(Key, InsertPos))
+    return &E->R;
+  return nullptr;
+}
+
+void ConstexprCallCache::insert(const llvm::FoldingSetNodeID &Key,
+                                const APValue &Value, unsigned Steps,
+                                unsigned Depth) {
+  void *InsertPos;
+  Entry *E = Entries.FindNodeOrInsertPos(Key, InsertPos);
+  if (!E) {
+    E = new Entry(Key.Intern(KeyAlloc));
+    Entries.InsertNode(E, InsertPos);
+  }
+  E->R.Value = Value;
+  E->R.Steps = Steps;
+  E->R.Depth = Depth;
+}
+
+void ConstexprCallCache::PrintStats() const {
+  llvm::errs() << "  " << Entries.size() << " constexpr call results cached, "
+               << NumHits << " calls reused a result, " << NumMisses
+               << " calls evaluated\n";
+}
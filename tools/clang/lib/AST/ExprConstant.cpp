@@ -37,6 +37,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/AST/CharUnits.h"
+#include "clang/AST/ConstexprCallCache.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/AST/StmtVisitor.h"
@@ -426,6 +427,10 @@ namespace {
     /// CallStackDepth - The number of calls in the call stack right now.
     unsigned CallStackDepth;
 
+    /// DeepestCallStackDepth - The largest CallStackDepth reached since this
+    /// was last reset.
+    unsigned DeepestCallStackDepth;
+
     /// NextCallIndex - The next call index to assign.
     unsigned NextCallIndex;
 
@@ -450,6 +455,10 @@ namespace {
     /// declaration whose initializer is being evaluated, if any.
     APValue *EvaluatingDeclValue;
 
+    /// UsedEvaluatingDecl - Whether the evaluation has depended on which
+    /// declaration is being initialized, since this was last reset.
+    bool UsedEvaluatingDecl;
+
     /// HasActiveDiagnostic - Was the previous diagnostic stored? If so, further
     /// notes attached to it will also be stored, otherwise they will not be.
     bool HasActiveDiagnostic;
@@ -509,12 +518,12 @@ namespace {
 
     EvalInfo(const ASTContext &C, Expr::EvalStatus &S, EvaluationMode Mode)
       : Ctx(const_cast<ASTContext &>(C)), EvalStatus(S), CurrentCall(nullptr),
-        CallStackDepth(0), NextCallIndex(1),
+        CallStackDepth(0), DeepestCallStackDepth(0), NextCallIndex(1),
         StepsLeft(getLangOpts().ConstexprStepLimit),
         BottomFrame(*this, SourceLocation(), nullptr, nullptr, nullptr),
         EvaluatingDecl((const ValueDecl *)nullptr),
-        EvaluatingDeclValue(nullptr), HasActiveDiagnostic(false),
-        EvalMode(Mode) {}
+        EvaluatingDeclValue(nullptr), UsedEvaluatingDecl(false),
+        HasActiveDiagnostic(false), EvalMode(Mode) {}
 
     void setEvaluatingDecl(APValue::LValueBase Base, APValue &Value) {
       EvaluatingDecl = Base;
@@ -825,6 +834,8 @@ CallStackFrame::CallStackFrame(EvalInfo &Info, SourceLocation CallLoc,
       Index(Info.NextCallIndex++), This(This), Arguments(Arguments) {
   Info.CurrentCall = this;
   ++Info.CallStackDepth;
+  Info.DeepestCallStackDepth =
+      std::max(Info.DeepestCallStackDepth, Info.CallStackDepth);
 }
 
 CallStackFrame::~CallStackFrame() {
@@ -1330,8 +1341,10 @@ static bool CheckLiteralType(EvalInfo &Info, const Expr *E,
   // constexpr constructors for o and its subobjects even if those objects
   // are of non-literal class types.
   if (Info.getLangOpts().CPlusPlus14 && This &&
-      Info.EvaluatingDecl == This->getLValueBase())
+      Info.EvaluatingDecl == This->getLValueBase()) {
+    Info.UsedEvaluatingDecl = true;
     return true;
+  }
 
   // Prvalue constant expressions must be of literal types.
   if (Info.getLangOpts().CPlusPlus11)
@@ -1978,6 +1991,7 @@ static bool evaluateVarDeclInit(EvalInfo &Info, const Expr *E,
   // If we're currently evaluating the initializer of this declaration, use that
   // in-flight value.
   if (Info.EvaluatingDecl.dyn_cast<const ValueDecl*>() == VD) {
+    Info.UsedEvaluatingDecl = true;
     Result = Info.EvaluatingDeclValue;
     return true;
   }
@@ -2576,6 +2590,7 @@ static CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E,
         // OK, we can read and modify an object if we're in the process of
         // evaluating its initializer, because its lifetime began in this
         // evaluation.
+        Info.UsedEvaluatingDecl = true;
       } else if (AK != AK_Read) {
         // All the remaining cases only permit reading.
         Info.Diag(E, diag::note_constexpr_modify_global);
@@ -2641,6 +2656,8 @@ static CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E,
         // Therefore we use the C++1y rules in C++11 too.
         const ValueDecl *VD = Info.EvaluatingDecl.dyn_cast<const ValueDecl*>();
         const ValueDecl *ED = MTE->getExtendingDecl();
+        if (VD)
+          Info.UsedEvaluatingDecl = true;
         if (!(BaseType.isConstQualified() &&
               BaseType->isIntegralOrEnumerationType()) &&
             !(VD && VD->getCanonicalDecl() == ED->getCanonicalDecl())) {
@@ -2678,6 +2695,7 @@ static CompleteObject findCompleteObject(EvalInfo &Info, const Expr *E,
   // and this doesn't do quite the right thing for const subobjects of the
   // object under construction.
   if (LVal.getLValueBase() == Info.EvaluatingDecl) {
+    Info.UsedEvaluatingDecl = true;
     BaseType = Info.Ctx.getCanonicalType(BaseType);
     BaseType.removeLocalConst();
   }
@@ -3706,18 +3724,143 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
-/// Evaluate a function call.
-static bool HandleFunctionCall(SourceLocation CallLoc,
-                               const FunctionDecl *Callee, const LValue *This,
-                               ArrayRef<const Expr*> Args, const Stmt *Body,
-                               EvalInfo &Info, APValue &Result) {
-  ArgVector ArgValues(Args.size());
-  if (!EvaluateArgs(Args, ArgValues, Info))
+/// Determine whether a value contains nothing but numbers, so that a call
+/// using it or producing it cannot refer to any object outside the call.
+static bool isSelfContainedValue(const APValue &V) {
+  switch (V.getKind()) {
+  case APValue::Uninitialized:
+  case APValue::Int:
+  case APValue::Float:
+  case APValue::ComplexInt:
+  case APValue::ComplexFloat:
+    return true;
+  case APValue::LValue:
+  case APValue::MemberPointer:
+  case APValue::AddrLabelDiff:
     return false;
+  case APValue::Vector:
+    for (unsigned I = 0, N = V.getVectorLength(); I != N; ++I)
+      if (!isSelfContainedValue(V.getVectorElt(I)))
+        return false;
+    return true;
+  case APValue::Array:
+    for (unsigned I = 0, N = V.getArrayInitializedElts(); I != N; ++I)
+      if (!isSelfContainedValue(V.getArrayInitializedElt(I)))
+        return false;
+    return !V.hasArrayFiller() || isSelfContainedValue(V.getArrayFiller());
+  case APValue::Struct:
+    for (unsigned I = 0, N = V.getStructNumBases(); I != N; ++I)
+      if (!isSelfContainedValue(V.getStructBase(I)))
+        return false;
+    for (unsigned I = 0, N = V.getStructNumFields(); I != N; ++I)
+      if (!isSelfContainedValue(V.getStructField(I)))
+        return false;
+    return true;
+  case APValue::Union:
+    return !V.getUnionField() || isSelfContainedValue(V.getUnionValue());
+  }
+  llvm_unreachable("unknown APValue kind");
+}
 
-  if (!Info.CheckCallLimit(CallLoc))
+/// Add a self-contained value to the key of a constexpr call.
+static void profileSelfContainedValue(llvm::FoldingSetNodeID &ID,
+                                      const APValue &V) {
+  ID.AddInteger(V.getKind());
+  switch (V.getKind()) {
+  case APValue::Uninitialized:
+    return;
+  case APValue::Int:
+    V.getInt().Profile(ID);
+    return;
+  case APValue::Float:
+    V.getFloat().Profile(ID);
+    return;
+  case APValue::ComplexInt:
+    V.getComplexIntReal().Profile(ID);
+    V.getComplexIntImag().Profile(ID);
+    return;
+  case APValue::ComplexFloat:
+    V.getComplexFloatReal().Profile(ID);
+    V.getComplexFloatImag().Profile(ID);
+    return;
+  case APValue::Vector:
+    ID.AddInteger(V.getVectorLength());
+    for (unsigned I = 0, N = V.getVectorLength(); I != N; ++I)
+      profileSelfContainedValue(ID, V.getVectorElt(I));
+    return;
+  case APValue::Array:
+    ID.AddInteger(V.getArraySize());
+    ID.AddInteger(V.getArrayInitializedElts());
+    for (unsigned I = 0, N = V.getArrayInitializedElts(); I != N; ++I)
+      profileSelfContainedValue(ID, V.getArrayInitializedElt(I));
+    ID.AddBoolean(V.hasArrayFiller());
+    if (V.hasArrayFiller())
+      profileSelfContainedValue(ID, V.getArrayFiller());
+    return;
+  case APValue::Struct:
+    ID.AddInteger(V.getStructNumBases());
+    ID.AddInteger(V.getStructNumFields());
+    for (unsigned I = 0, N = V.getStructNumBases(); I != N; ++I)
+      profileSelfContainedValue(ID, V.getStructBase(I));
+    for (unsigned I = 0, N = V.getStructNumFields(); I != N; ++I)
+      profileSelfContainedValue(ID, V.getStructField(I));
+    return;
+  case APValue::Union:
+    ID.AddPointer(V.getUnionField());
+    if (V.getUnionField())
+      profileSelfContainedValue(ID, V.getUnionValue());
+    return;
+  case APValue::LValue:
+  case APValue::MemberPointer:
+  case APValue::AddrLabelDiff:
+    break;
+  }
+  llvm_unreachable("value refers to an object");
+}
+
+/// Compute the key under which the result of a call is cached in the
+/// ASTContext's ConstexprCallCache.  Returns false if the result may depend
+/// on anything but the callee and the argument values, and so must not be
+/// cached.
+static bool profileConstexprCall(llvm::FoldingSetNodeID &ID, EvalInfo &Info,
+                                 const FunctionDecl *Callee, const LValue *This,
+                                 ArrayRef<APValue> ArgValues) {
+  // Only cache calls in modes which stop at the first side-effect and
+  // diagnose everything that is not a constant expression.
+  switch (Info.EvalMode) {
+  case EvalInfo::EM_ConstantExpression:
+  case EvalInfo::EM_ConstantExpressionUnevaluated:
+  case EvalInfo::EM_ConstantFold:
+    break;
+  case EvalInfo::EM_PotentialConstantExpression:
+  case EvalInfo::EM_PotentialConstantExpressionUnevaluated:
+  case EvalInfo::EM_EvaluateForOverflow:
+  case EvalInfo::EM_IgnoreSideEffects:
     return false;
+  }
 
+  // A call with a 'this' pointer, or with arguments that point to or refer
+  // to objects, can read and modify state outside the call.
+  if (This)
+    return false;
+  for (const APValue &Arg : ArgValues)
+    if (!isSelfContainedValue(Arg))
+      return false;
+
+  ID.AddPointer(Callee);
+  ID.AddInteger(Info.EvalMode);
+  for (const APValue &Arg : ArgValues)
+    profileSelfContainedValue(ID, Arg);
+  return true;
+}
+
+/// Evaluate the body of a function call whose arguments have been evaluated.
+static bool EvaluateFunctionBody(SourceLocation CallLoc,
+                                 const FunctionDecl *Callee,
+                                 const LValue *This,
+                                 ArrayRef<const Expr*> Args,
+                                 ArgVector &ArgValues, const Stmt *Body,
+                                 EvalInfo &Info, APValue &Result) {
   CallStackFrame Frame(Info, CallLoc, Callee, This, ArgValues.data());
 
   // For a trivial copy or move assignment, perform an APValue copy. This is
@@ -3754,6 +3897,67 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   return ESR == ESR_Returned;
 }
 
+/// Evaluate a function call.
+static bool HandleFunctionCall(SourceLocation CallLoc,
+                               const FunctionDecl *Callee, const LValue *This,
+                               ArrayRef<const Expr*> Args, const Stmt *Body,
+                               EvalInfo &Info, APValue &Result) {
+  ArgVector ArgValues(Args.size());
+  if (!EvaluateArgs(Args, ArgValues, Info))
+    return false;
+
+  if (!Info.CheckCallLimit(CallLoc))
+    return false;
+
+  llvm::FoldingSetNodeID CallKey;
+  if (!profileConstexprCall(CallKey, Info, Callee, This, ArgValues))
+    return EvaluateFunctionBody(CallLoc, Callee, This, Args, ArgValues, Body,
+                                Info, Result);
+
+  // Reuse the result of an identical call, if it fits in the steps and call
+  // depth we have left.
+  ConstexprCallCache &Cache = Info.Ctx.getConstexprCallCache();
+  if (const ConstexprCallCache::Result *Cached = Cache.lookup(CallKey)) {
+    if (Cached->Steps <= Info.StepsLeft &&
+        Info.CallStackDepth + Cached->Depth - 1 <=
+            Info.getLangOpts().ConstexprCallDepth) {
+      Cache.noteHit();
+      Info.StepsLeft -= Cached->Steps;
+      Info.DeepestCallStackDepth =
+          std::max(Info.DeepestCallStackDepth,
+                   Info.CallStackDepth + Cached->Depth);
+      Result = Cached->Value;
+      return true;
+    }
+  }
+  Cache.noteMiss();
+
+  unsigned StepsBefore = Info.StepsLeft;
+  unsigned DepthBefore = Info.CallStackDepth;
+  unsigned OuterDeepest = Info.DeepestCallStackDepth;
+  bool OuterUsedEvaluatingDecl = Info.UsedEvaluatingDecl;
+  bool NoDiagsBefore = Info.EvalStatus.Diag && Info.EvalStatus.Diag->empty();
+  Info.DeepestCallStackDepth = DepthBefore;
+  Info.UsedEvaluatingDecl = false;
+
+  bool Success = EvaluateFunctionBody(CallLoc, Callee, This, Args, ArgValues,
+                                      Body, Info, Result);
+
+  // Only remember results that depend on nothing but the arguments: the call
+  // must not have produced any note (which a reused result would lose), had
+  // a side-effect, or looked at the object being initialized.
+  if (Success && NoDiagsBefore && Info.EvalStatus.Diag &&
+      Info.EvalStatus.Diag->empty() && !Info.EvalStatus.HasSideEffects &&
+      !Info.UsedEvaluatingDecl && isSelfContainedValue(Result))
+    Cache.insert(CallKey, Result, StepsBefore - Info.StepsLeft,
+                 Info.DeepestCallStackDepth - DepthBefore);
+
+  Info.DeepestCallStackDepth =
+      std::max(OuterDeepest, Info.DeepestCallStackDepth);
+  Info.UsedEvaluatingDecl |= OuterUsedEvaluatingDecl;
+  return Success;
+}
+
 /// Evaluate a constructor call.
 static bool HandleConstructorCall(SourceLocation CallLoc, const LValue &This,
                                   ArrayRef<const Expr*> Args,
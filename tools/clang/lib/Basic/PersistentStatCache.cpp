@@ -0,0 +1,261 @@
+//===--- PersistentStatCache.cpp - 'stat' cache shared on disk ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the PersistentStatCache interface.
+//
+//  A cache file consists of a header, an array of Entry records sorted by
+//  path, and the paths they refer to, all in host byte order.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/PersistentStatCache.h"
+#include "clang/Basic/Version.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace clang;
+
+namespace {
+struct CacheHeader {
+  char Magic[8];
+  uint32_t NumEntries;
+  uint32_t VersionHash;
+};
+} // end anonymous namespace
+
+static const char CacheMagic[8] = {'C', 'L', 'S', 'T', 'A', 'T', '0', '2'};
+
+/// \brief The modification time recorded for a directory that does not exist.
+static const int64_t MissingDir = std::numeric_limits<int64_t>::min();
+
+static uint32_t getVersionHash() {
+  return llvm::HashString(getClangFullRepositoryVersion());
+}
+
+PersistentStatCache::PersistentStatCache(StringRef CachePath,
+                                         ArrayRef<std::string> Roots)
+    : CachePath(CachePath), Entries(nullptr), NumEntries(0),
+      Strings(nullptr) {
+  for (const std::string &Root : Roots) {
+    StringRef Path = Root;
+    while (Path.size() > 1 && llvm::sys::path::is_separator(Path.back()))
+      Path = Path.drop_back();
+    if (llvm::sys::path::is_absolute(Path))
+      this->Roots.push_back(Path);
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+      llvm::MemoryBuffer::getFile(CachePath, -1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!File)
+    return;
+
+  // Ignore files that are truncated or were written by another compiler.
+  StringRef Contents = (*File)->getBuffer();
+  if (Contents.size() < sizeof(CacheHeader))
+    return;
+  CacheHeader Header;
+  memcpy(&Header, Contents.data(), sizeof(Header));
+  if (memcmp(Header.Magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+      Header.VersionHash != getVersionHash())
+    return;
+  uint64_t StringsOffset =
+      sizeof(CacheHeader) + uint64_t(Header.NumEntries) * sizeof(Entry);
+  if (StringsOffset > Contents.size())
+    return;
+
+  const Entry *FileEntries =
+      reinterpret_cast<const Entry *>(Contents.data() + sizeof(CacheHeader));
+  uint64_t StringsSize = Contents.size() - StringsOffset;
+  for (uint32_t I = 0; I != Header.NumEntries; ++I)
+    if (uint64_t(FileEntries[I].PathOffset) + FileEntries[I].PathLength >
+        StringsSize)
+      return;
+
+  Buffer = std::move(*File);
+  Entries = FileEntries;
+  NumEntries = Header.NumEntries;
+  Strings = Contents.data() + StringsOffset;
+}
+
+PersistentStatCache::~PersistentStatCache() {}
+
+bool PersistentStatCache::isCacheable(StringRef Path) const {
+  for (const std::string &Root : Roots) {
+    if (!Path.startswith(Root))
+      continue;
+    if (Path.size() > Root.size() &&
+        (llvm::sys::path::is_separator(Path[Root.size()]) ||
+         llvm::sys::path::is_separator(Root.back())))
+      return true;
+  }
+  return false;
+}
+
+const PersistentStatCache::DirState &
+PersistentStatCache::getDirState(StringRef Dir, vfs::FileSystem &FS) {
+  auto Known = Dirs.find(Dir);
+  if (Known != Dirs.end())
+    return Known->second;
+
+  DirState State;
+  llvm::ErrorOr<vfs::Status> Status = FS.status(Dir);
+  if (Status) {
+    State.ModTime = Status->getLastModificationTime().toEpochTime();
+    // A directory modified within the last second may change again without
+    // its modification time changing.
+    State.Recent =
+        llvm::sys::TimeValue::now().toEpochTime() - State.ModTime <= 1;
+  } else {
+    State.ModTime = MissingDir;
+    State.Recent = false;
+  }
+  return Dirs.insert(std::make_pair(Dir, State)).first->second;
+}
+
+bool PersistentStatCache::isKnownMissing(StringRef Path,
+                                         vfs::FileSystem &FS) {
+  // Learn the state of the directory even when the path is not cached, so
+  // that a result recorded after this lookup is never newer than the
+  // modification time recorded with it.
+  const DirState &Dir = getDirState(llvm::sys::path::parent_path(Path), FS);
+
+  const Entry *End = Entries + NumEntries;
+  const Entry *Found = std::lower_bound(
+      Entries, End, Path, [this](const Entry &E, StringRef Path) {
+        return StringRef(Strings + E.PathOffset, E.PathLength) < Path;
+      });
+  if (Found == End ||
+      StringRef(Strings + Found->PathOffset, Found->PathLength) != Path)
+    return false;
+  return !Dir.Recent && Dir.ModTime == Found->DirModTime;
+}
+
+void PersistentStatCache::recordMissing(StringRef Path) {
+  auto Dir = Dirs.find(llvm::sys::path::parent_path(Path));
+  if (Dir == Dirs.end() || Dir->second.Recent)
+    return;
+
+  Entry E;
+  memset(&E, 0, sizeof(E));
+  E.DirModTime = Dir->second.ModTime;
+  NewEntries[Path] = E;
+}
+
+bool PersistentStatCache::save() {
+  if (NewEntries.empty())
+    return true;
+
+  // Coordinate writing the cache file with other compilations that might try
+  // to do the same.
+  llvm::LockFileManager Locked(CachePath);
+  switch (Locked) {
+  case llvm::LockFileManager::LFS_Error:
+    return false;
+
+  case llvm::LockFileManager::LFS_Owned:
+    break;
+
+  case llvm::LockFileManager::LFS_Shared:
+    // Someone else is writing the cache file; our results will be recorded
+    // again by a later compilation.
+    return true;
+  }
+
+  // Merge with the current cache file, which may have been written since we
+  // opened it.  Our own results replace the ones in the file, and results
+  // below directories that we know have changed are dropped.
+  PersistentStatCache Latest(CachePath, Roots);
+  std::vector<std::pair<StringRef, Entry>> Merged;
+  for (uint32_t I = 0; I != Latest.NumEntries; ++I) {
+    const Entry &E = Latest.Entries[I];
+    StringRef Path(Latest.Strings + E.PathOffset, E.PathLength);
+    if (NewEntries.count(Path))
+      continue;
+    auto Dir = Dirs.find(llvm::sys::path::parent_path(Path));
+    if (Dir != Dirs.end() && Dir->second.ModTime != E.DirModTime)
+      continue;
+    Merged.push_back(std::make_pair(Path, E));
+  }
+  for (const auto &New : NewEntries)
+    Merged.push_back(std::make_pair(New.getKey(), New.getValue()));
+  std::sort(Merged.begin(), Merged.end(),
+            [](const std::pair<StringRef, Entry> &LHS,
+               const std::pair<StringRef, Entry> &RHS) {
+              return LHS.first < RHS.first;
+            });
+
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  CacheHeader Header;
+  memcpy(Header.Magic, CacheMagic, sizeof(CacheMagic));
+  Header.NumEntries = Merged.size();
+  Header.VersionHash = getVersionHash();
+  OS.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  uint32_t PathOffset = 0;
+  for (auto &Result : Merged) {
+    Result.second.PathOffset = PathOffset;
+    Result.second.PathLength = Result.first.size();
+    PathOffset += Result.first.size();
+    OS.write(reinterpret_cast<const char *>(&Result.second), sizeof(Entry));
+  }
+  for (const auto &Result : Merged)
+    OS << Result.first;
+  OS.flush();
+
+  // Write the new cache file to a temporary file and rename it over the old
+  // one, which compilations that are reading it keep mapped.
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(CachePath + "-%%%%%%%%", TmpFD, TmpPath))
+    return false;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, CachePath)) {
+    llvm::sys::fs::remove(TmpPath);
+    return false;
+  }
+
+  NewEntries.clear();
+  return true;
+}
+
+PersistentStatCalls::LookupResult
+PersistentStatCalls::getStat(const char *Path, FileData &Data, bool isFile,
+                             std::unique_ptr<vfs::File> *F,
+                             vfs::FileSystem &FS) {
+  if (&FS != vfs::getRealFileSystem().get() || !Cache->isCacheable(Path))
+    return statChained(Path, Data, isFile, F, FS);
+
+  if (Cache->isKnownMissing(Path, FS))
+    return CacheMissing;
+
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+  if (Result == CacheMissing)
+    Cache->recordMissing(Path);
+  return Result;
+}
@@ -1182,6 +1182,73 @@ unsigned SourceManager::getPresumedColumnNumber(SourceLocation Loc,
 #ifdef __SSE2__
 #include <emmintrin.h>
 #endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/// FindLineStarts - Append to \p LineOffsets the offset of the start of each
+/// physical line after the first in the buffer [Start, End).  Each of "\n",
+/// "\r", "\r\n" and "\n\r" ends a line.
+///
+/// This is very performance sensitive for programs with lots of diagnostics,
+/// in -E mode and with debug info, so newlines are looked for 32 or 16 bytes
+/// at a time when the target allows it, and each chunk is only loaded once
+/// however many lines end in it.
+static void FindLineStarts(const unsigned char *Start, const unsigned char *End,
+                           SmallVectorImpl<unsigned> &LineOffsets) {
+  // The first character that is not part of a line ending seen so far.
+  const unsigned char *LineStart = Start;
+
+  // Ends the line at the newline character at P.
+  auto EndLine = [&](const unsigned char *P) {
+    // A newline that was the second half of a "\r\n" or "\n\r" pair has
+    // already been accounted for.
+    if (P < LineStart)
+      return;
+    LineStart = P + 1;
+    if (LineStart != End && (*LineStart == '\n' || *LineStart == '\r') &&
+        *LineStart != *P)
+      ++LineStart;
+    LineOffsets.push_back(LineStart - Start);
+  };
+
+  // Ends the lines at the newline characters flagged in Mask, one bit per
+  // byte of the chunk starting at Chunk.
+  auto EndLines = [&](const unsigned char *Chunk, uint32_t Mask) {
+    while (Mask) {
+      EndLine(Chunk + llvm::countTrailingZeros(Mask));
+      Mask &= Mask - 1;
+    }
+  };
+
+  const unsigned char *Buf = Start;
+
+#ifdef __AVX2__
+  const __m256i CRs32 = _mm256_set1_epi8('\r');
+  const __m256i LFs32 = _mm256_set1_epi8('\n');
+  for (; Buf + 32 <= End; Buf += 32) {
+    const __m256i Chunk = _mm256_loadu_si256((const __m256i *)Buf);
+    __m256i Cmp = _mm256_or_si256(_mm256_cmpeq_epi8(Chunk, CRs32),
+                                  _mm256_cmpeq_epi8(Chunk, LFs32));
+    EndLines(Buf, (uint32_t)_mm256_movemask_epi8(Cmp));
+  }
+#endif
+
+#ifdef __SSE2__
+  const __m128i CRs = _mm_set1_epi8('\r');
+  const __m128i LFs = _mm_set1_epi8('\n');
+  for (; Buf + 16 <= End; Buf += 16) {
+    const __m128i Chunk = _mm_loadu_si128((const __m128i *)Buf);
+    __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
+                               _mm_cmpeq_epi8(Chunk, LFs));
+    EndLines(Buf, (uint32_t)_mm_movemask_epi8(Cmp));
+  }
+#endif
+
+  for (; Buf != End; ++Buf)
+    if (*Buf == '\n' || *Buf == '\r')
+      EndLine(Buf);
+}
 
 static LLVM_ATTRIBUTE_NOINLINE void
 ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
@@ -1202,65 +1269,8 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   // Line #1 starts at char 0.
   LineOffsets.push_back(0);
 
-  const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (1) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
-
-#ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
-
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
-    }
-#endif
-
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
-
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1])
-        ++Offs, ++Buf;
-      ++Offs, ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs, ++Buf;
-    }
-  }
+  FindLineStarts((const unsigned char *)Buffer->getBufferStart(),
+                 (const unsigned char *)Buffer->getBufferEnd(), LineOffsets);
 
   // Copy the offsets into the FileInfo structure.
   FI->NumLines = LineOffsets.size();
@@ -14,20 +14,32 @@
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/SchedulerRegistry.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -40,7 +52,10 @@
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <thread>
 using namespace clang;
 using namespace llvm;
 
@@ -111,6 +126,14 @@ private:
   /// \return True on success.
   bool AddEmitPasses(BackendAction Action, raw_pwrite_stream &OS);
 
+  /// Whether to generate the object file by splitting the optimized module
+  /// into partitions and generating code for them in parallel.
+  bool ShouldPartitionModule(BackendAction Action);
+
+  /// Generate code for the partitions of the optimized module on separate
+  /// threads and write the object file that merges them to \p OS.
+  void EmitPartitionedObject(raw_pwrite_stream &OS);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags,
                      const CodeGenOptions &CGOpts,
@@ -555,18 +578,33 @@ TargetMachine *EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
   return TM;
 }
 
-bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
-                                       raw_pwrite_stream &OS) {
-
-  // Create the code generator passes.
-  legacy::PassManager *PM = getCodeGenPasses();
-
+/// Add to \p PM the code generator passes that emit a file of kind \p CGFT
+/// for module \p M to \p OS.
+///
+/// \return True if the target cannot emit such a file.
+static bool addCodeGenPasses(legacy::PassManager &PM, TargetMachine &TM,
+                             const Module &M,
+                             const CodeGenOptions &CodeGenOpts,
+                             TargetMachine::CodeGenFileType CGFT,
+                             raw_pwrite_stream &OS) {
   // Add LibraryInfo.
-  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  llvm::Triple TargetTriple(M.getTargetTriple());
   std::unique_ptr<TargetLibraryInfoImpl> TLII(
       createTLII(TargetTriple, CodeGenOpts));
-  PM->add(new TargetLibraryInfoWrapperPass(*TLII));
+  PM.add(new TargetLibraryInfoWrapperPass(*TLII));
 
+  // Add ObjC ARC final-cleanup optimizations. This is done as part of the
+  // "codegen" passes so that it isn't run multiple times when there is
+  // inlining happening.
+  if (CodeGenOpts.OptimizationLevel > 0)
+    PM.add(createObjCARCContractPass());
+
+  return TM.addPassesToEmitFile(PM, OS, CGFT,
+                                /*DisableVerify=*/!CodeGenOpts.VerifyModule);
+}
+
+bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
+                                       raw_pwrite_stream &OS) {
   // Normal mode, emit a .s or .o file by running the code generator. Note,
   // this also adds codegenerator level optimization passes.
   TargetMachine::CodeGenFileType CGFT = TargetMachine::CGFT_AssemblyFile;
@@ -577,14 +615,9 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
   else
     assert(Action == Backend_EmitAssembly && "Invalid action!");
 
-  // Add ObjC ARC final-cleanup optimizations. This is done as part of the
-  // "codegen" passes so that it isn't run multiple times when there is
-  // inlining happening.
-  if (CodeGenOpts.OptimizationLevel > 0)
-    PM->add(createObjCARCContractPass());
-
-  if (TM->addPassesToEmitFile(*PM, OS, CGFT,
-                              /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+  // Create the code generator passes.
+  if (addCodeGenPasses(*getCodeGenPasses(), *TM, *TheModule, CodeGenOpts,
+                       CGFT, OS)) {
     Diags.Report(diag::err_fe_unable_to_interface_with_target);
     return false;
   }
@@ -592,6 +625,586 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Parallel code generation
+//===----------------------------------------------------------------------===//
+//
+// With -fbackend-partitions=N, the optimized module is split into N
+// partitions, each defining a share of the module's functions.  Partition 0
+// also defines the global variables.  A partition declares the symbols that
+// other partitions define, and the local symbols referenced across partitions
+// are given unique, hidden, external names.
+//
+// LLVMContext is not thread-safe, so the module is written as bitcode and each
+// thread reads it into its own context and drops the definitions that belong
+// to the other partitions.  The objects of the partitions are merged with
+// 'ld -r' into the object file of the translation unit.
+
+/// Calls \p Fn for each function, global variable and alias of \p M.
+static void forEachGlobalValue(Module &M,
+                               function_ref<void(GlobalValue &)> Fn) {
+  for (Function &F : M)
+    Fn(F);
+  for (GlobalVariable &GV : M.globals())
+    Fn(GV);
+  for (GlobalAlias &GA : M.aliases())
+    Fn(GA);
+}
+
+/// Calls \p Fn for each global value whose definition refers to \p V.
+static void
+forEachReferencingGlobal(const Value *V, SmallPtrSetImpl<const Value *> &Seen,
+                         function_ref<void(const GlobalValue *)> Fn) {
+  for (const User *U : V->users()) {
+    if (const Instruction *I = dyn_cast<Instruction>(U))
+      Fn(I->getParent()->getParent());
+    else if (const GlobalValue *GV = dyn_cast<GlobalValue>(U))
+      Fn(GV);
+    else if (Seen.insert(U).second)
+      forEachReferencingGlobal(U, Seen, Fn);
+  }
+}
+
+/// Assigns each definition of \p M to one of \p NumPartitions partitions,
+/// recording the owner of each by name in \p Owners.
+///
+/// Functions are dealt out by size, largest first, each to the partition
+/// with the fewest instructions so far.  Definitions that must stay together
+/// because they share a comdat are moved as a unit.
+static void partitionModule(Module &M, unsigned NumPartitions,
+                            StringMap<unsigned> &Owners) {
+  // Definitions are looked up by name in the partitions.
+  forEachGlobalValue(M, [](GlobalValue &GV) {
+    if (!GV.hasName() && !GV.isDeclaration())
+      GV.setName("__partition_unnamed");
+  });
+
+  struct Group {
+    std::vector<Function *> Functions;
+    unsigned Size;
+  };
+  std::vector<Group> Groups;
+  llvm::DenseMap<const Comdat *, unsigned> ComdatGroups;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    unsigned GroupIndex = Groups.size();
+    if (const Comdat *C = F.getComdat())
+      GroupIndex = ComdatGroups.insert(std::make_pair(C, GroupIndex))
+                       .first->second;
+    if (GroupIndex == Groups.size())
+      Groups.push_back(Group{{}, 0});
+    Groups[GroupIndex].Functions.push_back(&F);
+    for (const BasicBlock &BB : F)
+      Groups[GroupIndex].Size += BB.size();
+  }
+
+  std::vector<unsigned> Order(Groups.size());
+  for (unsigned I = 0; I != Order.size(); ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return Groups[A].Size > Groups[B].Size;
+  });
+
+  std::vector<unsigned> Load(NumPartitions, 0);
+  llvm::DenseMap<const Comdat *, unsigned> ComdatOwners;
+  for (unsigned GroupIndex : Order) {
+    unsigned Partition =
+        std::min_element(Load.begin(), Load.end()) - Load.begin();
+    Load[Partition] += Groups[GroupIndex].Size + 1;
+    for (Function *F : Groups[GroupIndex].Functions) {
+      Owners[F->getName()] = Partition;
+      if (const Comdat *C = F->getComdat())
+        ComdatOwners[C] = Partition;
+    }
+  }
+
+  for (GlobalVariable &GV : M.globals()) {
+    if (GV.isDeclaration())
+      continue;
+    unsigned Partition = 0;
+    if (const Comdat *C = GV.getComdat())
+      Partition = ComdatOwners.lookup(C);
+    Owners[GV.getName()] = Partition;
+  }
+
+  for (GlobalAlias &GA : M.aliases()) {
+    unsigned Partition = 0;
+    if (const GlobalObject *Base = GA.getBaseObject())
+      Partition = Owners.lookup(Base->getName());
+    Owners[GA.getName()] = Partition;
+  }
+}
+
+/// Returns the names of the local definitions of \p M that are referenced
+/// from another partition.
+static std::vector<std::string>
+findSharedLocals(Module &M, const StringMap<unsigned> &Owners) {
+  std::vector<std::string> Shared;
+  forEachGlobalValue(M, [&](GlobalValue &GV) {
+    if (!GV.hasLocalLinkage())
+      return;
+    unsigned Owner = Owners.lookup(GV.getName());
+    bool IsShared = false;
+    SmallPtrSet<const Value *, 8> Seen;
+    forEachReferencingGlobal(&GV, Seen, [&](const GlobalValue *User) {
+      if (Owners.lookup(User->getName()) != Owner)
+        IsShared = true;
+    });
+    if (IsShared)
+      Shared.push_back(GV.getName());
+  });
+  return Shared;
+}
+
+/// Returns a suffix for the shared local names of the module with bitcode
+/// \p Bitcode.  Local symbols of different translation units linked
+/// together must not clash, even when their modules have the same identifier
+/// and export nothing, so the suffix depends on the whole module.
+static std::string getPartitionSuffix(StringRef Bitcode) {
+  llvm::MD5 Hash;
+  Hash.update(Bitcode);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return (".partition." + Digest.str().substr(0, 16)).str();
+}
+
+/// Gives the local definitions \p Shared of \p M external names ending in
+/// \p Suffix.  Hidden visibility keeps them out of the dynamic symbol table.
+static void externalizeSharedLocals(Module &M,
+                                    ArrayRef<std::string> Shared,
+                                    StringRef Suffix) {
+  for (const std::string &Name : Shared) {
+    GlobalValue *GV = M.getNamedValue(Name);
+    GV->setName(Name + Suffix);
+    GV->setLinkage(GlobalValue::ExternalLinkage);
+    GV->setVisibility(GlobalValue::HiddenVisibility);
+  }
+}
+
+/// Turns \p M into partition \p Partition by dropping the definitions that
+/// belong to other partitions.
+static void extractPartition(Module &M, unsigned Partition,
+                             const StringMap<unsigned> &Owners) {
+  auto IsOwned = [&](const GlobalValue &GV) {
+    return Owners.lookup(GV.getName()) == Partition;
+  };
+
+  for (Function &F : M) {
+    if (F.isDeclaration() || IsOwned(F))
+      continue;
+    F.deleteBody();
+    F.setComdat(nullptr);
+  }
+
+  for (Module::global_iterator I = M.global_begin(), E = M.global_end();
+       I != E;) {
+    GlobalVariable &GV = *I++;
+    if (GV.isDeclaration() || IsOwned(GV))
+      continue;
+    // Arrays such as llvm.global_ctors and llvm.used are only emitted once.
+    if (GV.hasAppendingLinkage() && GV.use_empty()) {
+      GV.eraseFromParent();
+      continue;
+    }
+    GV.setInitializer(nullptr);
+    GV.setLinkage(GlobalValue::ExternalLinkage);
+    GV.setComdat(nullptr);
+  }
+
+  // An alias cannot refer to a declaration, so aliases defined elsewhere
+  // become declarations themselves.
+  for (Module::alias_iterator I = M.alias_begin(), E = M.alias_end();
+       I != E;) {
+    GlobalAlias &GA = *I++;
+    if (IsOwned(GA))
+      continue;
+    GlobalValue *Decl;
+    if (FunctionType *FTy =
+            dyn_cast<FunctionType>(GA.getType()->getElementType()))
+      Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &M);
+    else
+      Decl = new GlobalVariable(M, GA.getType()->getElementType(),
+                                /*isConstant=*/false,
+                                GlobalValue::ExternalLinkage,
+                                /*Initializer=*/nullptr);
+    Decl->takeName(&GA);
+    Decl->setVisibility(GA.getVisibility());
+    GA.replaceAllUsesWith(Decl);
+    GA.eraseFromParent();
+  }
+
+  if (Partition != 0) {
+    M.setModuleInlineAsm("");
+    // The debug info of the global variables goes with their definitions.
+    if (NamedMDNode *CUs = M.getNamedMetadata("llvm.dbg.cu"))
+      for (MDNode *N : CUs->operands())
+        if (DICompileUnit *CU = dyn_cast<DICompileUnit>(N))
+          CU->replaceGlobalVariables(DIGlobalVariableArray());
+  }
+}
+
+namespace {
+/// The diagnostics of the code generator for one partition.
+///
+/// The handlers of the module's context report to the DiagnosticsEngine,
+/// which is not thread-safe, so each diagnostic is recorded as a function
+/// that reports it to those handlers on the main thread once all partitions
+/// are done.  The context and module of a partition with diagnostics are kept
+/// until then, since its debug locations refer to them.
+struct PartitionDiagnostics {
+  /// The suffix of the shared local names, which is stripped to find the
+  /// definitions of the main module.
+  StringRef Suffix;
+  std::vector<std::function<void(Module &)>> Deferred;
+  bool HadError = false;
+
+  /// Returns the name of \p GV in the main module.
+  std::string getMainName(const GlobalValue &GV) const {
+    StringRef Name = GV.getName();
+    if (Name.endswith(Suffix))
+      Name = Name.drop_back(Suffix.size());
+    return Name.str();
+  }
+};
+
+/// A diagnostic of the code generator that is not handled specially, by its
+/// printed message.
+class DiagnosticInfoPartition : public DiagnosticInfo {
+  const std::string &Msg;
+
+public:
+  DiagnosticInfoPartition(DiagnosticSeverity Severity, const std::string &Msg)
+      : DiagnosticInfo(getKindID(), Severity), Msg(Msg) {}
+
+  void print(DiagnosticPrinter &DP) const override { DP << Msg; }
+
+  static int getKindID() {
+    static int KindID = getNextAvailablePluginDiagnosticKind();
+    return KindID;
+  }
+};
+}
+
+/// Records the optimization remark \p DI of kind \p RemarkT.
+template <typename RemarkT>
+static void deferOptimizationRemark(PartitionDiagnostics &PD,
+                                    const DiagnosticInfo &DI) {
+  const RemarkT &D = cast<RemarkT>(DI);
+  const char *PassName = D.getPassName();
+  std::string FnName = PD.getMainName(D.getFunction());
+  DebugLoc Loc = D.getDebugLoc();
+  std::string Msg = D.getMsg().str();
+  PD.Deferred.push_back([=](Module &M) {
+    if (const Function *F = M.getFunction(FnName))
+      M.getContext().diagnose(RemarkT(PassName, *F, Loc, Msg));
+  });
+}
+
+static void partitionDiagnosticHandler(const DiagnosticInfo &DI,
+                                       void *Context) {
+  PartitionDiagnostics &PD = *static_cast<PartitionDiagnostics *>(Context);
+  DiagnosticSeverity Severity = DI.getSeverity();
+  if (Severity == DS_Error)
+    PD.HadError = true;
+
+  switch (DI.getKind()) {
+  case DK_InlineAsm: {
+    const DiagnosticInfoInlineAsm &D = cast<DiagnosticInfoInlineAsm>(DI);
+    unsigned LocCookie = D.getLocCookie();
+    std::string Msg = D.getMsgStr().str();
+    PD.Deferred.push_back([=](Module &M) {
+      M.getContext().diagnose(DiagnosticInfoInlineAsm(LocCookie, Msg,
+                                                      Severity));
+    });
+    return;
+  }
+  case DK_StackSize: {
+    const DiagnosticInfoStackSize &D = cast<DiagnosticInfoStackSize>(DI);
+    std::string FnName = PD.getMainName(D.getFunction());
+    uint64_t StackSize = D.getStackSize();
+    PD.Deferred.push_back([=](Module &M) {
+      if (const Function *F = M.getFunction(FnName))
+        M.getContext().diagnose(DiagnosticInfoStackSize(*F, StackSize,
+                                                        Severity));
+    });
+    return;
+  }
+  case DK_OptimizationRemark:
+    deferOptimizationRemark<DiagnosticInfoOptimizationRemark>(PD, DI);
+    return;
+  case DK_OptimizationRemarkMissed:
+    deferOptimizationRemark<DiagnosticInfoOptimizationRemarkMissed>(PD, DI);
+    return;
+  case DK_OptimizationRemarkAnalysis:
+    deferOptimizationRemark<DiagnosticInfoOptimizationRemarkAnalysis>(PD, DI);
+    return;
+  case DK_OptimizationFailure: {
+    const DiagnosticInfoOptimizationFailure &D =
+        cast<DiagnosticInfoOptimizationFailure>(DI);
+    std::string FnName = PD.getMainName(D.getFunction());
+    DebugLoc Loc = D.getDebugLoc();
+    std::string Msg = D.getMsg().str();
+    PD.Deferred.push_back([=](Module &M) {
+      if (const Function *F = M.getFunction(FnName))
+        M.getContext().diagnose(
+            DiagnosticInfoOptimizationFailure(*F, Loc, Msg));
+    });
+    return;
+  }
+  default:
+    break;
+  }
+
+  std::string Msg;
+  {
+    raw_string_ostream OS(Msg);
+    DiagnosticPrinterRawOStream DP(OS);
+    DI.print(DP);
+  }
+  PD.Deferred.push_back([=](Module &M) {
+    M.getContext().diagnose(DiagnosticInfoPartition(Severity, Msg));
+  });
+}
+
+/// Reports the inline asm diagnostic \p D to the handler of \p Ctx.
+static void reportInlineAsmDiagnostic(LLVMContext &Ctx,
+                                      const llvm::SMDiagnostic &D,
+                                      unsigned LocCookie) {
+  if (LLVMContext::InlineAsmDiagHandlerTy Handler =
+          Ctx.getInlineAsmDiagnosticHandler())
+    Handler(D, Ctx.getInlineAsmDiagnosticContext(), LocCookie);
+  else
+    D.print(nullptr, llvm::errs());
+}
+
+static void partitionInlineAsmDiagHandler(const llvm::SMDiagnostic &D,
+                                          void *Context, unsigned LocCookie) {
+  PartitionDiagnostics &PD = *static_cast<PartitionDiagnostics *>(Context);
+  if (D.getKind() == llvm::SourceMgr::DK_Error)
+    PD.HadError = true;
+
+  if (D.getLoc() == SMLoc() || !D.getSourceMgr()) {
+    llvm::SMDiagnostic Copy(D.getFilename(), D.getKind(), D.getMessage());
+    PD.Deferred.push_back([=](Module &M) {
+      reportInlineAsmDiagnostic(M.getContext(), Copy, LocCookie);
+    });
+    return;
+  }
+
+  // The source manager of the inline asm is gone by the time the diagnostic
+  // is reported, so it is recreated from a copy of the buffer.
+  const llvm::SourceMgr &LSM = *D.getSourceMgr();
+  const MemoryBuffer *LBuf =
+      LSM.getMemoryBuffer(LSM.FindBufferContainingLoc(D.getLoc()));
+  auto SrcMgr = std::make_shared<llvm::SourceMgr>();
+  unsigned BufferID = SrcMgr->AddNewSourceBuffer(
+      MemoryBuffer::getMemBufferCopy(LBuf->getBuffer(),
+                                     LBuf->getBufferIdentifier()),
+      SMLoc());
+  const char *Start = SrcMgr->getMemoryBuffer(BufferID)->getBufferStart();
+  const char *Loc = Start + (D.getLoc().getPointer() - LBuf->getBufferStart());
+  const char *LineStart = Loc - D.getColumnNo();
+  SmallVector<SMRange, 4> Ranges;
+  for (const std::pair<unsigned, unsigned> &Range : D.getRanges())
+    Ranges.push_back(SMRange(SMLoc::getFromPointer(LineStart + Range.first),
+                             SMLoc::getFromPointer(LineStart + Range.second)));
+  llvm::SMDiagnostic Copy = SrcMgr->GetMessage(
+      SMLoc::getFromPointer(Loc), D.getKind(), D.getMessage(), Ranges);
+  PD.Deferred.push_back([SrcMgr, Copy, LocCookie](Module &M) {
+    reportInlineAsmDiagnostic(M.getContext(), Copy, LocCookie);
+  });
+}
+
+/// Links the objects \p Objects into the relocatable object \p Output with
+/// \p Linker.
+///
+/// \return True on success; otherwise \p ErrMsg describes the failure.
+static bool mergeObjects(StringRef Linker, ArrayRef<SmallString<0>> Objects,
+                         StringRef Output, std::string &ErrMsg) {
+  std::vector<std::string> Paths;
+  bool Success = true;
+  for (const SmallString<0> &Object : Objects) {
+    int FD;
+    SmallString<128> Path;
+    if (std::error_code EC =
+            llvm::sys::fs::createTemporaryFile("partition", "o", FD, Path)) {
+      ErrMsg = EC.message();
+      Success = false;
+      break;
+    }
+    Paths.push_back(Path.str());
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Object.str();
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      ErrMsg = "cannot write '" + Paths.back() + "'";
+      Success = false;
+      break;
+    }
+  }
+
+  if (Success) {
+    std::string LinkerPath = Linker;
+    std::string OutputArg = Output;
+    std::vector<const char *> Argv;
+    Argv.push_back(LinkerPath.c_str());
+    Argv.push_back("-r");
+    Argv.push_back("-o");
+    Argv.push_back(OutputArg.c_str());
+    for (const std::string &Path : Paths)
+      Argv.push_back(Path.c_str());
+    Argv.push_back(nullptr);
+    if (llvm::sys::ExecuteAndWait(Linker, Argv.data(), /*env=*/nullptr,
+                                  /*redirects=*/nullptr, /*secondsToWait=*/0,
+                                  /*memoryLimit=*/0, &ErrMsg) != 0) {
+      if (ErrMsg.empty())
+        ErrMsg = "'" + Linker.str() + "' failed";
+      Success = false;
+    }
+  }
+
+  for (const std::string &Path : Paths)
+    llvm::sys::fs::remove(Path);
+  return Success;
+}
+
+bool EmitAssemblyHelper::ShouldPartitionModule(BackendAction Action) {
+  if (Action != Backend_EmitObj || CodeGenOpts.BackendPartitions < 2 ||
+      CodeGenOpts.BackendPartitionLinker.empty() ||
+      !CodeGenOpts.SplitDwarfFile.empty() || llvm::TimePassesIsEnabled)
+    return false;
+
+  // The address of a block can only be taken within its own module.
+  for (const Function &F : *TheModule)
+    for (const BasicBlock &BB : F)
+      if (BB.hasAddressTaken())
+        return false;
+  return true;
+}
+
+void EmitAssemblyHelper::EmitPartitionedObject(raw_pwrite_stream &OS) {
+  unsigned NumPartitions = CodeGenOpts.BackendPartitions;
+  StringMap<unsigned> Owners;
+  partitionModule(*TheModule, NumPartitions, Owners);
+  std::vector<std::string> Shared = findSharedLocals(*TheModule, Owners);
+
+  SmallString<0> Bitcode;
+  {
+    raw_svector_ostream BCOS(Bitcode);
+    WriteBitcodeToFile(TheModule, BCOS);
+  }
+
+  // The shared locals are renamed in the partitions, after the suffix is
+  // derived from the bitcode.
+  std::string Suffix = getPartitionSuffix(Bitcode.str());
+  for (const std::string &Name : Shared) {
+    auto Owner = Owners.find(Name);
+    unsigned Partition = Owner->second;
+    Owners.erase(Owner);
+    Owners[Name + Suffix] = Partition;
+  }
+
+  // TargetMachines cache subtargets, so each thread gets its own.
+  std::vector<std::unique_ptr<TargetMachine>> TMs;
+  for (unsigned I = 0; I != NumPartitions; ++I)
+    TMs.emplace_back(TM->getTarget().createTargetMachine(
+        TheModule->getTargetTriple(), TM->getTargetCPU(),
+        TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+        TM->getCodeModel(), TM->getOptLevel()));
+
+  // Destroyed in reverse order: the diagnostics refer to the modules, which
+  // belong to the contexts.
+  std::vector<std::unique_ptr<LLVMContext>> Contexts(NumPartitions);
+  std::vector<std::unique_ptr<Module>> Modules(NumPartitions);
+  std::vector<PartitionDiagnostics> Diagnostics(NumPartitions);
+  std::vector<SmallString<0>> Objects(NumPartitions);
+  std::vector<std::string> Errors(NumPartitions);
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != NumPartitions; ++I) {
+    Diagnostics[I].Suffix = Suffix;
+    Threads.emplace_back([&, I] {
+      Contexts[I].reset(new LLVMContext);
+      LLVMContext &Ctx = *Contexts[I];
+      Ctx.setDiagnosticHandler(partitionDiagnosticHandler, &Diagnostics[I]);
+      Ctx.setInlineAsmDiagnosticHandler(partitionInlineAsmDiagHandler,
+                                        &Diagnostics[I]);
+      ErrorOr<std::unique_ptr<Module>> MOrErr =
+          parseBitcodeFile(MemoryBufferRef(Bitcode.str(), "partition"), Ctx);
+      if (std::error_code EC = MOrErr.getError()) {
+        Errors[I] = EC.message();
+        return;
+      }
+      Modules[I] = std::move(*MOrErr);
+      Module &M = *Modules[I];
+      externalizeSharedLocals(M, Shared, Suffix);
+      extractPartition(M, I, Owners);
+
+      {
+        legacy::PassManager PM;
+        PM.add(createTargetTransformInfoWrapperPass(
+            TMs[I]->getTargetIRAnalysis()));
+        raw_svector_ostream ObjOS(Objects[I]);
+        if (addCodeGenPasses(PM, *TMs[I], M, CodeGenOpts,
+                             TargetMachine::CGFT_ObjectFile, ObjOS)) {
+          Errors[I] = "unable to interface with target machine";
+          return;
+        }
+        PM.run(M);
+      }
+
+      if (Diagnostics[I].Deferred.empty()) {
+        Modules[I].reset();
+        Contexts[I].reset();
+      }
+    });
+  }
+  for (std::thread &T : Threads)
+    T.join();
+
+  // Report the diagnostics of the partitions in order, as the code generator
+  // would have reported them for the whole module.
+  bool HadError = false;
+  for (PartitionDiagnostics &PD : Diagnostics) {
+    for (const std::function<void(Module &)> &Report : PD.Deferred)
+      Report(*TheModule);
+    HadError |= PD.HadError;
+  }
+
+  for (const std::string &Error : Errors) {
+    if (!Error.empty()) {
+      Diags.Report(diag::err_fe_error_backend) << StringRef(Error).rtrim();
+      return;
+    }
+  }
+  if (HadError)
+    return;
+
+  SmallString<128> MergedPath;
+  if (std::error_code EC =
+          llvm::sys::fs::createTemporaryFile("partitions", "o", MergedPath)) {
+    Diags.Report(diag::err_fe_backend_partition_merge) << EC.message();
+    return;
+  }
+
+  std::string ErrMsg;
+  if (mergeObjects(CodeGenOpts.BackendPartitionLinker, Objects, MergedPath,
+                   ErrMsg)) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Merged =
+        MemoryBuffer::getFile(MergedPath);
+    if (Merged)
+      OS << (*Merged)->getBuffer();
+    else
+      ErrMsg = Merged.getError().message();
+  }
+  if (!ErrMsg.empty())
+    Diags.Report(diag::err_fe_backend_partition_merge) << ErrMsg;
+  llvm::sys::fs::remove(MergedPath);
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       raw_pwrite_stream *OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -608,6 +1221,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     TheModule->setDataLayout(*TM->getDataLayout());
   CreatePasses();
 
+  bool Partition = ShouldPartitionModule(Action);
+
   switch (Action) {
   case Backend_EmitNothing:
     break;
@@ -623,7 +1238,7 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
-    if (!AddEmitPasses(Action, *OS))
+    if (!Partition && !AddEmitPasses(Action, *OS))
       return;
   }
 
@@ -652,6 +1267,11 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     PrettyStackTraceString CrashInfo("Code generation");
     CodeGenPasses->run(*TheModule);
   }
+
+  if (Partition) {
+    PrettyStackTraceString CrashInfo("Parallel code generation");
+    EmitPartitionedObject(*OS);
+  }
 }
 
 void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
@@ -14,9 +14,14 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace clang::driver;
 using namespace clang;
@@ -26,7 +31,7 @@ Compilation::Compilation(const Driver &D, const ToolChain &_DefaultToolChain,
                          InputArgList *_Args, DerivedArgList *_TranslatedArgs)
     : TheDriver(D), DefaultToolChain(_DefaultToolChain), Args(_Args),
       TranslatedArgs(_TranslatedArgs), Redirects(nullptr),
-      ForDiagnostics(false) {}
+      ForDiagnostics(false), ParallelJobs(1) {}
 
 Compilation::~Compilation() {
   delete TranslatedArgs;
@@ -122,8 +127,7 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
+bool Compilation::PrintCommand(const Command &C) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
     raw_ostream *OS = &llvm::errs();
@@ -138,9 +142,8 @@ int Compilation::ExecuteCommand(const Command &C,
       if (EC) {
         getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
             << EC.message();
-        FailingCommand = &C;
         delete OS;
-        return 1;
+        return false;
       }
     }
 
@@ -152,10 +155,12 @@ int Compilation::ExecuteCommand(const Command &C,
     if (OS != &llvm::errs())
       delete OS;
   }
+  return true;
+}
 
-  std::string Error;
-  bool ExecutionFailed;
-  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+int Compilation::FinishCommand(const Command &C, int Res,
+                               const std::string &Error, bool ExecutionFailed,
+                               const Command *&FailingCommand) const {
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
     getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
@@ -167,6 +172,19 @@ int Compilation::ExecuteCommand(const Command &C,
   return ExecutionFailed ? 1 : Res;
 }
 
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommand(C)) {
+    FailingCommand = &C;
+    return 1;
+  }
+
+  std::string Error;
+  bool ExecutionFailed;
+  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  return FinishCommand(C, Res, Error, ExecutionFailed, FailingCommand);
+}
+
 typedef SmallVectorImpl< std::pair<int, const Command *> > FailingCommandList;
 
 static bool ActionFailed(const Action *A,
@@ -192,8 +210,181 @@ static bool InputsOk(const Command &C,
   return !ActionFailed(&C.getSource(), FailingCommands);
 }
 
+static bool ActionDependsOn(const Action *A, const Action *Dep) {
+  if (A == Dep)
+    return true;
+  for (const Action *Input : *A)
+    if (ActionDependsOn(Input, Dep))
+      return true;
+  return false;
+}
+
+namespace {
+/// A job run by Compilation::ExecuteJobsInParallel.
+struct ParallelJob {
+  const Command *Cmd;
+
+  /// The earlier jobs whose outputs this job uses.
+  SmallVector<unsigned, 4> Deps;
+
+  enum JobState {
+    Waiting,
+    Running,
+    /// The job ran; its result has not been reported yet.
+    Finished,
+    /// The job did not run, because a job it depends on failed.
+    Skipped,
+    Reported
+  };
+  JobState State;
+
+  /// The files receiving the job's standard output and error.
+  SmallString<128> OutPath, ErrPath;
+
+  int Res;
+  std::string Error;
+  bool ExecutionFailed;
+
+  ParallelJob()
+      : Cmd(nullptr), State(Waiting), Res(0), ExecutionFailed(false) {}
+
+  bool failed() const {
+    return State == Skipped ||
+           (State != Waiting && State != Running && (Res || ExecutionFailed));
+  }
+};
+} // end anonymous namespace
+
+/// Copy the contents of the file \p Path to \p OS, and remove the file.
+static void ReplayOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (Buffer)
+    OS << (*Buffer)->getBuffer();
+  OS.flush();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, FailingCommandList &FailingCommands) const {
+  std::vector<ParallelJob> Work(Jobs.size());
+  unsigned Index = 0;
+  for (const auto &Job : Jobs) {
+    Work[Index].Cmd = &Job;
+    // The driver creates the jobs producing an input before the jobs that
+    // use it.
+    for (unsigned I = 0; I != Index; ++I)
+      if (ActionDependsOn(&Job.getSource(), &Work[I].Cmd->getSource()))
+        Work[Index].Deps.push_back(I);
+    ++Index;
+  }
+
+  std::mutex Mutex;
+  std::condition_variable JobFinished;
+  std::vector<std::thread> Threads;
+  unsigned NumRunning = 0;
+  unsigned NextToReport = 0;
+
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (NextToReport != Work.size()) {
+    // Start the jobs whose inputs are ready, in order, while there are
+    // threads to spare.  A job whose inputs failed is skipped, as
+    // ExecuteJobs does.
+    for (unsigned I = NextToReport, E = Work.size();
+         I != E && NumRunning < ParallelJobs; ++I) {
+      ParallelJob &W = Work[I];
+      if (W.State != ParallelJob::Waiting)
+        continue;
+      bool Ready = true, InputFailed = false;
+      for (unsigned D : W.Deps) {
+        if (Work[D].failed())
+          InputFailed = true;
+        else if (Work[D].State != ParallelJob::Finished &&
+                 Work[D].State != ParallelJob::Reported)
+          Ready = false;
+      }
+      if (InputFailed) {
+        W.State = ParallelJob::Skipped;
+        continue;
+      }
+      if (!Ready)
+        continue;
+
+      // Buffer the output of the job, so that it is reported in the order of
+      // the jobs no matter which job finishes first.
+      std::error_code EC =
+          llvm::sys::fs::createTemporaryFile("clang-job", "out", W.OutPath);
+      if (!EC)
+        EC = llvm::sys::fs::createTemporaryFile("clang-job", "err", W.ErrPath);
+      if (EC) {
+        W.Error = EC.message();
+        W.Res = -1;
+        W.ExecutionFailed = true;
+        W.State = ParallelJob::Finished;
+        continue;
+      }
+
+      W.State = ParallelJob::Running;
+      ++NumRunning;
+      Threads.emplace_back([&, I] {
+        ParallelJob &W = Work[I];
+        StringRef OutPath = W.OutPath, ErrPath = W.ErrPath;
+        const StringRef *JobRedirects[] = {nullptr, &OutPath, &ErrPath};
+        std::string Error;
+        bool ExecutionFailed;
+        int Res = W.Cmd->Execute(JobRedirects, &Error, &ExecutionFailed);
+
+        std::lock_guard<std::mutex> Guard(Mutex);
+        W.Res = Res;
+        W.Error = Error;
+        W.ExecutionFailed = ExecutionFailed;
+        W.State = ParallelJob::Finished;
+        --NumRunning;
+        JobFinished.notify_one();
+      });
+    }
+
+    // Report the results of the jobs that are done, in order.
+    bool Reported = false;
+    while (NextToReport != Work.size() &&
+           (Work[NextToReport].State == ParallelJob::Finished ||
+            Work[NextToReport].State == ParallelJob::Skipped)) {
+      ParallelJob &W = Work[NextToReport++];
+      Reported = true;
+      if (W.State == ParallelJob::Skipped)
+        continue;
+      W.State = ParallelJob::Reported;
+
+      const Command *FailingCommand = nullptr;
+      bool Printed = PrintCommand(*W.Cmd);
+      ReplayOutput(W.OutPath, llvm::outs());
+      ReplayOutput(W.ErrPath, llvm::errs());
+      int Res = FinishCommand(*W.Cmd, W.Res, W.Error, W.ExecutionFailed,
+                              FailingCommand);
+      if (!Printed && !Res) {
+        FailingCommand = W.Cmd;
+        Res = 1;
+      }
+      if (Res)
+        FailingCommands.push_back(std::make_pair(Res, FailingCommand));
+    }
+
+    if (!Reported && NextToReport != Work.size())
+      JobFinished.wait(Lock);
+  }
+  Lock.unlock();
+
+  for (std::thread &T : Threads)
+    T.join();
+}
+
 void Compilation::ExecuteJobs(const JobList &Jobs,
                               FailingCommandList &FailingCommands) const {
+  if (ParallelJobs > 1 && Jobs.size() > 1 && !Redirects)
+    return ExecuteJobsInParallel(Jobs, FailingCommands);
+
   for (const auto &Job : Jobs) {
     if (!InputsOk(Job, FailingCommands))
       continue;
@@ -40,6 +40,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 #include <memory>
+#include <thread>
 
 using namespace clang::driver;
 using namespace clang;
@@ -54,8 +55,9 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
       DriverTitle("clang LLVM compiler"), CCPrintOptionsFilename(nullptr),
       CCPrintHeadersFilename(nullptr), CCLogDiagnosticsFilename(nullptr),
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-      CCGenDiagnostics(false), CCCGenericGCCName(""), CheckInputsExist(true),
-      CCCUsePCH(true), SuppressMissingInputWarning(false) {
+      CCGenDiagnostics(false), CC1Main(nullptr), CCCGenericGCCName(""),
+      CheckInputsExist(true), CCCUsePCH(true),
+      SuppressMissingInputWarning(false) {
 
   Name = llvm::sys::path::filename(ClangExecutable);
   Dir = llvm::sys::path::parent_path(ClangExecutable);
@@ -452,6 +454,15 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // The compilation takes ownership of Args.
   Compilation *C = new Compilation(*this, TC, UArgs.release(), TranslatedArgs);
 
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_j)) {
+    unsigned Jobs;
+    if (StringRef(A->getValue()).getAsInteger(10, Jobs))
+      Diag(clang::diag::err_drv_invalid_int_value)
+          << A->getAsString(C->getArgs()) << A->getValue();
+    else
+      C->setParallelJobs(Jobs ? Jobs : std::thread::hardware_concurrency());
+  }
+
   if (!HandleImmediateArgs(*C))
     return C;
 
@@ -291,6 +291,61 @@ int FallbackCommand::Execute(const StringRef **Redirects, std::string *ErrMsg,
   return SecondaryStatus;
 }
 
+CC1Command::CC1Command(const Action &Source, const Tool &Creator,
+                       const char *Executable,
+                       const ArgStringList &Arguments)
+    : Command(Source, Creator, Executable, Arguments) {}
+
+void CC1Command::Print(raw_ostream &OS, const char *Terminator, bool Quote,
+                       CrashReportInfo *CrashInfo) const {
+  // Commands printed for a crash report are run as separate processes.
+  if (!CrashInfo && canRunInProcess(/*Redirects=*/nullptr))
+    OS << " (in-process)\n";
+  Command::Print(OS, Terminator, Quote, CrashInfo);
+}
+
+bool CC1Command::canRunInProcess(const StringRef **Redirects) const {
+  const Driver &D = getCreator().getToolChain().getDriver();
+  if (!D.CC1Main || Redirects)
+    return false;
+
+  // Options given with -mllvm, and the backend options that the code
+  // generator passes to cl::ParseCommandLineOptions, are parsed into global
+  // variables, which can only be set once per process.  Without
+  // -disable-free, the compiler shuts down LLVM's managed statics when it is
+  // done, which the driver still uses.
+  bool DisableFree = false;
+  for (const char *Arg : getArguments()) {
+    if (llvm::StringSwitch<bool>(Arg)
+            .Cases("-mllvm", "-backend-option", true)
+            .Cases("-mdebug-pass", "-mlimit-float-precision", true)
+            .Default(false))
+      return false;
+    if (StringRef(Arg) == "-disable-free")
+      DisableFree = true;
+  }
+  return DisableFree;
+}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  if (!canRunInProcess(Redirects))
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+
+  SmallVector<const char *, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  // A crash is returned as a negative status, the way a process killed by a
+  // signal fails, so that the driver cleans up after the job and generates a
+  // crash report, running the compiler again in a separate process.
+  const Driver &D = getCreator().getToolChain().getDriver();
+  return D.CC1Main(Argv);
+}
+
 void JobList::Print(raw_ostream &OS, const char *Terminator, bool Quote,
                     CrashReportInfo *CrashInfo) const {
   for (const auto &Job : *this)
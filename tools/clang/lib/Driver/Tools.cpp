@@ -3644,6 +3644,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   CmdArgs.push_back(D.ResourceDir.c_str());
 
   Args.AddLastArg(CmdArgs, options::OPT_working_directory);
+  Args.AddLastArg(CmdArgs, options::OPT_fstat_cache_path_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_token_cache_EQ);
 
   bool ARCMTEnabled = false;
   if (!Args.hasArg(options::OPT_fno_objc_arc, options::OPT_fobjc_arc)) {
@@ -4023,6 +4025,16 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   Args.AddLastArg(CmdArgs, options::OPT_ftrap_function_EQ);
 
+  // The objects of the module partitions are merged with 'ld -r', which
+  // link.exe does not support.
+  if (Arg *A = Args.getLastArg(options::OPT_fbackend_partitions_EQ)) {
+    if (!getToolChain().getTriple().isWindowsMSVCEnvironment()) {
+      A->render(Args, CmdArgs);
+      CmdArgs.push_back("-backend-partition-linker");
+      CmdArgs.push_back(Args.MakeArgString(getToolChain().GetLinkerPath()));
+    }
+  }
+
   // -fno-strict-overflow implies -fwrapv if it isn't disabled, but
   // -fstrict-overflow won't turn off an explicitly enabled -fwrapv.
   if (Arg *A = Args.getLastArg(options::OPT_fwrapv, options::OPT_fno_wrapv)) {
@@ -4291,6 +4303,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   }
 
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_search_dir_cache);
 
   // -faccess-control is default.
   if (Args.hasFlag(options::OPT_fno_access_control,
@@ -4885,6 +4898,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
         getCLFallback()->GetCommand(C, JA, Output, Inputs, Args, LinkingOutput);
     C.addCommand(llvm::make_unique<FallbackCommand>(JA, *this, Exec, CmdArgs,
                                                     std::move(CLCommand)));
+  } else if (Args.hasFlag(options::OPT_fintegrated_cc1,
+                          options::OPT_fno_integrated_cc1, false) &&
+             !C.isForDiagnostics()) {
+    C.addCommand(llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs));
   } else {
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs));
   }
@@ -1276,12 +1276,13 @@ static StringRef getLanguageName(FormatStyle::LanguageKind Language) {
 class Formatter : public UnwrappedLineConsumer {
 public:
   Formatter(const FormatStyle &Style, SourceManager &SourceMgr, FileID ID,
-            ArrayRef<CharSourceRange> Ranges)
+            ArrayRef<CharSourceRange> Ranges, FormattingCache *Cache)
       : Style(Style), ID(ID), SourceMgr(SourceMgr),
         Whitespaces(SourceMgr, Style,
                     inputUsesCRLF(SourceMgr.getBufferData(ID))),
         Ranges(Ranges.begin(), Ranges.end()), UnwrappedLines(1),
-        Encoding(encoding::detectEncoding(SourceMgr.getBufferData(ID))) {
+        Encoding(encoding::detectEncoding(SourceMgr.getBufferData(ID))),
+        Cache(Cache) {
     DEBUG(llvm::dbgs() << "File encoding: "
                        << (Encoding == encoding::Encoding_UTF8 ? "UTF8"
                                                                : "unknown")
@@ -1341,8 +1342,17 @@ public:
     ContinuationIndenter Indenter(Style, Tokens.getKeywords(), SourceMgr,
                                   Whitespaces, Encoding,
                                   BinPackInconclusiveFunctions);
+
+    // Cached line breaking decisions depend on the style, including the parts
+    // derived from this file, and on how the indenter is set up.
+    std::string CacheContext;
+    if (Cache) {
+      CacheContext = configurationAsText(Style);
+      CacheContext += Encoding == encoding::Encoding_UTF8 ? "\nUTF8" : "\n";
+      CacheContext += BinPackInconclusiveFunctions ? "\nBinPack" : "\n";
+    }
     UnwrappedLineFormatter(&Indenter, &Whitespaces, Style, Tokens.getKeywords(),
-                           IncompleteFormat)
+                           IncompleteFormat, Cache, CacheContext)
         .format(AnnotatedLines);
     return Whitespaces.generateReplacements();
   }
@@ -1556,6 +1566,7 @@ private:
 
   encoding::Encoding Encoding;
   bool BinPackInconclusiveFunctions;
+  FormattingCache *Cache;
 };
 
 } // end anonymous namespace
@@ -1563,10 +1574,11 @@ private:
 tooling::Replacements reformat(const FormatStyle &Style,
                                SourceManager &SourceMgr, FileID ID,
                                ArrayRef<CharSourceRange> Ranges,
-                               bool *IncompleteFormat) {
+                               bool *IncompleteFormat,
+                               FormattingCache *Cache) {
   if (Style.DisableFormat)
     return tooling::Replacements();
-  Formatter formatter(Style, SourceMgr, ID, Ranges);
+  Formatter formatter(Style, SourceMgr, ID, Ranges, Cache);
   return formatter.format(IncompleteFormat);
 }
 
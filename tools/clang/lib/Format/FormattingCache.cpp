@@ -0,0 +1,129 @@
+//===--- FormattingCache.cpp - Line breaking decisions across runs --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements the FormattingCache.
+///
+/// A cache file is a text file.  Its first line names the version of the
+/// formatter that wrote it; every other line holds a digest and a string of
+/// '0' and '1' characters, one per decision.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Format/FormattingCache.h"
+#include "clang/Basic/Version.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <tuple>
+
+namespace clang {
+namespace format {
+
+/// \brief The number of entries beyond which entries that were not used by
+/// the current run are dropped when saving.
+static const unsigned MaxUnusedEntries = 1 << 18;
+
+static std::string getCacheHeader() {
+  return "clang-format-cache " + getClangFullRepositoryVersion();
+}
+
+bool FormattingCache::load(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!File)
+    return File.getError() == std::errc::no_such_file_or_directory;
+
+  StringRef Contents = (*File)->getBuffer();
+  StringRef Header;
+  std::tie(Header, Contents) = Contents.split('\n');
+  if (Header != getCacheHeader())
+    return true;
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  while (!Contents.empty()) {
+    StringRef Line;
+    std::tie(Line, Contents) = Contents.split('\n');
+    StringRef Key, Decisions;
+    std::tie(Key, Decisions) = Line.split(' ');
+    if (Key.empty() || Decisions.find_first_not_of("01") != StringRef::npos)
+      continue;
+    Entry &E = Entries[Key];
+    E.NewLines.clear();
+    for (char C : Decisions)
+      E.NewLines.push_back(C == '1');
+    E.Used = false;
+  }
+  return true;
+}
+
+bool FormattingCache::save(StringRef Path) {
+  std::string Contents = getCacheHeader() + "\n";
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    bool DropUnused = Entries.size() > MaxUnusedEntries;
+    for (const auto &E : Entries) {
+      if (DropUnused && !E.getValue().Used)
+        continue;
+      Contents += E.getKey();
+      Contents += ' ';
+      for (bool NewLine : E.getValue().NewLines)
+        Contents += NewLine ? '1' : '0';
+      Contents += '\n';
+    }
+  }
+
+  // Write to a temporary file and rename it over the cache, so that other
+  // runs never see a partially written cache.
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", TmpFD, TmpPath))
+    return false;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return false;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, Path)) {
+    llvm::sys::fs::remove(TmpPath);
+    return false;
+  }
+  return true;
+}
+
+bool FormattingCache::lookup(StringRef Key, std::vector<bool> &NewLines) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = Entries.find(Key);
+  if (I == Entries.end())
+    return false;
+  I->getValue().Used = true;
+  NewLines = I->getValue().NewLines;
+  return true;
+}
+
+void FormattingCache::insert(StringRef Key, ArrayRef<bool> NewLines) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entry &E = Entries[Key];
+  E.NewLines.assign(NewLines.begin(), NewLines.end());
+  E.Used = true;
+}
+
+unsigned FormattingCache::size() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Entries.size();
+}
+
+} // end namespace format
+} // end namespace clang
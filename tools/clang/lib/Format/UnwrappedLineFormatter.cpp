@@ -9,7 +9,13 @@
 
 #include "UnwrappedLineFormatter.h"
 #include "WhitespaceManager.h"
+#include "clang/Format/FormattingCache.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MD5.h"
+#include <algorithm>
+#include <unordered_map>
 
 #define DEBUG_TYPE "format-formatter"
 
@@ -617,14 +623,59 @@ public:
   }
 };
 
+/// \brief Returns the digest under which the line breaking decisions for
+/// \p Line are cached, or an empty string if they may not be cached.
+///
+/// The digest covers the tokens of the line and their annotations, so that
+/// it changes whenever the search for the best line breaks could find a
+/// different solution.
+static std::string getLineCacheKey(const AnnotatedLine &Line,
+                                   unsigned FirstIndent, StringRef Context) {
+  llvm::MD5 Hash;
+  auto AddNumber = [&](unsigned Value) {
+    Hash.update(llvm::makeArrayRef((const uint8_t *)&Value, sizeof(Value)));
+  };
+  Hash.update(Context);
+  AddNumber(FirstIndent);
+  AddNumber(Line.Type);
+  AddNumber(Line.Level);
+  AddNumber(Line.InPPDirective);
+  AddNumber(Line.MustBeDeclaration);
+  for (const FormatToken *Tok = Line.First; Tok; Tok = Tok->Next) {
+    // Nested blocks are formatted along with the line, and decisions that
+    // were already taken constrain the search; neither is part of the digest.
+    if (!Tok->Children.empty() || Tok->Finalized ||
+        Tok->Decision != FD_Unformatted)
+      return std::string();
+    AddNumber(Tok->TokenText.size());
+    Hash.update(Tok->TokenText);
+    AddNumber(Tok->Tok.getKind());
+    AddNumber(Tok->Type);
+    AddNumber(Tok->BlockKind);
+    AddNumber(Tok->NewlinesBefore);
+    AddNumber(Tok->OriginalColumn);
+    AddNumber(Tok->SpacesRequiredBefore);
+    AddNumber(Tok->SplitPenalty);
+    AddNumber(Tok->MustBreakBefore);
+    AddNumber(Tok->CanBreakBefore);
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
 /// \brief Finds the best way to break lines.
 class OptimizingLineFormatter : public LineFormatter {
 public:
   OptimizingLineFormatter(ContinuationIndenter *Indenter,
                           WhitespaceManager *Whitespaces,
                           const FormatStyle &Style,
-                          UnwrappedLineFormatter *BlockFormatter)
-      : LineFormatter(Indenter, Whitespaces, Style, BlockFormatter) {}
+                          UnwrappedLineFormatter *BlockFormatter,
+                          FormattingCache *Cache, StringRef CacheContext)
+      : LineFormatter(Indenter, Whitespaces, Style, BlockFormatter),
+        Cache(Cache), CacheContext(CacheContext) {}
 
   /// \brief Formats the line by finding the best line breaks with line lengths
   /// below the column limit.
@@ -637,11 +688,48 @@ public:
     if (State.Line->Type == LT_ObjCMethodDecl)
       State.Stack.back().BreakBeforeParameter = true;
 
+    // Replay the decisions of an earlier run if the line is unchanged.
+    std::string CacheKey;
+    if (Cache) {
+      CacheKey = getLineCacheKey(Line, FirstIndent, CacheContext);
+      std::vector<bool> NewLines;
+      unsigned Penalty;
+      if (!CacheKey.empty() && Cache->lookup(CacheKey, NewLines) &&
+          applyDecisions(State, NewLines, /*DryRun=*/true, Penalty)) {
+        if (!DryRun)
+          applyDecisions(State, NewLines, /*DryRun=*/false, Penalty);
+        return Penalty;
+      }
+    }
+
     // Find best solution in solution space.
-    return analyzeSolutionSpace(State, DryRun);
+    std::vector<bool> Solution;
+    unsigned Penalty = analyzeSolutionSpace(
+        State, DryRun, CacheKey.empty() ? nullptr : &Solution);
+    if (!Solution.empty())
+      Cache->insert(CacheKey, Solution);
+    return Penalty;
   }
 
 private:
+  /// \brief Places the remaining tokens of \p State's line, starting a new
+  /// line before each token for which \p NewLines is \c true.
+  ///
+  /// Returns \c false if the decisions do not fit the line, in which case
+  /// changes may have been applied unless \p DryRun is \c true.
+  bool applyDecisions(LineState State, ArrayRef<bool> NewLines, bool DryRun,
+                      unsigned &Penalty) {
+    Penalty = 0;
+    for (bool NewLine : NewLines) {
+      if (!State.NextToken)
+        return false;
+      if (NewLine ? !Indenter->canBreak(State) : Indenter->mustBreak(State))
+        return false;
+      Penalty += Indenter->addTokenToState(State, NewLine, DryRun);
+    }
+    return !State.NextToken;
+  }
+
   struct CompareLineStatePointers {
     bool operator()(LineState *obj1, LineState *obj2) const {
       return *obj1 < *obj2;
@@ -659,12 +747,50 @@ private:
   /// inserting a newline dependent on the \c NewLine.
   struct StateNode {
     StateNode(const LineState &State, bool NewLine, StateNode *Previous)
-        : State(State), NewLine(NewLine), Previous(Previous) {}
+        : State(State), NewLine(NewLine), Previous(Previous), Hash(0) {}
     LineState State;
     bool NewLine;
     StateNode *Previous;
+    /// \brief The hash of \c State when the node was queued.
+    size_t Hash;
+  };
+
+  /// \brief Hashes the parts of a \c LineState that are compared by its
+  /// \c operator<, so that states the search considers equal have the same
+  /// hash.
+  static size_t hashState(const LineState &State) {
+    size_t Hash = llvm::hash_combine(
+        State.NextToken, State.Column,
+        State.LineContainsContinuedForLoopSection, State.StartOfLineLevel,
+        State.LowestLevelOnLine, State.StartOfStringLiteral);
+    if (State.IgnoreStackForComparison)
+      return Hash;
+    for (const ParenState &Paren : State.Stack)
+      Hash = llvm::hash_combine(Hash, Paren.Indent, Paren.LastSpace,
+                                Paren.NestedBlockIndent,
+                                Paren.BreakBeforeParameter, Paren.NoLineBreak);
+    return Hash;
+  }
+
+  struct StateNodeHash {
+    size_t operator()(const StateNode *Node) const { return Node->Hash; }
+  };
+
+  struct StateNodeEqual {
+    bool operator()(const StateNode *A, const StateNode *B) const {
+      return !(A->State < B->State) && !(B->State < A->State);
+    }
   };
 
+  /// \brief The lowest penalty with which each state has been queued.
+  ///
+  /// Of two equal states, the one queued with the higher penalty, or later
+  /// with the same penalty, is skipped when it is dequeued.  Such dominated
+  /// states are not queued at all, which keeps the queue small when many
+  /// paths through the solution space lead to the same state.
+  typedef std::unordered_map<StateNode *, unsigned, StateNodeHash,
+                             StateNodeEqual> QueuedStatesMap;
+
   /// \brief An item in the prioritized BFS search queue. The \c StateNode's
   /// \c State has the given \c OrderedPenalty.
   typedef std::pair<OrderedPenalty, StateNode *> QueueItem;
@@ -680,9 +806,13 @@ private:
   /// find the shortest path (the one with lowest penalty) from \p InitialState
   /// to a state where all tokens are placed. Returns the penalty.
   ///
-  /// If \p DryRun is \c false, directly applies the changes.
-  unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun) {
+  /// If \p DryRun is \c false, directly applies the changes.  If
+  /// \p Solution is not null, it receives the line breaking decisions of the
+  /// solution.
+  unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun,
+                                std::vector<bool> *Solution = nullptr) {
     std::set<LineState *, CompareLineStatePointers> Seen;
+    QueuedStatesMap Queued;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -718,9 +848,11 @@ private:
 
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue,
+                            &Queued);
       if (LastFormat == FD_Unformatted || LastFormat == FD_Break)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue,
+                            &Queued);
     }
 
     if (Queue.empty()) {
@@ -733,8 +865,16 @@ private:
     // Reconstruct the solution.
     if (!DryRun)
       reconstructPath(InitialState, Queue.top().second);
+    if (Solution) {
+      for (StateNode *Node = Queue.top().second; Node->Previous;
+           Node = Node->Previous)
+        Solution->push_back(Node->NewLine);
+      std::reverse(Solution->begin(), Solution->end());
+    }
 
     DEBUG(llvm::dbgs() << "Total number of analyzed states: " << Count << "\n");
+    DEBUG(llvm::dbgs() << "Number of distinct queued states: " << Queued.size()
+                       << "\n");
     DEBUG(llvm::dbgs() << "---\n");
 
     return Penalty;
@@ -744,8 +884,10 @@ private:
   ///
   /// Assume the current state is \p PreviousNode and has been reached with a
   /// penalty of \p Penalty. Insert a line break if \p NewLine is \c true.
+  /// The state is not inserted if \p Queued shows that it is dominated.
   void addNextStateToQueue(unsigned Penalty, StateNode *PreviousNode,
-                           bool NewLine, unsigned *Count, QueueType *Queue) {
+                           bool NewLine, unsigned *Count, QueueType *Queue,
+                           QueuedStatesMap *Queued) {
     if (NewLine && !Indenter->canBreak(PreviousNode->State))
       return;
     if (!NewLine && Indenter->mustBreak(PreviousNode->State))
@@ -758,6 +900,14 @@ private:
 
     Penalty += Indenter->addTokenToState(Node->State, NewLine, true);
 
+    Node->Hash = hashState(Node->State);
+    auto Inserted = Queued->insert(std::make_pair(Node, Penalty));
+    if (!Inserted.second) {
+      if (Inserted.first->second <= Penalty)
+        return;
+      Inserted.first->second = Penalty;
+    }
+
     Queue->push(QueueItem(OrderedPenalty(Penalty, *Count), Node));
     ++(*Count);
   }
@@ -789,6 +939,8 @@ private:
   }
 
   llvm::SpecificBumpPtrAllocator<StateNode> Allocator;
+  FormattingCache *Cache;
+  StringRef CacheContext;
 };
 
 } // namespace
@@ -843,7 +995,8 @@ UnwrappedLineFormatter::format(const SmallVectorImpl<AnnotatedLine *> &Lines,
         Penalty += NoLineBreakFormatter(Indenter, Whitespaces, Style, this)
                        .formatLine(TheLine, Indent, DryRun);
       else
-        Penalty += OptimizingLineFormatter(Indenter, Whitespaces, Style, this)
+        Penalty += OptimizingLineFormatter(Indenter, Whitespaces, Style, this,
+                                           Cache, CacheContext)
                        .formatLine(TheLine, Indent, DryRun);
     } else {
       // If no token in the current line is affected, we still need to format
@@ -26,6 +26,7 @@ namespace clang {
 namespace format {
 
 class ContinuationIndenter;
+class FormattingCache;
 class WhitespaceManager;
 
 class UnwrappedLineFormatter {
@@ -34,9 +35,12 @@ public:
                          WhitespaceManager *Whitespaces,
                          const FormatStyle &Style,
                          const AdditionalKeywords &Keywords,
-                         bool *IncompleteFormat)
+                         bool *IncompleteFormat,
+                         FormattingCache *Cache = nullptr,
+                         StringRef CacheContext = StringRef())
       : Indenter(Indenter), Whitespaces(Whitespaces), Style(Style),
-        Keywords(Keywords), IncompleteFormat(IncompleteFormat) {}
+        Keywords(Keywords), IncompleteFormat(IncompleteFormat), Cache(Cache),
+        CacheContext(CacheContext) {}
 
   /// \brief Format the current block and return the penalty.
   unsigned format(const SmallVectorImpl<AnnotatedLine *> &Lines,
@@ -66,6 +70,13 @@ private:
   const FormatStyle &Style;
   const AdditionalKeywords &Keywords;
   bool *IncompleteFormat;
+
+  /// \brief The line breaking decisions of earlier runs, if any.
+  FormattingCache *Cache;
+
+  /// \brief Everything besides the line itself that the line breaking
+  /// decisions depend on, such as the style.
+  StringRef CacheContext;
 };
 } // end namespace format
 } // end namespace clang
@@ -95,13 +95,14 @@ private:
   bool eof() { return Token && Token->HasUnescapedNewline; }
 
   FormatToken *getFakeEOF() {
-    static bool EOFInitialized = false;
-    static FormatToken FormatTok;
-    if (!EOFInitialized) {
-      FormatTok.Tok.startToken();
-      FormatTok.Tok.setKind(tok::eof);
-      EOFInitialized = true;
-    }
+    // Initialized on first use, once even if several threads are formatting.
+    struct FakeEOF : FormatToken {
+      FakeEOF() {
+        Tok.startToken();
+        Tok.setKind(tok::eof);
+      }
+    };
+    static FakeEOF FormatTok;
     return &FormatTok;
   }
 
@@ -2106,6 +2106,10 @@ namespace {
                        |  (1LL << CodeCompletionContext::CCC_ClassOrStructTag);
     }
 
+    bool isResultFilteredOut(const CodeCompletionResult &Result) override {
+      return Next.isResultFilteredOut(Result);
+    }
+
     void ProcessCodeCompleteResults(Sema &S, CodeCompletionContext Context,
                                     CodeCompletionResult *Results,
                                     unsigned NumResults) override;
@@ -2232,6 +2236,11 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     // interested in, we'll add this result.
     if ((C->ShowInContexts & InContexts) == 0)
       continue;
+
+    // Skip results the consumer does not want.
+    if (Next.isResultFilteredOut(Result(C->Completion, C->Priority, C->Kind,
+                                        C->Availability)))
+      continue;
     
     // If we haven't added any results previously, do so now.
     if (!AddedResult) {
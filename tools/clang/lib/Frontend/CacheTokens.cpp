@@ -18,12 +18,17 @@
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/HeaderTokenCache.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
@@ -191,6 +196,10 @@ class PTHWriter {
   Offset CurStrOffset;
   std::vector<llvm::StringMapEntry<OffsetOpt>*> StrEntries;
 
+  /// Whether the tokens of the file being lexed can be read back from the
+  /// PTH file.
+  bool Representable;
+
   //// Get the persistent id for the given IdentifierInfo*.
   uint32_t ResolveID(const IdentifierInfo* II);
 
@@ -232,15 +241,27 @@ class PTHWriter {
   /// token data.
   Offset EmitFileTable() { return PM.Emit(Out); }
 
-  PTHEntry LexTokens(Lexer& L);
+  /// LexTokens - Emits the tokens of the file lexed by L.  Returns false if
+  ///  they cannot be read back, because the file has unbalanced conditionals
+  ///  or a token that is too long.
+  bool LexTokens(Lexer& L, PTHEntry &Entry);
   Offset EmitCachedSpellings();
 
+  /// EmitPrologue - Emits the prologue, leaving room for the offsets of the
+  ///  tables, which are filled in by EmitTables.
+  Offset EmitPrologue(StringRef MainFile);
+  void EmitTables(Offset PrologueOffset);
+
 public:
   PTHWriter(raw_pwrite_stream &out, Preprocessor &pp)
-      : Out(out), PP(pp), idcount(0), CurStrOffset(0) {}
+      : Out(out), PP(pp), idcount(0), CurStrOffset(0), Representable(true) {}
 
   PTHMap &getPM() { return PM; }
   void GeneratePTH(const std::string &MainFile);
+
+  /// GenerateHeaderPTH - Generates a PTH file that holds the tokens of the
+  ///  file FID alone.  Returns false if its tokens cannot be cached.
+  bool GenerateHeaderPTH(FileID FID);
 };
 } // end anonymous namespace
 
@@ -258,6 +279,10 @@ uint32_t PTHWriter::ResolveID(const IdentifierInfo* II) {
 }
 
 void PTHWriter::EmitToken(const Token& T) {
+  // The length of a token is stored in 16 bits.
+  if (T.getLength() > 0xFFFF)
+    Representable = false;
+
   // Emit the token kind, flags, and length.
   Emit32(((uint32_t) T.getKind()) | ((((uint32_t) T.getFlags())) << 8)|
          (((uint32_t) T.getLength()) << 16));
@@ -288,7 +313,9 @@ void PTHWriter::EmitToken(const Token& T) {
   Emit32(PP.getSourceManager().getFileOffset(T.getLocation()));
 }
 
-PTHEntry PTHWriter::LexTokens(Lexer& L) {
+bool PTHWriter::LexTokens(Lexer& L, PTHEntry &Entry) {
+  Representable = true;
+
   // Pad 0's so that we emit tokens to a 4-byte alignment.
   // This speed up reading them back in.
   using namespace llvm::support;
@@ -394,8 +421,12 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
         // This will later be set to zero when emitting to the PTH file.  We
         // use 0 for uninitialized indices because that is easier to debug.
         unsigned index = PPCond.size();
+        // An '#endif' without an '#if' cannot be skipped to.
+        if (PPStartCond.empty()) {
+          Representable = false;
+          break;
+        }
         // Backpatch the opening '#if' entry.
-        assert(!PPStartCond.empty());
         assert(PPCond.size() > PPStartCond.back());
         assert(PPCond[PPStartCond.back()].second == 0);
         PPCond[PPStartCond.back()].second = index;
@@ -419,8 +450,11 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
         // This serves as both a closing and opening of a conditional block.
         // This means that its entry will get backpatched later.
         unsigned index = PPCond.size();
+        if (PPStartCond.empty()) {
+          Representable = false;
+          break;
+        }
         // Backpatch the previous '#if' entry.
-        assert(!PPStartCond.empty());
         assert(PPCond.size() > PPStartCond.back());
         assert(PPCond[PPStartCond.back()].second == 0);
         PPCond[PPStartCond.back()].second = index;
@@ -437,7 +471,12 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
   }
   while (Tok.isNot(tok::eof));
 
-  assert(PPStartCond.empty() && "Error: imblanced preprocessor conditionals.");
+  // The conditionals of a file that does not balance them cannot be skipped
+  // using the table; such a file is not cached.
+  if (!PPStartCond.empty())
+    Representable = false;
+  if (!Representable)
+    PPCond.clear();
 
   // Next write out PPCond.
   Offset PPCondOff = (Offset) Out.tell();
@@ -454,7 +493,8 @@ PTHEntry PTHWriter::LexTokens(Lexer& L) {
     Emit32(x == i ? 0 : x);
   }
 
-  return PTHEntry(TokenOff, PPCondOff);
+  Entry = PTHEntry(TokenOff, PPCondOff);
+  return Representable;
 }
 
 Offset PTHWriter::EmitCachedSpellings() {
@@ -478,7 +518,7 @@ static void pwrite32le(raw_pwrite_stream &OS, uint32_t Val, uint64_t &Off) {
   Off += 4;
 }
 
-void PTHWriter::GeneratePTH(const std::string &MainFile) {
+Offset PTHWriter::EmitPrologue(StringRef MainFile) {
   // Generate the prologue.
   Out << "cfe-pth" << '\0';
   Emit32(PTHManager::Version);
@@ -497,6 +537,30 @@ void PTHWriter::GeneratePTH(const std::string &MainFile) {
   }
   Emit8(0);
 
+  return PrologueOffset;
+}
+
+void PTHWriter::EmitTables(Offset PrologueOffset) {
+  // Write out the identifier table.
+  const std::pair<Offset,Offset> &IdTableOff = EmitIdentifierTable();
+
+  // Write out the cached strings table.
+  Offset SpellingOff = EmitCachedSpellings();
+
+  // Write out the file table.
+  Offset FileTableOff = EmitFileTable();
+
+  // Finally, write the prologue.
+  uint64_t Off = PrologueOffset;
+  pwrite32le(Out, IdTableOff.first, Off);
+  pwrite32le(Out, IdTableOff.second, Off);
+  pwrite32le(Out, FileTableOff, Off);
+  pwrite32le(Out, SpellingOff, Off);
+}
+
+void PTHWriter::GeneratePTH(const std::string &MainFile) {
+  Offset PrologueOffset = EmitPrologue(MainFile);
+
   // Iterate over all the files in SourceManager.  Create a lexer
   // for each file and cache the tokens.
   SourceManager &SM = PP.getSourceManager();
@@ -517,24 +581,33 @@ void PTHWriter::GeneratePTH(const std::string &MainFile) {
     FileID FID = SM.createFileID(FE, SourceLocation(), SrcMgr::C_User);
     const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
     Lexer L(FID, FromFile, SM, LOpts);
-    PM.insert(FE, LexTokens(L));
+    // Files whose tokens cannot be read back are lexed from their source.
+    PTHEntry Entry;
+    if (LexTokens(L, Entry))
+      PM.insert(FE, Entry);
   }
 
-  // Write out the identifier table.
-  const std::pair<Offset,Offset> &IdTableOff = EmitIdentifierTable();
-
-  // Write out the cached strings table.
-  Offset SpellingOff = EmitCachedSpellings();
-
-  // Write out the file table.
-  Offset FileTableOff = EmitFileTable();
+  EmitTables(PrologueOffset);
+}
 
-  // Finally, write the prologue.
-  uint64_t Off = PrologueOffset;
-  pwrite32le(Out, IdTableOff.first, Off);
-  pwrite32le(Out, IdTableOff.second, Off);
-  pwrite32le(Out, FileTableOff, Off);
-  pwrite32le(Out, SpellingOff, Off);
+bool PTHWriter::GenerateHeaderPTH(FileID FID) {
+  SourceManager &SM = PP.getSourceManager();
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+  if (!FE || Invalid)
+    return false;
+
+  Offset PrologueOffset = EmitPrologue(StringRef());
+
+  Lexer L(FID, Buffer, SM, PP.getLangOpts());
+  PTHEntry Entry;
+  if (!LexTokens(L, Entry))
+    return false;
+  PM.insert(FE, Entry);
+
+  EmitTables(PrologueOffset);
+  return true;
 }
 
 namespace {
@@ -691,3 +764,127 @@ std::pair<Offset,Offset> PTHWriter::EmitIdentifierTable() {
 
   return std::make_pair(IDOff, StringTableOffset);
 }
+
+//===----------------------------------------------------------------------===//
+// Header token cache.
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// PTHHeaderCache - A cache of the tokens of system headers that keeps one
+///  PTH file per header.
+///
+/// Each file is named after a hash of everything its tokens depend on: the
+/// contents and the name of the header, the language options that affect
+/// lexing and the version of the compiler.  A header that changes therefore
+/// gets a new file, and files are never modified once written.  They are
+/// written to a temporary file that is renamed into place, so compilations
+/// running in parallel can share a cache.
+class PTHHeaderCache : public HeaderTokenCache {
+  Preprocessor &PP;
+  std::string CachePath;
+
+  /// The PTH file loaded for each header entered so far, or null if the
+  /// header is lexed from its source.
+  llvm::DenseMap<const FileEntry *, PTHManager *> Loaded;
+  std::vector<std::unique_ptr<PTHManager>> Managers;
+
+  std::string getKey(const FileEntry *FE, StringRef Contents);
+  void writeTokens(FileID FID, StringRef Path);
+
+public:
+  PTHHeaderCache(Preprocessor &PP, StringRef CachePath)
+      : PP(PP), CachePath(CachePath) {}
+
+  PTHLexer *CreateLexer(FileID FID) override;
+};
+} // end anonymous namespace
+
+std::string PTHHeaderCache::getKey(const FileEntry *FE, StringRef Contents) {
+  const LangOptions &LOpts = PP.getLangOpts();
+  // The language options that the raw lexer looks at.
+  const bool LexerOpts[] = {
+    LOpts.C99, LOpts.C11, LOpts.CPlusPlus, LOpts.CPlusPlus11,
+    LOpts.CPlusPlus14, LOpts.CPlusPlus1z, LOpts.ObjC1, LOpts.CUDA,
+    LOpts.Digraphs, LOpts.Trigraphs, LOpts.LineComment, LOpts.MicrosoftExt,
+    LOpts.DollarIdents
+  };
+
+  llvm::MD5 Hash;
+  Hash.update(getClangFullRepositoryVersion());
+  for (bool Opt : LexerOpts)
+    Hash.update(Opt ? "1" : "0");
+  Hash.update(FE->getName());
+  Hash.update(StringRef("", 1));
+  Hash.update(Contents);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+void PTHHeaderCache::writeTokens(FileID FID, StringRef Path) {
+  if (llvm::sys::fs::create_directories(CachePath))
+    return;
+
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", TmpFD, TmpPath))
+    return;
+
+  bool Written;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Written = PTHWriter(Out, PP).GenerateHeaderPTH(FID);
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      Written = false;
+    }
+  }
+  if (!Written || llvm::sys::fs::rename(TmpPath, Path))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+PTHLexer *PTHHeaderCache::CreateLexer(FileID FID) {
+  SourceManager &SM = PP.getSourceManager();
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  if (!FE)
+    return nullptr;
+
+  llvm::DenseMap<const FileEntry *, PTHManager *>::iterator Known =
+      Loaded.find(FE);
+  if (Known != Loaded.end())
+    return Known->second ? Known->second->CreateLexer(FID) : nullptr;
+  PTHManager *&PTHMgr = Loaded[FE];
+
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+  if (Invalid)
+    return nullptr;
+
+  SmallString<128> Path(CachePath);
+  llvm::sys::path::append(Path, getKey(FE, Buffer->getBuffer()) + ".pth");
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+      llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!File) {
+    // Record the tokens for later compilations; this one lexes the header
+    // from its source.
+    writeTokens(FID, Path);
+    return nullptr;
+  }
+
+  PTHMgr = PTHManager::CreateForHeader(std::move(File.get()), PP);
+  if (!PTHMgr)
+    return nullptr;
+  Managers.emplace_back(PTHMgr);
+  return PTHMgr->CreateLexer(FID);
+}
+
+std::unique_ptr<HeaderTokenCache>
+clang::createPTHHeaderCache(Preprocessor &PP, StringRef CachePath) {
+  return llvm::make_unique<PTHHeaderCache>(PP, CachePath);
+}
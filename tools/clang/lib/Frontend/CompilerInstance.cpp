@@ -227,6 +227,24 @@ void CompilerInstance::createFileManager() {
     setVirtualFileSystem(vfs::getRealFileSystem());
   }
   FileMgr = new FileManager(getFileSystemOpts(), VirtualFileSystem);
+
+  // Share the 'stat' calls on system headers with other compilations.
+  const FileSystemOptions &FSOpts = getFileSystemOpts();
+  if (!FSOpts.StatCachePath.empty() &&
+      VirtualFileSystem == vfs::getRealFileSystem()) {
+    const HeaderSearchOptions &HSOpts = getHeaderSearchOpts();
+    std::vector<std::string> Roots;
+    if (HSOpts.Sysroot != "/")
+      Roots.push_back(HSOpts.Sysroot);
+    Roots.push_back(HSOpts.ResourceDir);
+    for (const HeaderSearchOptions::Entry &E : HSOpts.UserEntries)
+      if (E.Group != frontend::Quoted && E.Group != frontend::Angled &&
+          E.Group != frontend::IndexHeaderMap)
+        Roots.push_back(E.Path);
+    PersistentStats = new PersistentStatCache(FSOpts.StatCachePath, Roots);
+    FileMgr->addStatCache(
+        llvm::make_unique<PersistentStatCalls>(PersistentStats));
+  }
 }
 
 // Source Manager
@@ -314,6 +332,15 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
     PP->setPTHManager(PTHMgr);
   }
 
+  // Share the tokens of system headers with other compilations.  Cached
+  // tokens carry neither comments nor lexer diagnostics.
+  const LangOptions &LangOpts = getLangOpts();
+  if (!PPOpts.HeaderTokenCachePath.empty() && !PTHMgr &&
+      !LangOpts.RetainCommentsFromSystemHeaders && !LangOpts.AsmPreprocessor &&
+      !LangOpts.TraditionalCPP && !getDiagnosticOpts().VerifyDiagnostics)
+    PP->setHeaderTokenCache(
+        createPTHHeaderCache(*PP, PPOpts.HeaderTokenCachePath));
+
   if (PPOpts.DetailedRecord)
     PP->createPreprocessingRecord();
 
@@ -822,6 +849,9 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
     }
   }
 
+  if (PersistentStats)
+    PersistentStats->save();
+
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
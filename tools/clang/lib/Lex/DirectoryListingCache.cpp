@@ -0,0 +1,83 @@
+//===--- DirectoryListingCache.cpp - Cached directory contents ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the DirectoryListingCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DirectoryListingCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Path.h"
+using namespace clang;
+
+bool DirectoryListingCache::Listing::mayContain(StringRef Name) const {
+  switch (Kind) {
+  case LK_Missing:
+    return false;
+  case LK_Unknown:
+    return true;
+  case LK_Listed:
+    return Names.count(Name.lower());
+  }
+  llvm_unreachable("Invalid listing kind");
+}
+
+std::shared_ptr<const DirectoryListingCache::Listing>
+DirectoryListingCache::getListing(vfs::FileSystem &FS, StringRef Dir) {
+  auto NewListing = std::make_shared<Listing>();
+  NewListing->Stable = false;
+
+  llvm::ErrorOr<vfs::Status> Status = FS.status(Dir);
+  if (!Status) {
+    NewListing->Kind =
+        Status.getError() == std::errc::no_such_file_or_directory
+            ? Listing::LK_Missing
+            : Listing::LK_Unknown;
+    return NewListing;
+  }
+  if (!Status->isDirectory()) {
+    NewListing->Kind = Listing::LK_Missing;
+    return NewListing;
+  }
+
+  {
+    std::lock_guard<std::mutex> Guard(Mutex);
+    auto Known = Listings.find(Dir);
+    if (Known != Listings.end() && Known->second->Stable &&
+        Known->second->ModTime == Status->getLastModificationTime())
+      return Known->second;
+  }
+
+  // Read the directory without holding the lock; if two threads race to read
+  // the same directory, the last one wins, which is harmless.
+  NewListing->ModTime = Status->getLastModificationTime();
+  std::error_code EC;
+  for (vfs::directory_iterator I = FS.dir_begin(Dir, EC), E; !EC && I != E;
+       I.increment(EC))
+    NewListing->Names.insert(llvm::sys::path::filename(I->getName()).lower());
+  if (EC) {
+    NewListing->Kind = Listing::LK_Unknown;
+    NewListing->Names.clear();
+    return NewListing;
+  }
+  NewListing->Kind = Listing::LK_Listed;
+  NewListing->Stable = llvm::sys::TimeValue::now().seconds() -
+                           NewListing->ModTime.seconds() > 1;
+
+  std::lock_guard<std::mutex> Guard(Mutex);
+  Listings[Dir] = NewListing;
+  return NewListing;
+}
+
+IntrusiveRefCntPtr<DirectoryListingCache> DirectoryListingCache::getShared() {
+  static IntrusiveRefCntPtr<DirectoryListingCache> Shared =
+      new DirectoryListingCache();
+  return Shared;
+}
@@ -14,6 +14,7 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderMap.h"
@@ -59,6 +60,15 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
     : HSOpts(HSOpts), Diags(Diags), FileMgr(SourceMgr.getFileManager()),
       FrameworkMap(64), ModMap(SourceMgr, Diags, LangOpts, Target, *this),
       LangOpts(LangOpts) {
+  if (HSOpts->UseDirectoryListingCache) {
+    // Listings read through a virtual file system, such as one built from
+    // -ivfsoverlay files, are only valid for that file system.
+    if (FileMgr.getVirtualFileSystem() == vfs::getRealFileSystem())
+      DirListings = DirectoryListingCache::getShared();
+    else
+      DirListings = new DirectoryListingCache();
+  }
+
   AngledDirIdx = 0;
   SystemDirIdx = 0;
   NoCurDirSearch = false;
@@ -76,6 +86,29 @@ HeaderSearch::~HeaderSearch() {
     delete HeaderMaps[i].second;
 }
 
+bool HeaderSearch::mayExist(StringRef Path) {
+  if (!DirListings)
+    return true;
+
+  // The file manager answers paths it has seen, including virtual files,
+  // without touching the file system.
+  if (FileMgr.hasCachedLookup(Path))
+    return true;
+
+  SmallString<256> FullPath(Path);
+  FileMgr.FixupRelativePath(FullPath);
+  StringRef Name = llvm::sys::path::filename(FullPath);
+  StringRef Dir = llvm::sys::path::parent_path(FullPath);
+  if (Dir.empty() || Name == "." || Name == "..")
+    return true;
+
+  std::shared_ptr<const DirectoryListingCache::Listing> &Listing =
+      UsedDirListings[Dir];
+  if (!Listing)
+    Listing = DirListings->getListing(*FileMgr.getVirtualFileSystem(), Dir);
+  return Listing->mayContain(Name);
+}
+
 void HeaderSearch::PrintStats() {
   fprintf(stderr, "\n*** HeaderSearch Stats:\n");
   fprintf(stderr, "%d files tracked.\n", (int)FileInfo.size());
@@ -256,6 +289,8 @@ getFileAndSuggestModule(HeaderSearch &HS, StringRef FileName,
   // If we have a module map that might map this header, load it and
   // check whether we'll have a suggestion for a module.
   HS.hasModuleMap(FileName, Dir, IsSystemHeaderDir);
+  if (!HS.mayExist(FileName))
+    return nullptr;
   if (SuggestedModule) {
     const FileEntry *File = HS.getFileMgr().getFile(FileName,
                                                     /*OpenFile=*/false);
@@ -331,10 +366,20 @@ const FileEntry *DirectoryLookup::LookupFile(
     MappedName.append(Dest.begin(), Dest.end());
     Filename = StringRef(MappedName.begin(), MappedName.size());
     HasBeenMapped = true;
-    Result = HM->LookupFile(Filename, HS.getFileMgr());
 
-  } else {
+    // The mapped name may itself be mapped by the headermap; probe the
+    // result through the directory listing cache like any other path.
+    SmallString<1024> MappedPath;
+    StringRef MappedDest = HM->lookupFilename(Filename, MappedPath);
+    if (!MappedDest.empty() && HS.mayExist(MappedDest))
+      Result = HS.getFileMgr().getFile(MappedDest);
+    else
+      Result = nullptr;
+
+  } else if (HS.mayExist(Dest)) {
     Result = HS.getFileMgr().getFile(Dest);
+  } else {
+    Result = nullptr;
   }
 
   if (Result) {
@@ -446,6 +491,8 @@ const FileEntry *DirectoryLookup::DoFrameworkLookup(
     HS.IncrementFrameworkLookupCount();
 
     // If the framework dir doesn't exist, we fail.
+    if (!HS.mayExist(StringRef(FrameworkName).drop_back()))
+      return nullptr;
     const DirectoryEntry *Dir = FileMgr.getDirectory(FrameworkName);
     if (!Dir) return nullptr;
 
@@ -484,8 +531,9 @@ const FileEntry *DirectoryLookup::DoFrameworkLookup(
   }
 
   FrameworkName.append(Filename.begin()+SlashPos+1, Filename.end());
-  const FileEntry *FE = FileMgr.getFile(FrameworkName,
-                                        /*openFile=*/!SuggestedModule);
+  const FileEntry *FE = nullptr;
+  if (HS.mayExist(FrameworkName))
+    FE = FileMgr.getFile(FrameworkName, /*openFile=*/!SuggestedModule);
   if (!FE) {
     // Check "/System/Library/Frameworks/Cocoa.framework/PrivateHeaders/file.h"
     const char *Private = "Private";
@@ -495,7 +543,8 @@ const FileEntry *DirectoryLookup::DoFrameworkLookup(
       SearchPath->insert(SearchPath->begin()+OrigSize, Private,
                          Private+strlen(Private));
 
-    FE = FileMgr.getFile(FrameworkName, /*openFile=*/!SuggestedModule);
+    if (HS.mayExist(FrameworkName))
+      FE = FileMgr.getFile(FrameworkName, /*openFile=*/!SuggestedModule);
   }
 
   // If we found the header and are allowed to suggest a module, do so now.
@@ -2411,6 +2411,248 @@ bool Lexer::SkipBlockComment(Token &Result, const char *CurPtr,
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Excluded Conditional Blocks
+//===----------------------------------------------------------------------===//
+
+/// Returns true if \p C may change the state of the scan of an excluded line
+/// in the middle of the line.
+static inline bool isExcludedLineSpecialChar(unsigned char C) {
+  switch (C) {
+  case '\n': case '\r': case '/': case '"': case '\'': case '\\': case '?':
+  case 0:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Returns the first character at or after \p CurPtr for which
+/// isExcludedLineSpecialChar is true.
+static const char *skipExcludedLineChars(const char *CurPtr,
+                                         const char *BufferEnd) {
+#ifdef __SSE2__
+  const __m128i Newlines = _mm_set1_epi8('\n');
+  const __m128i Returns = _mm_set1_epi8('\r');
+  const __m128i Slashes = _mm_set1_epi8('/');
+  const __m128i Quotes = _mm_set1_epi8('"');
+  const __m128i Apostrophes = _mm_set1_epi8('\'');
+  const __m128i Backslashes = _mm_set1_epi8('\\');
+  const __m128i Questions = _mm_set1_epi8('?');
+  const __m128i Nulls = _mm_setzero_si128();
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chunk = _mm_loadu_si128((const __m128i *)CurPtr);
+    __m128i Special = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Chunk, Newlines),
+                                  _mm_cmpeq_epi8(Chunk, Returns)),
+                     _mm_or_si128(_mm_cmpeq_epi8(Chunk, Slashes),
+                                  _mm_cmpeq_epi8(Chunk, Quotes))),
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Chunk, Apostrophes),
+                                  _mm_cmpeq_epi8(Chunk, Backslashes)),
+                     _mm_or_si128(_mm_cmpeq_epi8(Chunk, Questions),
+                                  _mm_cmpeq_epi8(Chunk, Nulls))));
+    int Mask = _mm_movemask_epi8(Special);
+    if (Mask != 0)
+      return CurPtr + llvm::countTrailingZeros<unsigned>(Mask);
+    CurPtr += 16;
+  }
+#endif
+
+  // The buffer is null terminated, so this stops at the end of the buffer.
+  while (!isExcludedLineSpecialChar(*CurPtr))
+    ++CurPtr;
+  return CurPtr;
+}
+
+/// If \p CurPtr points to a backslash (or a '??/' trigraph when \p Trigraphs
+/// is set) followed by a newline, returns the start of the next line.
+/// Otherwise returns null.
+static const char *skipEscapedNewLine(const char *CurPtr, bool Trigraphs) {
+  if (*CurPtr == '\\')
+    ++CurPtr;
+  else if (Trigraphs && CurPtr[0] == '?' && CurPtr[1] == '?' &&
+           CurPtr[2] == '/')
+    CurPtr += 3;
+  else
+    return nullptr;
+
+  while (isHorizontalWhitespace(*CurPtr))
+    ++CurPtr;
+  if (*CurPtr != '\n' && *CurPtr != '\r')
+    return nullptr;
+  if ((CurPtr[1] == '\n' || CurPtr[1] == '\r') && CurPtr[0] != CurPtr[1])
+    return CurPtr + 2;
+  return CurPtr + 1;
+}
+
+void Lexer::SkipExcludedLines() {
+  assert(isLexingRawMode() && "Excluded lines are skipped in raw mode");
+
+  // The code-completion point is marked by a null character that the lexer
+  // has to see.
+  if (PP && PP->getCodeCompletionFileLoc() == FileLoc)
+    return;
+
+  const bool Trigraphs = LangOpts.Trigraphs;
+  const char *CurPtr = BufferPtr;
+  bool AtStartOfLine = IsAtStartOfLine;
+  // The first non-whitespace character of the current line, if it was seen.
+  const char *FirstOnLine = nullptr;
+  bool SawToken = false;
+
+  while (true) {
+    unsigned char C = *CurPtr;
+    switch (C) {
+    case '\n':
+    case '\r':
+      ++CurPtr;
+      AtStartOfLine = true;
+      FirstOnLine = nullptr;
+      continue;
+
+    case ' ':
+    case '\t':
+    case '\f':
+    case '\v':
+      ++CurPtr;
+      continue;
+
+    case 0:
+      // Let the lexer handle the end of the buffer and embedded nulls.
+      goto Done;
+
+    case '#':
+      if (AtStartOfLine)
+        goto Done;
+      break;
+
+    case '%':
+      if (AtStartOfLine && LangOpts.Digraphs && CurPtr[1] == ':')
+        goto Done;
+      break;
+
+    case '?':
+      // Trigraphs can spell '#', '\\' and other characters that matter here;
+      // leave them to the lexer.
+      if (Trigraphs && CurPtr[1] == '?')
+        goto Done;
+      break;
+
+    case '\\':
+      if (const char *NextLine = skipEscapedNewLine(CurPtr, Trigraphs)) {
+        CurPtr = NextLine;
+        continue;
+      }
+      break;
+
+    case '/':
+      if (CurPtr[1] == '*') {
+        // Find the closing '*/'.  The lexer takes care of unterminated
+        // comments and of comments closed by '*', an escaped newline and '/'.
+        const char *Slash = CurPtr + 2;
+        if (*Slash == '/')
+          ++Slash;
+        while (true) {
+          Slash = (const char *)memchr(Slash, '/', BufferEnd - Slash);
+          if (!Slash || Slash[-1] == '*' || Slash[-1] == '\n' ||
+              Slash[-1] == '\r')
+            break;
+          ++Slash;
+        }
+        if (!Slash || Slash[-1] != '*')
+          goto Done;
+        CurPtr = Slash + 1;
+        continue;
+      }
+      if (CurPtr[1] == '/' && LangOpts.LineComment) {
+        // Skip to the end of the line, following escaped newlines.
+        CurPtr += 2;
+        while (true) {
+          CurPtr = skipExcludedLineChars(CurPtr, BufferEnd);
+          if (*CurPtr == '\n' || *CurPtr == '\r' ||
+              (*CurPtr == 0 && CurPtr == BufferEnd))
+            break;
+          if (const char *NextLine = skipEscapedNewLine(CurPtr, Trigraphs))
+            CurPtr = NextLine;
+          else
+            ++CurPtr;
+        }
+        if (*CurPtr == 0)
+          goto Done;
+        continue;
+      }
+      break;
+
+    case '"':
+      // Raw string literals may span lines; leave them to the lexer, starting
+      // at their prefix.
+      if (LangOpts.CPlusPlus11 && CurPtr != BufferPtr && CurPtr[-1] == 'R') {
+        const char *Start = CurPtr - 1;
+        while (Start != BufferPtr && isIdentifierBody(Start[-1]))
+          --Start;
+        CurPtr = Start;
+        AtStartOfLine = Start == FirstOnLine;
+        goto Done;
+      }
+      // Fall through.
+    case '\'': {
+      // Skip the literal.  An unterminated literal ends at the end of the
+      // line.
+      const char *LiteralStart = CurPtr;
+      bool LiteralAtStartOfLine = AtStartOfLine;
+      if (AtStartOfLine)
+        FirstOnLine = CurPtr;
+      AtStartOfLine = false;
+      SawToken = true;
+      ++CurPtr;
+      while (true) {
+        CurPtr = skipExcludedLineChars(CurPtr, BufferEnd);
+        if (*CurPtr == C) {
+          ++CurPtr;
+          break;
+        }
+        if (*CurPtr == '\n' || *CurPtr == '\r' ||
+            (*CurPtr == 0 && CurPtr == BufferEnd))
+          break;
+        if (const char *NextLine = skipEscapedNewLine(CurPtr, Trigraphs)) {
+          CurPtr = NextLine;
+          continue;
+        }
+        // Skip the escaped character, if any.
+        if (*CurPtr == '\\' && CurPtr[1] != '\n' && CurPtr[1] != '\r' &&
+            !(CurPtr[1] == 0 && CurPtr + 1 == BufferEnd))
+          ++CurPtr;
+        else if (Trigraphs && CurPtr[0] == '?' && CurPtr[1] == '?' &&
+                 CurPtr[2] == '/') {
+          // An escape spelled with a trigraph; lex the whole literal.
+          CurPtr = LiteralStart;
+          AtStartOfLine = LiteralAtStartOfLine;
+          goto Done;
+        }
+        ++CurPtr;
+      }
+      continue;
+    }
+    }
+
+    // Anything else is part of a token.  Skip to the next character that may
+    // matter.
+    if (AtStartOfLine)
+      FirstOnLine = CurPtr;
+    AtStartOfLine = false;
+    SawToken = true;
+    CurPtr = skipExcludedLineChars(CurPtr + 1, BufferEnd);
+  }
+
+Done:
+  // The skipped tokens still count as tokens of the file.
+  if (SawToken)
+    MIOpt.ReadToken();
+  BufferPtr = CurPtr;
+  IsAtStartOfLine = AtStartOfLine;
+  IsAtPhysicalStartOfLine = false;
+}
+
 //===----------------------------------------------------------------------===//
 // Primary Lexing Entry Points
 //===----------------------------------------------------------------------===//
@@ -82,6 +82,19 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
       return false;
     }
   }
+
+  // Read the tokens of system headers from the header token cache, unless
+  // the comments in them are needed, which the cache does not keep.
+  if (HeaderTokens && !KeepComments &&
+      SourceMgr.isInSystemHeader(SourceMgr.getLocForStartOfFile(FID)) &&
+      !(isCodeCompletionEnabled() &&
+        SourceMgr.getFileEntryForID(FID) == CodeCompletionFile)) {
+    if (PTHLexer *PL = HeaderTokens->CreateLexer(FID)) {
+      ++NumCachedSourceFiles;
+      EnterSourceFileWithPTH(PL, CurDir);
+      return false;
+    }
+  }
   
   // Get the MemoryBuffer for this FID, if it fails, we fail.
   bool Invalid = false;
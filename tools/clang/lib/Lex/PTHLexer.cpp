@@ -422,13 +422,16 @@ PTHManager::PTHManager(
     : Buf(std::move(buf)), PerIDCache(std::move(perIDCache)),
       FileLookup(std::move(fileLookup)), IdDataTable(idDataTable),
       StringIdLookup(std::move(stringIdLookup)), NumIds(numIds), PP(nullptr),
-      SpellingBase(spellingBase), OriginalSourceFile(originalSourceFile) {}
+      SpellingBase(spellingBase), OriginalSourceFile(originalSourceFile),
+      UsesPPIdentifiers(false) {}
 
 PTHManager::~PTHManager() {
 }
 
-static void InvalidPTH(DiagnosticsEngine &Diags, const char *Msg) {
-  Diags.Report(Diags.getCustomDiagID(DiagnosticsEngine::Error, "%0")) << Msg;
+static void InvalidPTH(DiagnosticsEngine *Diags, const char *Msg) {
+  if (Diags)
+    Diags->Report(Diags->getCustomDiagID(DiagnosticsEngine::Error, "%0"))
+        << Msg;
 }
 
 PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
@@ -441,8 +444,24 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
     Diags.Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
-  std::unique_ptr<llvm::MemoryBuffer> File = std::move(FileOrErr.get());
 
+  return Load(std::move(FileOrErr.get()), file, &Diags);
+}
+
+PTHManager *
+PTHManager::CreateForHeader(std::unique_ptr<llvm::MemoryBuffer> File,
+                            Preprocessor &PP) {
+  PTHManager *PTHMgr =
+      Load(std::move(File), StringRef(), /*Diags=*/nullptr);
+  if (!PTHMgr)
+    return nullptr;
+  PTHMgr->setPreprocessor(&PP);
+  PTHMgr->UsesPPIdentifiers = true;
+  return PTHMgr;
+}
+
+PTHManager *PTHManager::Load(std::unique_ptr<llvm::MemoryBuffer> File,
+                             StringRef file, DiagnosticsEngine *Diags) {
   using namespace llvm::support;
 
   // Get the buffer ranges and check if there are at least three 32-bit
@@ -453,7 +472,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   // Check the prologue of the file.
   if ((BufEnd - BufBeg) < (signed)(sizeof("cfe-pth") + 4 + 4) ||
       memcmp(BufBeg, "cfe-pth", sizeof("cfe-pth")) != 0) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    if (Diags)
+      Diags->Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
 
@@ -473,7 +493,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *PrologueOffset = p;
 
   if (PrologueOffset >= BufEnd) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    if (Diags)
+      Diags->Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
 
@@ -484,7 +505,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
       BufBeg + endian::readNext<uint32_t, little, aligned>(FileTableOffset);
 
   if (!(FileTable > BufBeg && FileTable < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    if (Diags)
+      Diags->Report(diag::err_invalid_pth_file) << file;
     return nullptr; // FIXME: Proper error diagnostic?
   }
 
@@ -502,7 +524,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
       BufBeg + endian::readNext<uint32_t, little, aligned>(IDTableOffset);
 
   if (!(IData >= BufBeg && IData < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    if (Diags)
+      Diags->Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
 
@@ -512,7 +535,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *StringIdTable =
       BufBeg + endian::readNext<uint32_t, little, aligned>(StringIdTableOffset);
   if (!(StringIdTable >= BufBeg && StringIdTable < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    if (Diags)
+      Diags->Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
 
@@ -524,7 +548,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *spellingBase =
       BufBeg + endian::readNext<uint32_t, little, aligned>(spellingBaseOffset);
   if (!(spellingBase >= BufBeg && spellingBase < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    if (Diags)
+      Diags->Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
 
@@ -565,6 +590,13 @@ IdentifierInfo* PTHManager::LazilyCreateIdentifierInfo(unsigned PersistentID) {
       endian::readNext<uint32_t, little, aligned>(TableEntry);
   assert(IDData < (const unsigned char*)Buf->getBufferEnd());
 
+  // The tokens of a header token cache use the preprocessor's identifiers.
+  if (UsesPPIdentifiers) {
+    IdentifierInfo *II = PP->getIdentifierInfo((const char *)IDData);
+    PerIDCache[PersistentID] = II;
+    return II;
+  }
+
   // Allocate the object.
   std::pair<IdentifierInfo,const unsigned char*> *Mem =
     Alloc.Allocate<std::pair<IdentifierInfo,const unsigned char*> >();
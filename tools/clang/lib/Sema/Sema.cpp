@@ -99,7 +99,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     MSAsmLabelNameCounter(0),
     GlobalNewDeleteDeclared(false),
     TUKind(TUKind),
-    NumSFINAEErrors(0),
+    NumSFINAEErrors(0), NumOverloadCandidates(0),
+    NumViableOverloadCandidates(0), NumPrefilteredOverloadCandidates(0),
     CachedFakeTopLevelModule(nullptr),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
@@ -329,6 +330,10 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumOverloadCandidates << " overload candidates examined, "
+               << NumViableOverloadCandidates << " viable, "
+               << NumPrefilteredOverloadCandidates
+               << " rejected without computing conversions.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -167,6 +167,13 @@ namespace {
     void AdjustResultPriorityForDecl(Result &R);
 
     void MaybeAddConstructorResults(Result R);
+
+    /// \brief Whether the code-completion consumer wants the given result
+    /// dropped before any work is done for it.
+    bool isFilteredOut(const Result &R) const {
+      return SemaRef.CodeCompleter &&
+             SemaRef.CodeCompleter->isResultFilteredOut(R);
+    }
     
   public:
     explicit ResultBuilder(Sema &SemaRef, CodeCompletionAllocator &Allocator,
@@ -814,7 +821,8 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
   
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
-    Results.push_back(R);
+    if (!isFilteredOut(R))
+      Results.push_back(R);
     return;
   }
 
@@ -827,6 +835,11 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
                    CurContext);
     return;
   }
+
+  // Declarations with the same name are filtered alike, so a filtered
+  // declaration can only hide declarations that are filtered too.
+  if (isFilteredOut(R))
+    return;
   
   const Decl *CanonDecl = R.Declaration->getCanonicalDecl();
   unsigned IDNS = CanonDecl->getIdentifierNamespace();
@@ -931,7 +944,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
                               NamedDecl *Hiding, bool InBaseClass = false) {
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
-    Results.push_back(R);
+    if (!isFilteredOut(R))
+      Results.push_back(R);
     return;
   }
 
@@ -943,6 +957,9 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
               CurContext, Hiding);
     return;
   }
+
+  if (isFilteredOut(R))
+    return;
   
   bool AsNestedNameSpecifier = false;
   if (!isInterestingDecl(R.Declaration, AsNestedNameSpecifier))
@@ -1014,7 +1031,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
 void ResultBuilder::AddResult(Result R) {
   assert(R.Kind != Result::RK_Declaration && 
           "Declaration results need more context");
-  Results.push_back(R);
+  if (!isFilteredOut(R))
+    Results.push_back(R);
 }
 
 /// \brief Enter into a new scope.
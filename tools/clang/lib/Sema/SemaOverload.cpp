@@ -5557,6 +5557,75 @@ static bool IsAcceptableNonMemberOperatorCandidate(ASTContext &Context,
   return false;
 }
 
+/// \brief Determine, from the kinds of the types alone, that no implicit
+/// conversion sequence converts \p Arg to a parameter of type \p ParamType.
+///
+/// This lets overload resolution reject members of large overload sets, such
+/// as the many overloads of 'operator<<', without computing conversion
+/// sequences.  Only cheap and common cases are recognized; in case of doubt
+/// the answer is false.
+static bool IsCertainlyNotConvertible(Sema &S, Expr *Arg,
+                                      QualType ParamType) {
+  const LangOptions &LangOpts = S.getLangOpts();
+  if (!LangOpts.CPlusPlus || LangOpts.ObjC1 || isa<InitListExpr>(Arg))
+    return false;
+
+  QualType FromType = Arg->getType();
+  QualType ToType = ParamType.getNonReferenceType();
+  if (FromType->isDependentType() || FromType->isPlaceholderType() ||
+      ToType->isDependentType())
+    return false;
+
+  // A class with no conversion functions converts to no non-class type.
+  if (const RecordType *FromRecord = FromType->getAs<RecordType>()) {
+    if (ToType->isRecordType())
+      return false;
+    // An incomplete class, such as a template specialization that has not
+    // been instantiated yet, may still turn out to have conversions.
+    const CXXRecordDecl *RD =
+        dyn_cast_or_null<CXXRecordDecl>(FromRecord->getDecl()->getDefinition());
+    if (!RD || RD->isBeingDefined())
+      return false;
+    auto Conversions =
+        const_cast<CXXRecordDecl *>(RD)->getVisibleConversionFunctions();
+    return Conversions.begin() == Conversions.end();
+  }
+
+  // A pointer converts to no arithmetic or enumeration type other than bool.
+  if (FromType->isPointerType())
+    return (ToType->isArithmeticType() || ToType->isEnumeralType()) &&
+           !ToType->isBooleanType();
+
+  // Only a null pointer constant converts from an arithmetic or enumeration
+  // type to a pointer.
+  if (ToType->isPointerType() &&
+      (FromType->isArithmeticType() || FromType->isEnumeralType()))
+    return Arg->isNullPointerConstant(S.Context,
+                                      Expr::NPC_ValueDependentIsNull) ==
+           Expr::NPCK_NotNull;
+
+  return false;
+}
+
+/// \brief Reject \p Candidate if IsCertainlyNotConvertible shows that its
+/// argument \p Arg does not convert to its parameter of type \p ParamType.
+///
+/// The conversion sequence \p ConvIdx is then only recorded as bad; it is
+/// computed if the candidate is diagnosed.
+static bool PrefilterCandidate(Sema &S, OverloadCandidate &Candidate,
+                               unsigned ConvIdx, Expr *Arg,
+                               QualType ParamType) {
+  if (!IsCertainlyNotConvertible(S, Arg, ParamType))
+    return false;
+  Candidate.Conversions[ConvIdx].setBad(BadConversionSequence::no_conversion,
+                                        Arg, ParamType);
+  Candidate.Viable = false;
+  Candidate.FailureKind = ovl_fail_bad_conversion;
+  Candidate.PrefilteredConversion = true;
+  ++S.NumPrefilteredOverloadCandidates;
+  return true;
+}
+
 /// AddOverloadCandidate - Adds the given function to the set of
 /// candidate functions, using the given function call arguments.  If
 /// @p SuppressUserConversions, then don't allow user-defined
@@ -5694,6 +5763,9 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       // (13.3.3.1) that converts that argument to the corresponding
       // parameter of F.
       QualType ParamType = Proto->getParamType(ArgIdx);
+      if (PrefilterCandidate(*this, Candidate, ArgIdx, Args[ArgIdx],
+                             ParamType))
+        return;
       Candidate.Conversions[ArgIdx]
         = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
                                 SuppressUserConversions,
@@ -6055,6 +6127,9 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       // (13.3.3.1) that converts that argument to the corresponding
       // parameter of F.
       QualType ParamType = Proto->getParamType(ArgIdx);
+      if (PrefilterCandidate(*this, Candidate, ArgIdx + 1, Args[ArgIdx],
+                             ParamType))
+        return;
       Candidate.Conversions[ArgIdx + 1]
         = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
                                 SuppressUserConversions,
@@ -8500,11 +8575,14 @@ OverloadCandidateSet::BestViableFunction(Sema &S, SourceLocation Loc,
   // Find the best viable function.
   Best = end();
   for (iterator Cand = begin(); Cand != end(); ++Cand) {
-    if (Cand->Viable)
+    if (Cand->Viable) {
+      ++S.NumViableOverloadCandidates;
       if (Best == end() || isBetterOverloadCandidate(S, *Cand, *Best, Loc,
                                                      UserDefinedConversion))
         Best = Cand;
+    }
   }
+  S.NumOverloadCandidates += size();
 
   // If we didn't find any viable functions, abort.
   if (Best == end())
@@ -9555,13 +9633,26 @@ static void CompleteNonViableCandidate(Sema &S, OverloadCandidate *Cand,
   // Use a implicit copy initialization to check conversion fixes.
   Cand->Fix.setConversionChecker(TryCopyInitialization);
 
+  // FIXME: this should probably be preserved from the overload
+  // operation somehow.
+  bool SuppressUserConversions = false;
+
   // Skip forward to the first bad conversion.
   unsigned ConvIdx = (Cand->IgnoreObjectArgument ? 1 : 0);
   unsigned ConvCount = Cand->NumConversions;
   while (true) {
     assert(ConvIdx != ConvCount && "no bad conversion in candidate");
     ConvIdx++;
-    if (Cand->Conversions[ConvIdx - 1].isBad()) {
+    ImplicitConversionSequence &Conv = Cand->Conversions[ConvIdx - 1];
+    if (Conv.isBad()) {
+      // A conversion rejected by PrefilterCandidate has not been computed.
+      if (Cand->PrefilteredConversion)
+        Conv = TryCopyInitialization(S, Conv.Bad.FromExpr, Conv.Bad.getToType(),
+                                     SuppressUserConversions,
+                                     /*InOverloadResolution=*/true,
+                                     /*AllowObjCWritebackConversion=*/
+                                       S.getLangOpts().ObjCAutoRefCount);
+      assert(Conv.isBad() && "prefiltered conversion is not bad");
       Unfixable = !Cand->TryToFixBadConversion(ConvIdx - 1, S);
       break;
     }
@@ -9573,10 +9664,6 @@ static void CompleteNonViableCandidate(Sema &S, OverloadCandidate *Cand,
   assert(!Cand->Conversions[ConvIdx].isInitialized() &&
          "remaining conversion is initialized?");
 
-  // FIXME: this should probably be preserved from the overload
-  // operation somehow.
-  bool SuppressUserConversions = false;
-
   const FunctionProtoType* Proto;
   unsigned ArgIdx = ConvIdx;
 
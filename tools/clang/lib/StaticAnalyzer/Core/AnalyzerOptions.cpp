@@ -314,6 +314,29 @@ unsigned AnalyzerOptions::getMaxNodesPerTopLevelFunction() {
   return MaxNodesPerTopLevelFunction.getValue();
 }
 
+unsigned AnalyzerOptions::getMaxMemoryPerTopLevelFunction() {
+  if (!MaxMemoryPerTopLevelFunction.hasValue())
+    MaxMemoryPerTopLevelFunction = getOptionAsInteger("max-memory", 0);
+  return MaxMemoryPerTopLevelFunction.getValue();
+}
+
+unsigned AnalyzerOptions::getAnalysisPartitionCount() {
+  if (!AnalysisPartitionCount.hasValue()) {
+    int Count = getOptionAsInteger("analysis-partitions", 1);
+    AnalysisPartitionCount = Count < 1 ? 1 : Count;
+  }
+  return AnalysisPartitionCount.getValue();
+}
+
+unsigned AnalyzerOptions::getAnalysisPartitionIndex() {
+  if (!AnalysisPartitionIndex.hasValue()) {
+    unsigned Count = getAnalysisPartitionCount();
+    int Index = Count > 1 ? getOptionAsInteger("analysis-partition", 0) : 0;
+    AnalysisPartitionIndex = Index < 0 ? Count : Index;
+  }
+  return AnalysisPartitionIndex.getValue();
+}
+
 bool AnalyzerOptions::shouldSynthesizeBodies() {
   return getBooleanOption("faux-bodies", true);
 }
@@ -21,6 +21,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
+#include <algorithm>
 
 using namespace clang;
 using namespace ento;
@@ -33,6 +34,15 @@ STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
+STATISTIC(NumReachedMaxMemory,
+            "The # of times we reached the memory budget of the graph.");
+STATISTIC(MaxGraphNodes,
+            "The maximum number of nodes in an exploded graph.");
+STATISTIC(MaxGraphMemoryKB,
+            "The maximum memory used by an exploded graph (in KB).");
+
+/// The number of steps between checks of the memory budget.
+static const unsigned MemoryCheckInterval = 1024;
 
 //===----------------------------------------------------------------------===//
 // Worklist classes for exploration of reachable states.
@@ -200,6 +210,7 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
 
   // Check if we have a steps limit
   bool UnlimitedSteps = Steps == 0;
+  unsigned StepsSinceMemoryCheck = 0;
 
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
@@ -210,6 +221,14 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
       --Steps;
     }
 
+    if (MemoryBudget && ++StepsSinceMemoryCheck == MemoryCheckInterval) {
+      StepsSinceMemoryCheck = 0;
+      if (!checkMemoryBudget()) {
+        NumReachedMaxMemory++;
+        break;
+      }
+    }
+
     NumSteps++;
 
     const WorkListUnit& WU = WList->dequeue();
@@ -222,10 +241,32 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
 
     dispatchWorkItem(Node, Node->getLocation(), WU);
   }
+
+  unsigned GraphMemoryKB = G.getTotalMemory() / 1024;
+  MaxGraphNodes = std::max<unsigned>(MaxGraphNodes, G.getPeakSize());
+  MaxGraphMemoryKB = std::max<unsigned>(MaxGraphMemoryKB, GraphMemoryKB);
+
   SubEng.processEndWorklist(hasWorkRemaining());
   return WList->hasWork();
 }
 
+bool CoreEngine::checkMemoryBudget() {
+  size_t Used = G.getTotalMemory();
+  if (Used >= MemoryBudget)
+    return false;
+
+  // Once the graph uses three quarters of its budget, reclaim every node that
+  // is not needed, so that new nodes reuse their memory.  Sweeping the whole
+  // graph is expensive, so only do it again after the graph has grown by
+  // another sixteenth of the budget.
+  if (Used >= MemoryBudget / 4 * 3 &&
+      Used >= LastReclaimMemory + MemoryBudget / 16) {
+    G.reclaimAllNodes();
+    LastReclaimMemory = Used;
+  }
+  return true;
+}
+
 void CoreEngine::dispatchWorkItem(ExplodedNode* Pred, ProgramPoint Loc,
                                   const WorkListUnit& WU) {
   // Dispatch on the location type.
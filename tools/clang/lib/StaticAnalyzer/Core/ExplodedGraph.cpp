@@ -48,7 +48,7 @@ void ExplodedNode::SetAuditor(ExplodedNode::Auditor* A) {
 //===----------------------------------------------------------------------===//
 
 ExplodedGraph::ExplodedGraph()
-  : NumNodes(0), ReclaimNodeInterval(0) {}
+  : NumNodes(0), PeakNumNodes(0), ReclaimNodeInterval(0) {}
 
 ExplodedGraph::~ExplodedGraph() {}
 
@@ -198,6 +198,28 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
   ChangedNodes.clear();
 }
 
+void ExplodedGraph::reclaimAllNodes() {
+  if (!ReclaimNodeInterval)
+    return;
+
+  // Recently allocated nodes are left to reclaimRecentlyAllocatedNodes(),
+  // which still refers to them.  Gather the candidates first, since collecting
+  // a node removes it from the node set.
+  llvm::DenseSet<const ExplodedNode *> Recent(ChangedNodes.begin(),
+                                              ChangedNodes.end());
+  NodeVector Candidates;
+  for (node_iterator I = Nodes.begin(), E = Nodes.end(); I != E; ++I)
+    if (!Recent.count(&*I))
+      Candidates.push_back(&*I);
+
+  for (NodeVector::iterator it = Candidates.begin(), et = Candidates.end();
+       it != et; ++it) {
+    ExplodedNode *node = *it;
+    if (shouldCollect(node))
+      collectNode(node);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // ExplodedNode.
 //===----------------------------------------------------------------------===//
@@ -327,6 +349,8 @@ ExplodedNode *ExplodedGraph::getNode(const ProgramPoint &L,
     // Insert the node into the node set and return it.
     Nodes.InsertNode(V, InsertPos);
     ++NumNodes;
+    if (NumNodes > PeakNumNodes)
+      PeakNumNodes = NumNodes;
 
     if (IsNew) *IsNew = true;
   }
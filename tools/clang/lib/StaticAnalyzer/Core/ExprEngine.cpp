@@ -90,6 +90,10 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
     // Enable eager node reclaimation when constructing the ExplodedGraph.
     G.enableNodeReclamation(TrimInterval);
   }
+
+  // The budget is given in megabytes.
+  Engine.setMemoryBudget(
+      size_t(mgr.options.getMaxMemoryPerTopLevelFunction()) * 1024 * 1024);
 }
 
 ExprEngine::~ExprEngine() {
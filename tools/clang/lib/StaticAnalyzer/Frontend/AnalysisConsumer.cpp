@@ -37,6 +37,7 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
@@ -433,6 +434,69 @@ static bool shouldSkipFunction(const Decl *D,
   return Visited.count(D);
 }
 
+/// \brief Divides the functions in \p Order into \p NumPartitions partitions
+/// of about the same size and adds the functions of partition \p Index to
+/// \p Partition.
+///
+/// A function is only inlined into the functions that call it, directly or
+/// indirectly, so the functions of different connected components of the call
+/// graph are analyzed independently of each other.  Each component is placed
+/// in a single partition, so that the partitions together produce the same
+/// reports as a single analysis of the translation unit.  The division only
+/// depends on the call graph, so every invocation computes the same one.
+static void getAnalysisPartition(ArrayRef<CallGraphNode *> Order,
+                                 unsigned NumPartitions, unsigned Index,
+                                 SetOfConstDecls &Partition) {
+  llvm::EquivalenceClasses<const Decl *> Components;
+  for (const CallGraphNode *N : Order) {
+    const Decl *D = N->getDecl();
+    if (!D)
+      continue;
+    Components.insert(D);
+    for (const CallGraphNode *Callee : *N)
+      if (const Decl *CalleeD = Callee->getDecl())
+        Components.unionSets(D, CalleeD);
+  }
+
+  // Number the components in the order in which they are first reached.
+  llvm::DenseMap<const Decl *, unsigned> ComponentIDs;
+  SmallVector<unsigned, 32> ComponentSizes;
+  for (const CallGraphNode *N : Order) {
+    if (!N->getDecl())
+      continue;
+    const Decl *Leader = Components.getLeaderValue(N->getDecl());
+    auto Inserted =
+        ComponentIDs.insert(std::make_pair(Leader, ComponentSizes.size()));
+    if (Inserted.second)
+      ComponentSizes.push_back(0);
+    ++ComponentSizes[Inserted.first->second];
+  }
+
+  // Assign the largest components first, each to the smallest partition.
+  SmallVector<unsigned, 32> BySize;
+  for (unsigned I = 0, E = ComponentSizes.size(); I != E; ++I)
+    BySize.push_back(I);
+  std::stable_sort(BySize.begin(), BySize.end(),
+                   [&](unsigned LHS, unsigned RHS) {
+                     return ComponentSizes[LHS] > ComponentSizes[RHS];
+                   });
+  SmallVector<unsigned, 8> PartitionSizes(NumPartitions, 0);
+  SmallVector<unsigned, 32> ComponentPartitions(ComponentSizes.size());
+  for (unsigned Component : BySize) {
+    unsigned Smallest = std::min_element(PartitionSizes.begin(),
+                                         PartitionSizes.end()) -
+                        PartitionSizes.begin();
+    ComponentPartitions[Component] = Smallest;
+    PartitionSizes[Smallest] += ComponentSizes[Component];
+  }
+
+  for (const CallGraphNode *N : Order)
+    if (const Decl *D = N->getDecl())
+      if (ComponentPartitions[ComponentIDs[Components.getLeaderValue(D)]] ==
+          Index)
+        Partition.insert(D);
+}
+
 ExprEngine::InliningModes
 AnalysisConsumer::getInliningModeForFunction(const Decl *D,
                                              const SetOfConstDecls &Visited) {
@@ -469,6 +533,17 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+
+  // If the functions are divided among several invocations, only analyze the
+  // functions of this invocation's partition.
+  unsigned NumPartitions = Mgr->options.getAnalysisPartitionCount();
+  SetOfConstDecls Partition;
+  if (NumPartitions > 1) {
+    SmallVector<CallGraphNode *, 64> Order(RPOT.begin(), RPOT.end());
+    getAnalysisPartition(Order, NumPartitions,
+                         Mgr->options.getAnalysisPartitionIndex(), Partition);
+  }
+
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -480,6 +555,9 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    if (NumPartitions > 1 && !Partition.count(D))
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -517,7 +595,13 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+
+    // If the functions are divided among several invocations, the first one
+    // runs the AST-based checks, as well as the path-sensitive checks if
+    // inlining is disabled.
+    bool IsFirstPartition = Mgr->options.getAnalysisPartitionIndex() == 0;
+    if (IsFirstPartition)
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
@@ -534,15 +618,18 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // random access.  By doing so, we automatically compensate for iterators
     // possibly being invalidated, although this is a bit slower.
     const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-      TraverseDecl(LocalTUDecls[i]);
+    if (IsFirstPartition) {
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+        TraverseDecl(LocalTUDecls[i]);
+      }
     }
 
     if (Mgr->shouldInlineCall())
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (IsFirstPartition)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
     RecVisitorBR = nullptr;
   }
@@ -659,6 +746,14 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
   Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
                       Mgr->options.getMaxNodesPerTopLevelFunction());
 
+  // Report how large the exploded graph of this function grew.
+  if (Opts->PrintStats) {
+    ExplodedGraph &G = Eng.getGraph();
+    llvm::errs() << "GRAPH: " << getFunctionName(D) << ": "
+                 << G.getPeakSize() << " nodes at peak, "
+                 << G.getTotalMemory() / 1024 << " KB\n";
+  }
+
   // Release the auditor (if any) so that it doesn't monitor the graph
   // created BugReporter.
   ExplodedNode::SetAuditor(nullptr);
@@ -16,7 +16,12 @@
 #include "clang/Tooling/CompilationDatabasePluginRegistry.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
 #include <system_error>
 
 namespace clang {
@@ -117,6 +122,183 @@ std::vector<std::string> unescapeCommandLine(
   return parser.parse();
 }
 
+/// \brief A scanner for the subset of JSON used by compilation databases: an
+/// array of objects whose values are all strings.
+///
+/// The scanner does not build a tree and does not unescape strings; it only
+/// records where the contents of each string start and end in the buffer.
+class JSONScanner {
+ public:
+  JSONScanner(StringRef Input) : Input(Input), Position(0) {}
+
+  /// \brief Skips whitespace and consumes \p C if it is the next character.
+  bool consume(char C) {
+    skipWhitespace();
+    if (Position == Input.size() || Input[Position] != C)
+      return false;
+    ++Position;
+    return true;
+  }
+
+  /// \brief Skips whitespace and scans a string.
+  ///
+  /// Returns false if the next token is not a string.
+  bool scanString(StringRef &Raw, bool &HasEscapes) {
+    if (!consume('"'))
+      return false;
+    size_t Start = Position;
+    HasEscapes = false;
+    while (Position != Input.size()) {
+      char C = Input[Position];
+      if (C == '"') {
+        Raw = Input.substr(Start, Position - Start);
+        ++Position;
+        return true;
+      }
+      if (C == '\\') {
+        HasEscapes = true;
+        ++Position;
+        if (Position == Input.size())
+          return false;
+      }
+      ++Position;
+    }
+    return false;
+  }
+
+  /// \brief Returns whether only whitespace is left.
+  bool atEnd() {
+    skipWhitespace();
+    return Position == Input.size();
+  }
+
+ private:
+  void skipWhitespace() {
+    while (Position != Input.size() &&
+           (Input[Position] == ' ' || Input[Position] == '\t' ||
+            Input[Position] == '\n' || Input[Position] == '\r'))
+      ++Position;
+  }
+
+  const StringRef Input;
+  size_t Position;
+};
+
+/// \brief Reads the four hex digits of a \\u escape sequence.
+bool readHexCodeUnit(StringRef Digits, unsigned &CodeUnit) {
+  if (Digits.size() < 4)
+    return false;
+  return !Digits.substr(0, 4).getAsInteger(16, CodeUnit);
+}
+
+/// \brief Returns the value of the JSON string with the given raw contents.
+///
+/// Uses \p Storage if the string contains escape sequences.
+StringRef unescapeJSONString(StringRef Raw, bool HasEscapes,
+                             SmallVectorImpl<char> &Storage) {
+  if (!HasEscapes)
+    return Raw;
+  Storage.clear();
+  Storage.reserve(Raw.size());
+  for (size_t I = 0, E = Raw.size(); I != E; ++I) {
+    if (Raw[I] != '\\' || I + 1 == E) {
+      Storage.push_back(Raw[I]);
+      continue;
+    }
+    char C = Raw[++I];
+    switch (C) {
+    case 'b': Storage.push_back('\b'); break;
+    case 'f': Storage.push_back('\f'); break;
+    case 'n': Storage.push_back('\n'); break;
+    case 'r': Storage.push_back('\r'); break;
+    case 't': Storage.push_back('\t'); break;
+    case 'u': {
+      unsigned CodePoint;
+      if (!readHexCodeUnit(Raw.substr(I + 1), CodePoint)) {
+        Storage.push_back(C);
+        break;
+      }
+      I += 4;
+      // Combine a surrogate pair into a single code point.
+      unsigned Low;
+      if (CodePoint >= 0xD800 && CodePoint < 0xDC00 &&
+          Raw.substr(I + 1, 2) == "\\u" &&
+          readHexCodeUnit(Raw.substr(I + 3), Low) &&
+          Low >= 0xDC00 && Low < 0xE000) {
+        CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+        I += 6;
+      }
+      char Buffer[UNI_MAX_UTF8_BYTES_PER_CODE_POINT];
+      char *End = Buffer;
+      if (llvm::ConvertCodePointToUTF8(CodePoint, End))
+        Storage.append(Buffer, End);
+      break;
+    }
+    default:
+      // Covers \", \\ and \/.
+      Storage.push_back(C);
+      break;
+    }
+  }
+  return StringRef(Storage.data(), Storage.size());
+}
+
+/// \brief Layout of the binary index of a compilation database.
+///
+/// The header is followed by three tables and the file paths:
+/// - one IndexFile per file, in the order of the paths;
+/// - the indices of the commands of each file, in database order, as 64-bit
+///   integers; each IndexFile refers to a range of them;
+/// - one IndexCommand per compile command, in the order of the database.
+/// The strings of the commands are read from the database itself. All
+/// integers are 64 bits in host byte order.
+const char IndexMagic[8] = { 'C', 'D', 'B', 'I', 'D', 'X', '0', '3' };
+
+struct IndexHeader {
+  char Magic[8];
+  uint64_t DatabaseSize;
+  uint64_t DatabaseModTime;
+  uint64_t NumFiles;
+  uint64_t NumCommands;
+};
+
+struct IndexFile {
+  uint64_t PathOffset;
+  uint64_t PathLength;
+  uint64_t FirstCommand;
+  uint64_t NumCommands;
+};
+
+struct IndexCommand {
+  uint64_t File;
+  uint64_t DirectoryOffset;
+  uint64_t DirectoryLength;
+  uint64_t CommandOffset;
+  uint64_t CommandLength;
+  uint64_t Flags;
+};
+
+enum IndexCommandFlags {
+  DirectoryHasEscapes = 1,
+  CommandHasEscapes = 2
+};
+
+/// \brief Returns the offsets of the tables of an index with the given
+/// header, and the size of the tables.
+void getIndexLayout(const IndexHeader &Header, uint64_t &FileCommandsOffset,
+                    uint64_t &CommandsOffset, uint64_t &TablesEnd) {
+  FileCommandsOffset =
+      sizeof(IndexHeader) + Header.NumFiles * sizeof(IndexFile);
+  CommandsOffset = FileCommandsOffset + Header.NumCommands * sizeof(uint64_t);
+  TablesEnd = CommandsOffset + Header.NumCommands * sizeof(IndexCommand);
+}
+
+/// \brief Returns the modification time of a file as recorded in an index.
+uint64_t getIndexModTime(const llvm::sys::fs::file_status &Status) {
+  llvm::sys::TimeValue ModTime = Status.getLastModificationTime();
+  return uint64_t(ModTime.toEpochTime()) * 1000000000 + ModTime.nanoseconds();
+}
+
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
   std::unique_ptr<CompilationDatabase>
   loadFromDirectory(StringRef Directory, std::string &ErrorMessage) override {
@@ -143,7 +325,12 @@ volatile int JSONAnchorSource = 0;
 
 std::unique_ptr<JSONCompilationDatabase>
 JSONCompilationDatabase::loadFromFile(StringRef FilePath,
-                                      std::string &ErrorMessage) {
+                                      std::string &ErrorMessage,
+                                      bool UseIndex) {
+  // Take the size and modification time before reading, so that an index
+  // written for this load is out of date if the database changes meanwhile.
+  llvm::sys::fs::file_status Status;
+  bool HasStatus = !llvm::sys::fs::status(FilePath, Status);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> DatabaseBuffer =
       llvm::MemoryBuffer::getFile(FilePath);
   if (std::error_code Result = DatabaseBuffer.getError()) {
@@ -152,8 +339,26 @@ JSONCompilationDatabase::loadFromFile(StringRef FilePath,
   }
   std::unique_ptr<JSONCompilationDatabase> Database(
       new JSONCompilationDatabase(std::move(*DatabaseBuffer)));
+  Database->DatabasePath = FilePath;
+  if (HasStatus) {
+    Database->DatabaseSize = Status.getSize();
+    Database->DatabaseModTime = getIndexModTime(Status);
+  }
+
+  // Use the index if it was written for this version of the database.
+  // Otherwise scan the database and write an index for the next load; a
+  // database in a directory that cannot be written to simply stays
+  // unindexed.
+  bool CanIndex = UseIndex && HasStatus &&
+                  Database->Database->getBufferSize() == Status.getSize();
+  if (CanIndex && Database->readIndex(getIndexPath(FilePath)))
+    return Database;
   if (!Database->parse(ErrorMessage))
     return nullptr;
+  if (CanIndex) {
+    std::string IndexError;
+    Database->writeIndex(IndexError);
+  }
   return Database;
 }
 
@@ -174,11 +379,37 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
   SmallString<128> NativeFilePath;
   llvm::sys::path::native(FilePath, NativeFilePath);
 
+  // Most lookups are for a path exactly as in the database, which the index
+  // finds without building the match trie.
+  if (Index) {
+    std::vector<CompileCommand> Commands;
+    int64_t File = findIndexFile(NativeFilePath);
+    if (File >= 0) {
+      getIndexFileCommands(File, Commands);
+      return Commands;
+    }
+    std::call_once(MatchTrieFilled, [this] {
+      for (uint64_t I = 0; I != NumIndexFiles; ++I) {
+        StringRef Path;
+        uint64_t FirstCommand, NumCommands;
+        if (getIndexFile(I, Path, FirstCommand, NumCommands))
+          MatchTrie.insert(Path);
+      }
+    });
+  }
+
   std::string Error;
   llvm::raw_string_ostream ES(Error);
   StringRef Match = MatchTrie.findEquivalent(NativeFilePath, ES);
   if (Match.empty())
     return std::vector<CompileCommand>();
+  if (Index) {
+    std::vector<CompileCommand> Commands;
+    int64_t File = findIndexFile(Match);
+    if (File >= 0)
+      getIndexFileCommands(File, Commands);
+    return Commands;
+  }
   llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
     CommandsRefI = IndexByFile.find(Match);
   if (CommandsRefI == IndexByFile.end())
@@ -191,26 +422,46 @@ JSONCompilationDatabase::getCompileCommands(StringRef FilePath) const {
 std::vector<std::string>
 JSONCompilationDatabase::getAllFiles() const {
   std::vector<std::string> Result;
-
-  llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
-    CommandsRefI = IndexByFile.begin();
-  const llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
-    CommandsRefEnd = IndexByFile.end();
-  for (; CommandsRefI != CommandsRefEnd; ++CommandsRefI) {
-    Result.push_back(CommandsRefI->first().str());
+  if (Index) {
+    // A file is listed at its first command, as in the database.
+    for (uint64_t I = 0; I != NumIndexCommands; ++I) {
+      uint64_t File;
+      CompileCommandRef Command;
+      StringRef Path;
+      uint64_t FirstCommand, NumCommands;
+      if (!getIndexCommand(I, File, Command) ||
+          !getIndexFile(File, Path, FirstCommand, NumCommands))
+        continue;
+      uint64_t First;
+      memcpy(&First,
+             Index->getBufferStart() + sizeof(IndexHeader) +
+                 NumIndexFiles * sizeof(IndexFile) +
+                 FirstCommand * sizeof(uint64_t),
+             sizeof(First));
+      if (First == I)
+        Result.push_back(Path.str());
+    }
+    return Result;
   }
-
+  for (StringRef File : AllFiles)
+    Result.push_back(File.str());
   return Result;
 }
 
 std::vector<CompileCommand>
 JSONCompilationDatabase::getAllCompileCommands() const {
   std::vector<CompileCommand> Commands;
-  for (llvm::StringMap< std::vector<CompileCommandRef> >::const_iterator
-        CommandsRefI = IndexByFile.begin(), CommandsRefEnd = IndexByFile.end();
-      CommandsRefI != CommandsRefEnd; ++CommandsRefI) {
-    getCommands(CommandsRefI->getValue(), Commands);
+  if (Index) {
+    for (uint64_t I = 0; I != NumIndexCommands; ++I) {
+      uint64_t File;
+      CompileCommandRef Command;
+      if (getIndexCommand(I, File, Command))
+        getCommands(Command, Commands);
+    }
+    return Commands;
   }
+  for (const auto &FileAndCommand : AllCommands)
+    getCommands(FileAndCommand.second, Commands);
   return Commands;
 }
 
@@ -220,103 +471,343 @@ void JSONCompilationDatabase::getCommands(
   for (int I = 0, E = CommandsRef.size(); I != E; ++I) {
     SmallString<8> DirectoryStorage;
     SmallString<1024> CommandStorage;
+    const JSONString &Directory = CommandsRef[I].first;
+    const JSONString &Command = CommandsRef[I].second;
     Commands.emplace_back(
         // FIXME: Escape correctly:
-        CommandsRef[I].first->getValue(DirectoryStorage),
-        unescapeCommandLine(CommandsRef[I].second->getValue(CommandStorage)));
+        unescapeJSONString(Directory.Raw, Directory.HasEscapes,
+                           DirectoryStorage),
+        unescapeCommandLine(unescapeJSONString(Command.Raw, Command.HasEscapes,
+                                               CommandStorage)));
   }
 }
 
-bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
-  llvm::yaml::document_iterator I = YAMLStream.begin();
-  if (I == YAMLStream.end()) {
-    ErrorMessage = "Error while parsing YAML.";
-    return false;
-  }
-  llvm::yaml::Node *Root = I->getRoot();
-  if (!Root) {
-    ErrorMessage = "Error while parsing YAML.";
-    return false;
+void JSONCompilationDatabase::addCommand(StringRef NativeFilePath,
+                                         const CompileCommandRef &Command) {
+  auto &Entry = *IndexByFile.insert(std::make_pair(
+      NativeFilePath, std::vector<CompileCommandRef>())).first;
+  if (Entry.getValue().empty()) {
+    AllFiles.push_back(Entry.getKey());
+    MatchTrie.insert(Entry.getKey());
   }
-  llvm::yaml::SequenceNode *Array = dyn_cast<llvm::yaml::SequenceNode>(Root);
-  if (!Array) {
+  Entry.getValue().push_back(Command);
+  AllCommands.push_back(std::make_pair(Entry.getKey(), Command));
+}
+
+bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
+  JSONScanner Scanner(Database->getBuffer());
+  if (!Scanner.consume('[')) {
     ErrorMessage = "Expected array.";
     return false;
   }
-  for (llvm::yaml::SequenceNode::iterator AI = Array->begin(),
-                                          AE = Array->end();
-       AI != AE; ++AI) {
-    llvm::yaml::MappingNode *Object = dyn_cast<llvm::yaml::MappingNode>(&*AI);
-    if (!Object) {
+  if (Scanner.consume(']')) {
+    if (!Scanner.atEnd()) {
+      ErrorMessage = "Expected end of input.";
+      return false;
+    }
+    return true;
+  }
+  do {
+    if (!Scanner.consume('{')) {
       ErrorMessage = "Expected object.";
       return false;
     }
-    llvm::yaml::ScalarNode *Directory = nullptr;
-    llvm::yaml::ScalarNode *Command = nullptr;
-    llvm::yaml::ScalarNode *File = nullptr;
-    for (llvm::yaml::MappingNode::iterator KVI = Object->begin(),
-                                           KVE = Object->end();
-         KVI != KVE; ++KVI) {
-      llvm::yaml::Node *Value = (*KVI).getValue();
-      if (!Value) {
-        ErrorMessage = "Expected value.";
-        return false;
-      }
-      llvm::yaml::ScalarNode *ValueString =
-          dyn_cast<llvm::yaml::ScalarNode>(Value);
-      if (!ValueString) {
-        ErrorMessage = "Expected string as value.";
-        return false;
-      }
-      llvm::yaml::ScalarNode *KeyString =
-          dyn_cast<llvm::yaml::ScalarNode>((*KVI).getKey());
-      if (!KeyString) {
-        ErrorMessage = "Expected strings as key.";
-        return false;
-      }
-      SmallString<8> KeyStorage;
-      if (KeyString->getValue(KeyStorage) == "directory") {
-        Directory = ValueString;
-      } else if (KeyString->getValue(KeyStorage) == "command") {
-        Command = ValueString;
-      } else if (KeyString->getValue(KeyStorage) == "file") {
-        File = ValueString;
-      } else {
-        ErrorMessage = ("Unknown key: \"" +
-                        KeyString->getRawValue() + "\"").str();
+    JSONString Directory, Command, File;
+    bool HasDirectory = false, HasCommand = false, HasFile = false;
+    if (!Scanner.consume('}')) {
+      do {
+        JSONString Key, Value;
+        if (!Scanner.scanString(Key.Raw, Key.HasEscapes)) {
+          ErrorMessage = "Expected strings as key.";
+          return false;
+        }
+        if (!Scanner.consume(':')) {
+          ErrorMessage = "Expected ':'.";
+          return false;
+        }
+        if (!Scanner.scanString(Value.Raw, Value.HasEscapes)) {
+          ErrorMessage = "Expected string as value.";
+          return false;
+        }
+        SmallString<8> KeyStorage;
+        StringRef KeyValue =
+            unescapeJSONString(Key.Raw, Key.HasEscapes, KeyStorage);
+        if (KeyValue == "directory") {
+          Directory = Value;
+          HasDirectory = true;
+        } else if (KeyValue == "command") {
+          Command = Value;
+          HasCommand = true;
+        } else if (KeyValue == "file") {
+          File = Value;
+          HasFile = true;
+        } else {
+          ErrorMessage = ("Unknown key: \"" + Key.Raw + "\"").str();
+          return false;
+        }
+      } while (Scanner.consume(','));
+      if (!Scanner.consume('}')) {
+        ErrorMessage = "Expected '}'.";
         return false;
       }
     }
-    if (!File) {
+    if (!HasFile) {
       ErrorMessage = "Missing key: \"file\".";
       return false;
     }
-    if (!Command) {
+    if (!HasCommand) {
       ErrorMessage = "Missing key: \"command\".";
       return false;
     }
-    if (!Directory) {
+    if (!HasDirectory) {
       ErrorMessage = "Missing key: \"directory\".";
       return false;
     }
     SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
+    StringRef FileName = unescapeJSONString(File.Raw, File.HasEscapes,
+                                            FileStorage);
     SmallString<128> NativeFilePath;
     if (llvm::sys::path::is_relative(FileName)) {
       SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
+      SmallString<128> AbsolutePath(unescapeJSONString(
+          Directory.Raw, Directory.HasEscapes, DirectoryStorage));
       llvm::sys::path::append(AbsolutePath, FileName);
       llvm::sys::path::native(AbsolutePath, NativeFilePath);
     } else {
       llvm::sys::path::native(FileName, NativeFilePath);
     }
-    IndexByFile[NativeFilePath].push_back(
-        CompileCommandRef(Directory, Command));
-    MatchTrie.insert(NativeFilePath);
+    addCommand(NativeFilePath, CompileCommandRef(Directory, Command));
+  } while (Scanner.consume(','));
+  if (!Scanner.consume(']')) {
+    ErrorMessage = "Expected ']'.";
+    return false;
+  }
+  if (!Scanner.atEnd()) {
+    ErrorMessage = "Expected end of input.";
+    return false;
+  }
+  return true;
+}
+
+std::string JSONCompilationDatabase::getIndexPath(StringRef FilePath) {
+  return (FilePath + ".idx").str();
+}
+
+bool JSONCompilationDatabase::writeIndex(std::string &ErrorMessage) const {
+  if (DatabasePath.empty() || !DatabaseModTime) {
+    ErrorMessage = "Only databases loaded from a file can be indexed.";
+    return false;
+  }
+  // A database read through its index is indexed already.
+  if (Index)
+    return true;
+
+  // The files in the order of their paths, and their commands.
+  std::vector<StringRef> Files(AllFiles);
+  std::sort(Files.begin(), Files.end());
+  llvm::StringMap<uint64_t> FileIndices;
+  for (uint64_t I = 0, E = Files.size(); I != E; ++I)
+    FileIndices[Files[I]] = I;
+  std::vector<std::vector<uint64_t> > FileCommands(Files.size());
+  for (uint64_t I = 0, E = AllCommands.size(); I != E; ++I)
+    FileCommands[FileIndices[AllCommands[I].first]].push_back(I);
+
+  IndexHeader Header;
+  memcpy(Header.Magic, IndexMagic, sizeof(Header.Magic));
+  Header.DatabaseSize = DatabaseSize;
+  Header.DatabaseModTime = DatabaseModTime;
+  Header.NumFiles = Files.size();
+  Header.NumCommands = AllCommands.size();
+  uint64_t FileCommandsOffset, CommandsOffset, TablesEnd;
+  getIndexLayout(Header, FileCommandsOffset, CommandsOffset, TablesEnd);
+
+  // Write to a unique temporary file first, so that readers never see a
+  // partially written index and concurrent writers do not interfere.
+  std::string IndexPath = getIndexPath(DatabasePath);
+  int FD;
+  SmallString<128> TempPath;
+  std::error_code EC = llvm::sys::fs::createUniqueFile(
+      IndexPath + "-%%%%%%%%.tmp", FD, TempPath);
+  if (EC) {
+    ErrorMessage = "Error while writing index: " + EC.message();
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+
+    uint64_t PathOffset = TablesEnd;
+    uint64_t FirstCommand = 0;
+    for (uint64_t I = 0, E = Files.size(); I != E; ++I) {
+      IndexFile File;
+      File.PathOffset = PathOffset;
+      File.PathLength = Files[I].size();
+      File.FirstCommand = FirstCommand;
+      File.NumCommands = FileCommands[I].size();
+      OS.write(reinterpret_cast<const char *>(&File), sizeof(File));
+      PathOffset += File.PathLength;
+      FirstCommand += File.NumCommands;
+    }
+    for (const std::vector<uint64_t> &Commands : FileCommands)
+      OS.write(reinterpret_cast<const char *>(Commands.data()),
+               Commands.size() * sizeof(uint64_t));
+
+    const char *Start = Database->getBufferStart();
+    for (const auto &FileAndCommand : AllCommands) {
+      const JSONString &Directory = FileAndCommand.second.first;
+      const JSONString &Command = FileAndCommand.second.second;
+      IndexCommand Record;
+      Record.File = FileIndices[FileAndCommand.first];
+      Record.DirectoryOffset = Directory.Raw.data() - Start;
+      Record.DirectoryLength = Directory.Raw.size();
+      Record.CommandOffset = Command.Raw.data() - Start;
+      Record.CommandLength = Command.Raw.size();
+      Record.Flags = (Directory.HasEscapes ? DirectoryHasEscapes : 0) |
+                     (Command.HasEscapes ? CommandHasEscapes : 0);
+      OS.write(reinterpret_cast<const char *>(&Record), sizeof(Record));
+    }
+
+    for (StringRef File : Files)
+      OS << File;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      ErrorMessage = "Error while writing index.";
+      return false;
+    }
+  }
+  if ((EC = llvm::sys::fs::rename(TempPath, IndexPath))) {
+    llvm::sys::fs::remove(TempPath);
+    ErrorMessage = "Error while writing index: " + EC.message();
+    return false;
   }
   return true;
 }
 
+bool JSONCompilationDatabase::readIndex(StringRef IndexPath) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> IndexBuffer =
+      llvm::MemoryBuffer::getFile(IndexPath, -1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!IndexBuffer)
+    return false;
+  StringRef Contents = (*IndexBuffer)->getBuffer();
+
+  // Only the header and the size of the tables are checked here; the
+  // records are checked as they are read.
+  IndexHeader Header;
+  if (Contents.size() < sizeof(Header))
+    return false;
+  memcpy(&Header, Contents.data(), sizeof(Header));
+  if (memcmp(Header.Magic, IndexMagic, sizeof(Header.Magic)) ||
+      Header.DatabaseSize != DatabaseSize ||
+      Header.DatabaseModTime != DatabaseModTime ||
+      Header.NumFiles > Contents.size() / sizeof(IndexFile) ||
+      Header.NumCommands > Contents.size() / sizeof(IndexCommand))
+    return false;
+  uint64_t FileCommandsOffset, CommandsOffset, TablesEnd;
+  getIndexLayout(Header, FileCommandsOffset, CommandsOffset, TablesEnd);
+  if (TablesEnd > Contents.size())
+    return false;
+
+  Index = std::move(*IndexBuffer);
+  NumIndexFiles = Header.NumFiles;
+  NumIndexCommands = Header.NumCommands;
+  return true;
+}
+
+bool JSONCompilationDatabase::getIndexFile(uint64_t I, StringRef &Path,
+                                           uint64_t &FirstCommand,
+                                           uint64_t &NumCommands) const {
+  StringRef Contents = Index->getBuffer();
+  IndexFile File;
+  memcpy(&File, Contents.data() + sizeof(IndexHeader) + I * sizeof(File),
+         sizeof(File));
+  if (File.PathOffset > Contents.size() ||
+      File.PathLength > Contents.size() - File.PathOffset ||
+      File.FirstCommand > NumIndexCommands ||
+      File.NumCommands > NumIndexCommands - File.FirstCommand)
+    return false;
+  Path = Contents.substr(File.PathOffset, File.PathLength);
+  FirstCommand = File.FirstCommand;
+  NumCommands = File.NumCommands;
+  return true;
+}
+
+bool JSONCompilationDatabase::getIndexCommand(
+    uint64_t I, uint64_t &File, CompileCommandRef &Command) const {
+  IndexHeader Header;
+  Header.NumFiles = NumIndexFiles;
+  Header.NumCommands = NumIndexCommands;
+  uint64_t FileCommandsOffset, CommandsOffset, TablesEnd;
+  getIndexLayout(Header, FileCommandsOffset, CommandsOffset, TablesEnd);
+  IndexCommand Record;
+  memcpy(&Record,
+         Index->getBufferStart() + CommandsOffset + I * sizeof(Record),
+         sizeof(Record));
+  if (Record.File >= NumIndexFiles)
+    return false;
+
+  // Each string must lie within the database and be delimited by quotes.
+  StringRef Buffer = Database->getBuffer();
+  uint64_t Offsets[] = { Record.DirectoryOffset, Record.CommandOffset };
+  uint64_t Lengths[] = { Record.DirectoryLength, Record.CommandLength };
+  for (unsigned J = 0; J != 2; ++J) {
+    if (Offsets[J] == 0 || Offsets[J] > Buffer.size() ||
+        Lengths[J] >= Buffer.size() - Offsets[J] ||
+        Buffer[Offsets[J] - 1] != '"' ||
+        Buffer[Offsets[J] + Lengths[J]] != '"')
+      return false;
+  }
+  File = Record.File;
+  Command.first.Raw =
+      Buffer.substr(Record.DirectoryOffset, Record.DirectoryLength);
+  Command.first.HasEscapes = (Record.Flags & DirectoryHasEscapes) != 0;
+  Command.second.Raw =
+      Buffer.substr(Record.CommandOffset, Record.CommandLength);
+  Command.second.HasEscapes = (Record.Flags & CommandHasEscapes) != 0;
+  return true;
+}
+
+int64_t JSONCompilationDatabase::findIndexFile(StringRef NativeFilePath) const {
+  uint64_t Low = 0, High = NumIndexFiles;
+  while (Low < High) {
+    uint64_t Middle = Low + (High - Low) / 2;
+    StringRef Path;
+    uint64_t FirstCommand, NumCommands;
+    if (!getIndexFile(Middle, Path, FirstCommand, NumCommands))
+      return -1;
+    int Compare = Path.compare(NativeFilePath);
+    if (Compare == 0)
+      return Middle;
+    if (Compare < 0)
+      Low = Middle + 1;
+    else
+      High = Middle;
+  }
+  return -1;
+}
+
+void JSONCompilationDatabase::getIndexFileCommands(
+    uint64_t I, std::vector<CompileCommand> &Commands) const {
+  StringRef Path;
+  uint64_t FirstCommand, NumCommands;
+  if (!getIndexFile(I, Path, FirstCommand, NumCommands))
+    return;
+  const char *FileCommands = Index->getBufferStart() + sizeof(IndexHeader) +
+                             NumIndexFiles * sizeof(IndexFile);
+  for (uint64_t J = 0; J != NumCommands; ++J) {
+    uint64_t CommandIndex;
+    memcpy(&CommandIndex,
+           FileCommands + (FirstCommand + J) * sizeof(CommandIndex),
+           sizeof(CommandIndex));
+    uint64_t File;
+    CompileCommandRef Command;
+    if (CommandIndex < NumIndexCommands &&
+        getIndexCommand(CommandIndex, File, Command) && File == I)
+      getCommands(Command, Commands);
+  }
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -21,6 +21,8 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include <algorithm>
+#include <thread>
 
 namespace clang {
 namespace tooling {
@@ -37,6 +39,36 @@ int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
     return Result;
   }
 
+  return applyAndSave();
+}
+
+int RefactoringTool::runInParallel(RefactoringActionCreator CreateAction,
+                                   unsigned NumThreads) {
+  if (NumThreads == 0)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<Replacements> WorkerReplacements(NumThreads);
+  int Result = ClangTool::runInParallel(
+      [&](unsigned ThreadIndex) {
+        return CreateAction(WorkerReplacements[ThreadIndex]);
+      },
+      NumThreads);
+
+  for (const Replacements &Replaces : WorkerReplacements)
+    Replace.insert(Replaces.begin(), Replaces.end());
+  return Result;
+}
+
+int RefactoringTool::runAndSaveInParallel(RefactoringActionCreator CreateAction,
+                                          unsigned NumThreads) {
+  if (int Result = runInParallel(CreateAction, NumThreads)) {
+    return Result;
+  }
+
+  return applyAndSave();
+}
+
+int RefactoringTool::applyAndSave() {
   LangOptions DefaultLangOptions;
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
   TextDiagnosticPrinter DiagnosticPrinter(llvm::errs(), &*DiagOpts);
@@ -30,6 +30,9 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 // For chdir, see the comment in ClangTool::run for more information.
 #ifdef LLVM_ON_WIN32
@@ -383,6 +386,105 @@ int ClangTool::run(ToolAction *Action) {
 
 namespace {
 
+/// \brief A compile command of a source file, as scheduled by
+/// ClangTool::runInParallel.
+struct ToolJob {
+  std::string File;
+  CompileCommand Command;
+};
+
+}
+
+int ClangTool::runInParallel(ToolActionCreator CreateAction,
+                             unsigned NumThreads) {
+  // Exists solely for the purpose of lookup of the resource path.
+  static int StaticSymbol;
+  std::string MainExecutable =
+      llvm::sys::fs::getMainExecutable("clang_tool", &StaticSymbol);
+
+  // Look up all compile commands before starting the workers, since the
+  // compilation database is not required to be thread-safe.
+  std::vector<ToolJob> Jobs;
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty()) {
+      llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
+      continue;
+    }
+    for (CompileCommand &CompileCommand : CompileCommandsForFile)
+      Jobs.push_back(ToolJob{File, std::move(CompileCommand)});
+  }
+  if (Jobs.empty())
+    return 0;
+
+  if (NumThreads == 0)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  NumThreads = std::min<size_t>(NumThreads, Jobs.size());
+
+  std::atomic<size_t> NextJob(0);
+  std::vector<char> Failed(Jobs.size(), 0);
+  auto Worker = [&](unsigned ThreadIndex) {
+    std::unique_ptr<ToolAction> Action = CreateAction(ThreadIndex);
+
+    // Relative paths are resolved by the FileManager against the working
+    // directory of the compile command, so that no worker needs to chdir.
+    // The FileManagers are kept across compile commands to reuse their
+    // caches.
+    llvm::StringMap<IntrusiveRefCntPtr<FileManager>> FileManagers;
+    for (size_t I = NextJob++; I < Jobs.size(); I = NextJob++) {
+      const ToolJob &Job = Jobs[I];
+      IntrusiveRefCntPtr<FileManager> &JobFiles =
+          FileManagers[Job.Command.Directory];
+      if (!JobFiles) {
+        FileSystemOptions FileSystemOpts;
+        FileSystemOpts.WorkingDir = Job.Command.Directory;
+        JobFiles = new FileManager(FileSystemOpts);
+      }
+
+      std::vector<std::string> CommandLine = Job.Command.CommandLine;
+      if (ArgsAdjuster)
+        CommandLine = ArgsAdjuster(CommandLine);
+      assert(!CommandLine.empty());
+      CommandLine[0] = MainExecutable;
+      // Also pass the working directory on to the frontend, for actions that
+      // create their own FileManager.
+      CommandLine.insert(CommandLine.begin() + 1, "-working-directory");
+      CommandLine.insert(CommandLine.begin() + 2, Job.Command.Directory);
+      DEBUG({ llvm::dbgs() << "Processing: " << Job.File << ".\n"; });
+      ToolInvocation Invocation(std::move(CommandLine), Action.get(),
+                                JobFiles.get(), PCHContainerOps);
+      Invocation.setDiagnosticConsumer(DiagConsumer);
+      for (const auto &MappedFile : MappedFileContents)
+        Invocation.mapVirtualFile(MappedFile.first, MappedFile.second);
+      if (!Invocation.run())
+        Failed[I] = 1;
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned ThreadIndex = 1; ThreadIndex < NumThreads; ++ThreadIndex)
+    Threads.emplace_back(Worker, ThreadIndex);
+  Worker(0);
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  // Report failures in the order of the compile commands, independent of
+  // the scheduling of the workers.
+  bool ProcessingFailed = false;
+  for (size_t I = 0, E = Jobs.size(); I != E; ++I) {
+    if (Failed[I]) {
+      // FIXME: Diagnostics should be used instead.
+      llvm::errs() << "Error while processing " << Jobs[I].File << ".\n";
+      ProcessingFailed = true;
+    }
+  }
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
 class ASTBuilderAction : public ToolAction {
   std::vector<std::unique_ptr<ASTUnit>> &ASTs;
 
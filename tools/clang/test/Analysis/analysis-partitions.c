@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config analysis-partitions=2,analysis-partition=0 %s 2>&1 | FileCheck %s --check-prefix=PARTITION0
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config analysis-partitions=2,analysis-partition=1 %s 2>&1 | FileCheck %s --check-prefix=PARTITION1
+
+// The two call graph components are analyzed by different partitions, so
+// each partition reports exactly one of the bugs. The larger component goes
+// to partition 0.
+// PARTITION0-NOT: warning:
+// PARTITION1-NOT: warning:
+
+static int divide(int x, int y) {
+  // PARTITION0: analysis-partitions.c:[[@LINE+1]]:{{[0-9]+}}: warning: Division by zero
+  return x / y;
+}
+
+int first() {
+  return divide(1, 0);
+}
+
+int second(int *p) {
+  p = 0;
+  // PARTITION1: analysis-partitions.c:[[@LINE+1]]:{{[0-9]+}}: warning: Dereference of null pointer (loaded from variable 'p')
+  return *p;
+}
+
+// PARTITION0-NOT: warning:
+// PARTITION1-NOT: warning:
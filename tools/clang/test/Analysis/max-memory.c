@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.Stats -verify -analyzer-config max-nodes=0,max-memory=1 %s
+
+// Every branch doubles the number of paths, so the exploded graph outgrows
+// the 1 MB budget and the analysis stops with work left on the worklist.
+int explode(int a, int b, int c, int d, int e, int f, int g, int h,
+            int i, int j, int k, int l, int m, int n, int o, int p) { // expected-warning-re{{explode -> Total CFGBlocks: {{[0-9]+}} | Unreachable CFGBlocks: {{[0-9]+}} | Exhausted Block: no | Empty WorkList: no}}
+  int x = 0;
+  if (a) x += 1;
+  if (b) x += 2;
+  if (c) x += 3;
+  if (d) x += 4;
+  if (e) x += 5;
+  if (f) x += 6;
+  if (g) x += 7;
+  if (h) x += 8;
+  if (i) x += 9;
+  if (j) x += 10;
+  if (k) x += 11;
+  if (l) x += 12;
+  if (m) x += 13;
+  if (n) x += 14;
+  if (o) x += 15;
+  if (p) x += 16;
+  return x;
+}
+
+// A small function is analyzed completely within the budget.
+int small(int a) { // expected-warning-re{{small -> Total CFGBlocks: {{[0-9]+}} | Unreachable CFGBlocks: 0 | Exhausted Block: no | Empty WorkList: yes}}
+  if (a)
+    return 1;
+  return 0;
+}
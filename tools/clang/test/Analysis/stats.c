@@ -4,6 +4,8 @@
 void foo() {
   int x;
 }
+// CHECK: GRAPH: foo: {{[0-9]+}} nodes at peak, {{[0-9]+}} KB
 // CHECK: ... Statistics Collected ...
 // CHECK:100 AnalysisConsumer - The % of reachable basic blocks.
+// CHECK: CoreEngine - The maximum number of nodes in an exploded graph.
 // CHECK:The # of times RemoveDeadBindings is called
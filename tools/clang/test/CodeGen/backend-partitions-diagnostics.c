@@ -0,0 +1,34 @@
+// REQUIRES: x86-registered-target, shell
+// UNSUPPORTED: system-darwin, system-windows
+
+// The diagnostics of the code generator for the partitions are reported like
+// those for the whole module: warnings are kept and honor -Werror, and inline
+// asm diagnostics point into the source.
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:     -fbackend-partitions=2 -backend-partition-linker "$(command -v ld)" \
+// RUN:     -mllvm -warn-stack-size=64 %s -o %t.o 2>&1 \
+// RUN:     | FileCheck %s -check-prefix=WARN -check-prefix=ASM
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:     -fbackend-partitions=2 -backend-partition-linker "$(command -v ld)" \
+// RUN:     -mllvm -warn-stack-size=64 -DNO_ASM %s -o %t.o 2>&1 \
+// RUN:     | FileCheck %s -check-prefix=WARN
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:     -fbackend-partitions=2 -backend-partition-linker "$(command -v ld)" \
+// RUN:     -mllvm -warn-stack-size=64 -DNO_ASM -Werror=frame-larger-than= \
+// RUN:     %s -o %t.o 2>&1 | FileCheck %s -check-prefix=PROMOTE
+
+extern void doIt(char *);
+
+// WARN-DAG: backend-partitions-diagnostics.c:[[@LINE+2]]:6: warning: stack frame size of {{[0-9]+}} bytes in function 'stackSizeWarning'
+// PROMOTE: backend-partitions-diagnostics.c:[[@LINE+1]]:6: error: stack frame size of {{[0-9]+}} bytes in function 'stackSizeWarning'
+void stackSizeWarning(void) {
+  char buffer[80];
+  doIt(buffer);
+}
+
+void inlineAsmError(void) {
+#ifndef NO_ASM
+  // ASM-DAG: backend-partitions-diagnostics.c:[[@LINE+1]]:{{[0-9]+}}: error: invalid instruction mnemonic 'nonsense_mnemonic'
+  __asm__("nonsense_mnemonic");
+#endif
+}
@@ -0,0 +1,58 @@
+// REQUIRES: x86-registered-target, shell
+// UNSUPPORTED: system-darwin, system-windows
+
+// The objects of the partitions are merged with the system linker.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj \
+// RUN:     -fbackend-partitions=3 -backend-partition-linker "$(command -v ld)" \
+// RUN:     %s -o %t.o
+// RUN: llvm-nm %t.o | FileCheck %s -check-prefix=UNDEF
+// RUN: llvm-nm -extern-only -defined-only %t.o | FileCheck %s
+
+// Every reference is resolved within the translation unit.
+// UNDEF-NOT: {{ U }}
+
+// The local functions shared across partitions get unique names, and
+// nothing keeps its original name as a global symbol.
+// CHECK: T big_a
+// CHECK-NEXT: T big_b
+// CHECK-NEXT: D counter
+// CHECK-NEXT: T helper.partition.{{[0-9a-f]+}}
+// CHECK-NOT: {{ (inner|helper)$}}
+
+int counter = 1;
+
+// The two large functions are dealt to partitions 0 and 1, so that helper
+// and inner, in that order, go to partition 2.  inner is only called from
+// partition 2 and stays local; helper is called from another partition.
+static int inner(int x) { return x * 3 + counter; }
+
+static int helper(int x) {
+  int y = inner(x);
+  y = y * 7 + inner(y);
+  return y - 1;
+}
+
+int big_a(int x) {
+  int s = helper(x);
+  for (int i = 0; i < x; ++i) {
+    s += i * x;
+    s ^= s >> 3;
+    s += counter;
+    s -= i;
+    s *= 5;
+  }
+  return s;
+}
+
+int big_b(int x) {
+  int s = x;
+  for (int i = 0; i < x; ++i) {
+    s += i * x;
+    s ^= s >> 3;
+    s += counter;
+    s -= i;
+    s *= 5;
+    s += i << 2;
+  }
+  return s;
+}
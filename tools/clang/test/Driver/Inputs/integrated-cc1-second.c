@@ -0,0 +1 @@
+int second(void) { return 2; }
@@ -0,0 +1,14 @@
+// RUN: %clang -target x86_64-linux-gnu -### -c -fbackend-partitions=4 %s \
+// RUN:     2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK: "-fbackend-partitions=4" "-backend-partition-linker" "{{[^"]*}}ld{{(.exe)?}}"
+
+// The partitions are merged with 'ld -r', which link.exe cannot do.
+// RUN: %clang -target x86_64-pc-windows-msvc -### -c \
+// RUN:     -fbackend-partitions=4 %s 2>&1 | FileCheck %s -check-prefix MSVC
+// MSVC-NOT: -fbackend-partitions
+// MSVC-NOT: -backend-partition-linker
+
+// RUN: %clang -target x86_64-linux-gnu -### -c %s 2>&1 \
+// RUN:     | FileCheck %s -check-prefix NONE
+// NONE-NOT: -backend-partition-linker
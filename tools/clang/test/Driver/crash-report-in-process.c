@@ -0,0 +1,25 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: not env TMPDIR=%t TEMP=%t TMP=%t RC_DEBUG_OPTIONS=1 %clang -fsyntax-only \
+// RUN:  -fintegrated-cc1 %s -DFOO=BAR 2>&1 | FileCheck %s
+// RUN: cat %t/crash-report-in-process-*.c | FileCheck --check-prefix=CHECKSRC %s
+// RUN: cat %t/crash-report-in-process-*.sh | FileCheck --check-prefix=CHECKSH %s
+// REQUIRES: crash-recovery
+
+// because of the glob (*.c, *.sh)
+// REQUIRES: shell
+
+#pragma clang __debug parser_crash
+// CHECK: clang frontend command failed due to signal
+// CHECK: Preprocessed source(s) and associated run script(s) are located at:
+// CHECK-NEXT: note: diagnostic msg: {{.*}}crash-report-in-process-{{.*}}.c
+FOO
+// CHECKSRC: FOO
+// CHECKSH: # Crash reproducer
+// CHECKSH-NEXT: # Driver args: "-fsyntax-only"
+// CHECKSH-SAME: "-fintegrated-cc1"
+// CHECKSH-NEXT: # Original command: {{.*$}}
+// CHECKSH-NEXT: "-cc1"
+// CHECKSH: "-main-file-name" "crash-report-in-process.c"
+// CHECKSH: "-D" "FOO=BAR"
+// CHECKSH: "crash-report-in-process-{{[^ ]*}}.c"
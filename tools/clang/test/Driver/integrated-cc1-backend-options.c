@@ -0,0 +1,15 @@
+// Backend options are global state in the driver's process, so the second
+// compile of a driver with several inputs must not set them again there.
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cd %t && %clang -fintegrated-cc1 -target armv7-linux-gnueabi \
+// RUN:     -mno-unaligned-access -mno-global-merge -c %s \
+// RUN:     %S/Inputs/integrated-cc1-second.c 2>&1 \
+// RUN:     | FileCheck %s -allow-empty
+// RUN: test -f %t/integrated-cc1-backend-options.o
+// RUN: test -f %t/integrated-cc1-second.o
+// REQUIRES: shell, arm-registered-target
+
+// CHECK-NOT: may only occur zero or one times
+
+int f(void) { return 0; }
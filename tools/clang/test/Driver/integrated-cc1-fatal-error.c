@@ -0,0 +1,15 @@
+// A fatal error in a compile that runs in the driver's process ends that
+// compile, not the driver: the error is reported with the compiler's status
+// and the remaining jobs still run.
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cd %t && not %clang -fintegrated-cc1 -fno-crash-diagnostics -c %s \
+// RUN:     %S/Inputs/integrated-cc1-second.c 2>&1 | FileCheck %s
+// RUN: test -f %t/integrated-cc1-second.o
+// RUN: not test -f %t/integrated-cc1-fatal-error.o
+// REQUIRES: shell
+
+// CHECK: error in backend: #pragma clang __debug llvm_fatal_error
+// CHECK: clang frontend command failed with exit code 70
+
+#pragma clang __debug llvm_fatal_error
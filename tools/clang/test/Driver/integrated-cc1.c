@@ -0,0 +1,21 @@
+// RUN: %clang -### -fintegrated-cc1 -c %s 2>&1 | FileCheck %s
+// CHECK: (in-process)
+// CHECK-NEXT: "-cc1"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck %s -check-prefix NO
+// RUN: %clang -### -fintegrated-cc1 -fno-integrated-cc1 -c %s 2>&1 \
+// RUN:     | FileCheck %s -check-prefix NO
+// NO-NOT: (in-process)
+// NO: "-cc1"
+
+// Options for LLVM are global state, so jobs using them run separately.
+// RUN: %clang -### -fintegrated-cc1 -mllvm -debug-pass=Structure -c %s 2>&1 \
+// RUN:     | FileCheck %s -check-prefix NO
+// RUN: %clang -### -fintegrated-cc1 -target armv7-linux-gnueabi \
+// RUN:     -mno-unaligned-access -c %s %s 2>&1 \
+// RUN:     | FileCheck %s -check-prefix NO
+
+// RUN: %clang -fintegrated-cc1 -c %s -o %t.o
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s %s
+
+int f(void) { return 0; }
@@ -0,0 +1,21 @@
+// RUN: %clang -j2 -fsyntax-only %s %S/Inputs/parallel-jobs-second.c \
+// RUN:     %s 2>&1 | FileCheck %s
+// RUN: %clang -j0 -fsyntax-only %s %S/Inputs/parallel-jobs-second.c \
+// RUN:     %s 2>&1 | FileCheck %s
+
+// The output of each job is reported in the order of the inputs.
+// CHECK: parallel-jobs.c:{{.*}} warning: first input
+// CHECK: parallel-jobs-second.c:{{.*}} warning: second input
+// CHECK: parallel-jobs.c:{{.*}} warning: first input
+
+// RUN: %clang -j2 -v -fsyntax-only %s %S/Inputs/parallel-jobs-second.c 2>&1 \
+// RUN:     | FileCheck %s -check-prefix VERBOSE
+// VERBOSE: "-cc1" {{.*}}parallel-jobs.c
+// VERBOSE: parallel-jobs.c:{{.*}} warning: first input
+// VERBOSE: "-cc1" {{.*}}parallel-jobs-second.c
+// VERBOSE: parallel-jobs-second.c:{{.*}} warning: second input
+
+// RUN: not %clang -jx -fsyntax-only %s 2>&1 | FileCheck %s -check-prefix BAD
+// BAD: invalid integral value 'x' in '-jx'
+
+#warning first input
@@ -0,0 +1,6 @@
+// RUN: %clang -### -c -fstat-cache-path=%t.statcache %s 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK: "-fstat-cache-path={{.*}}.statcache"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck %s -check-prefix=CHECK-NONE
+// CHECK-NONE-NOT: -fstat-cache-path
@@ -0,0 +1,21 @@
+// RUN: rm -f %t.cache
+// RUN: clang-format -style="{BasedOnStyle: LLVM, ColumnLimit: 40}" \
+// RUN:   -cache=%t.cache %s > %t.first
+// RUN: FileCheck -input-file=%t.cache %s
+// RUN: clang-format -style="{BasedOnStyle: LLVM, ColumnLimit: 40}" \
+// RUN:   -cache=%t.cache %s > %t.second
+// RUN: diff %t.first %t.second
+// RUN: sed -e '2,${' -e ':a' -e 's/\( [01]*\)1/\10/' -e 'ta' -e '}' \
+// RUN:   %t.cache > %t.seeded
+// RUN: clang-format -style="{BasedOnStyle: LLVM, ColumnLimit: 40}" \
+// RUN:   -cache=%t.seeded %s | FileCheck -check-prefix=SEEDED %s
+
+// The line breaks of the declaration below are recorded in the cache, and
+// replaying them gives the same result as searching for them.
+// CHECK: clang-format-cache
+// CHECK-NEXT: {{^[0-9a-f]+ [01]+$}}
+//
+// A cache whose decisions are changed to never break is replayed as it is,
+// which shows that the second run takes the decisions from the cache.
+// SEEDED: {{^int x = aaaaaaaaaaaaaaa\(bbbbbbbbbbbbbbb, cccccccccccccccc, dddddddddddd\);$}}
+int x = aaaaaaaaaaaaaaa(bbbbbbbbbbbbbbb, cccccccccccccccc, dddddddddddd);
@@ -0,0 +1,16 @@
+// RUN: cp %s %t-1.cpp
+// RUN: cp %s %t-2.cpp
+// RUN: cp %s %t-3.cpp
+// RUN: clang-format -style=LLVM -j=2 %t-1.cpp %t-2.cpp %t-3.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+
+// The files are printed in the order in which they are given.
+// CHECK: {{^int\ \*i;}}
+// CHECK-NEXT: {{^int\ function\(int\ parameter\);}}
+// CHECK: {{^int\ \*i;}}
+// CHECK-NEXT: {{^int\ function\(int\ parameter\);}}
+// CHECK: {{^int\ \*i;}}
+// CHECK-NEXT: {{^int\ function\(int\ parameter\);}}
+ int   *  i  ;
+int function(
+int parameter);
@@ -0,0 +1,34 @@
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t.cpp
+// RUN: clang-format -style=LLVM %t.cpp | FileCheck -strict-whitespace %s
+
+// A corpus of lines for which the search for the best line breaks explores
+// many states.  Run lit with --time-tests to track how long they take.
+
+// CHECK: {{^}}int array[] = {1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16,{{$}}
+// CHECK-NEXT: {{^}}               17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,{{$}}
+// CHECK-NEXT: {{^}}               33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48,{{$}}
+// CHECK-NEXT: {{^}}               49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64};{{$}}
+int array[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64};
+
+// CHECK: {{^}}int nested = f(g(h(aaaaaaaaaa, bbbbbbbbbb), i(cccccccccc, dddddddddd)),{{$}}
+// CHECK-NEXT: {{^}}               j(k(eeeeeeeeee, ffffffffff), l(gggggggggg, hhhhhhhhhh)),{{$}}
+// CHECK-NEXT: {{^}}               m(n(iiiiiiiiii, jjjjjjjjjj), o(kkkkkkkkkk, llllllllll)));{{$}}
+int nested = f(g(h(aaaaaaaaaa, bbbbbbbbbb), i(cccccccccc, dddddddddd)), j(k(eeeeeeeeee, ffffffffff), l(gggggggggg, hhhhhhhhhh)), m(n(iiiiiiiiii, jjjjjjjjjj), o(kkkkkkkkkk, llllllllll)));
+
+// CHECK: {{^}}int sum = aaaaaaaaaa + bbbbbbbbbb * cccccccccc - dddddddddd / eeeeeeeeee +{{$}}
+// CHECK-NEXT: {{^}}          ffffffffff * gggggggggg - hhhhhhhhhh / iiiiiiiiii +{{$}}
+// CHECK-NEXT: {{^}}          jjjjjjjjjj * kkkkkkkkkk - llllllllll / mmmmmmmmmm;{{$}}
+int sum = aaaaaaaaaa + bbbbbbbbbb * cccccccccc - dddddddddd / eeeeeeeeee + ffffffffff * gggggggggg - hhhhhhhhhh / iiiiiiiiii + jjjjjjjjjj * kkkkkkkkkk - llllllllll / mmmmmmmmmm;
+
+// CHECK: {{^}}struct S s = {{[{][{]}}1, "aaaaaaaaaa"}, {2, "bbbbbbbbbb"}, {3, "cccccccccc"},{{$}}
+// CHECK-NEXT: {{^}}              {4, "dddddddddd"}, {5, "eeeeeeeeee"}, {6, "ffffffffff"},{{$}}
+// CHECK-NEXT: {{^}}              {7, "gggggggggg"}, {8, "hhhhhhhhhh"}};{{$}}
+struct S s = {{1, "aaaaaaaaaa"}, {2, "bbbbbbbbbb"}, {3, "cccccccccc"}, {4, "dddddddddd"}, {5, "eeeeeeeeee"}, {6, "ffffffffff"}, {7, "gggggggggg"}, {8, "hhhhhhhhhh"}};
+
+// CHECK: {{^}}void call() {{{$}}
+// CHECK-NEXT: {{^}}  object.method(aaaaaaaaaa){{$}}
+// CHECK-NEXT: {{^}}      .other(bbbbbbbbbb, cccccccccc){{$}}
+// CHECK-NEXT: {{^}}      .third(dddddddddd(eeeeeeeeee, ffffffffff), gggggggggg){{$}}
+// CHECK-NEXT: {{^}}      .last(hhhhhhhhhh);{{$}}
+// CHECK-NEXT: {{^}}}{{$}}
+void call() { object.method(aaaaaaaaaa).other(bbbbbbbbbb, cccccccccc).third(dddddddddd(eeeeeeeeee, ffffffffff), gggggggggg).last(hhhhhhhhhh); }
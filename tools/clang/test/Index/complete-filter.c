@@ -0,0 +1,39 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+
+#define COLOR 1
+
+struct Point { int x, y; };
+int counter;
+int compute(int);
+void consume(int);
+int other;
+
+void test(struct Point p) {
+  int count_local = 0;
+  counter = count_local;
+  p.y = 1;
+}
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=co c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_FILTER=co c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-PREFIX %s
+// CHECK-PREFIX-NOT: {TypedText other}
+// CHECK-PREFIX-NOT: {TypedText test}
+// CHECK-PREFIX: macro definition:{TypedText COLOR}
+// CHECK-PREFIX: FunctionDecl:{ResultType int}{TypedText compute}{LeftParen (}{Placeholder int}{RightParen )}
+// CHECK-PREFIX: FunctionDecl:{ResultType void}{TypedText consume}{LeftParen (}{Placeholder int}{RightParen )}
+// CHECK-PREFIX: VarDecl:{ResultType int}{TypedText count_local} (8)
+// CHECK-PREFIX: VarDecl:{ResultType int}{TypedText counter}
+// CHECK-PREFIX-NOT: {TypedText other}
+// CHECK-PREFIX-NOT: {TypedText test}
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=co CINDEXTEST_COMPLETION_MAX_RESULTS=1 c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-TOP %s
+// RUN: env CINDEXTEST_COMPLETION_MAX_RESULTS=1 c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-TOP %s
+// CHECK-TOP-NOT: {TypedText
+// CHECK-TOP: VarDecl:{ResultType int}{TypedText count_local} (8)
+// CHECK-TOP-NOT: {TypedText
+
+// RUN: env CINDEXTEST_COMPLETION_FILTER=Y c-index-test -code-completion-at=%s:15:5 %s | FileCheck -check-prefix=CHECK-MEMBER %s
+// CHECK-MEMBER-NOT: {TypedText x}
+// CHECK-MEMBER: FieldDecl:{ResultType int}{TypedText y} (35)
+// CHECK-MEMBER-NOT: {TypedText x}
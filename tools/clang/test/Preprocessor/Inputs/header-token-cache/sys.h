@@ -0,0 +1,14 @@
+#ifndef SYS_H
+#define SYS_H
+
+#define SYS_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#if defined(__cplusplus)
+extern "C++" int sys_lang(void);
+#else
+int sys_lang(void);
+#endif
+
+static const char *sys_name = "sys.h \"quoted\"";
+
+#endif
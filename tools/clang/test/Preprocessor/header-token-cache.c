@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %clang_cc1 -E -isystem %S/Inputs/header-token-cache %s -o %t/plain.i
+// RUN: %clang_cc1 -E -isystem %S/Inputs/header-token-cache %s -o %t/first.i \
+// RUN:   -fheader-token-cache=%t/cache -print-stats 2>&1 \
+// RUN:   | FileCheck -check-prefix=FIRST %s
+// RUN: ls %t/cache | count 1
+// RUN: %clang_cc1 -E -isystem %S/Inputs/header-token-cache %s -o %t/second.i \
+// RUN:   -fheader-token-cache=%t/cache -print-stats 2>&1 \
+// RUN:   | FileCheck -check-prefix=SECOND %s
+// RUN: diff %t/plain.i %t/first.i
+// RUN: diff %t/plain.i %t/second.i
+
+// The tokens of a system header are cached by the first compilation and
+// read from the cache by the second.
+// FIRST: 0 source files read from the header token cache
+// SECOND: 1 source files read from the header token cache
+
+#include <sys.h>
+#include <sys.h>
+
+int f(void) { return SYS_MAX(sys_lang(), 0) + *sys_name; }
@@ -0,0 +1,27 @@
+// This uses a headermap with this entry:
+//   someheader.h -> Product/someheader.h
+
+// Header search through a headermap answers the same with the directory
+// listing cache enabled.
+// RUN: %clang_cc1 -E %s -o %t.i -fheader-search-dir-cache -iquote %S/Inputs/headermap-rel2/project-headers.hmap -isystem %S/Inputs/headermap-rel2/system/usr/include -I %S/Inputs/headermap-rel2 -H 2> %t.out
+// RUN: FileCheck %s -input-file %t.out
+// RUN: FileCheck %s -check-prefix=HAS -input-file %t.i
+
+// CHECK: Product/someheader.h
+// CHECK: system/usr/include{{[/\\]+}}someheader.h
+
+// HAS: mapped_found
+// HAS: missing_not_found
+
+#include "someheader.h"
+#include <someheader.h>
+
+#if __has_include("someheader.h")
+mapped_found
+#endif
+
+#if __has_include("missingheader.h")
+missing_found
+#else
+missing_not_found
+#endif
@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -E -std=c++11 %s | FileCheck --strict-whitespace %s
+// RUN: %clang_cc1 -E -std=c++11 -trigraphs %s | FileCheck --strict-whitespace %s
+
+#if 0
+/* A comment that hides
+#error in a block comment
+*/
+// A line comment that continues \
+#error in a line comment
+const char *s = "a string that continues \
+#error in a string";
+int i = 0 + \
+#error after an escaped newline
+1;
+const char *r = R"(
+#error in a raw string
+)";
+char c = '"'; const char *t = "'";
+   /* comment */ #define A 1
+#else
+yes_else
+#endif
+// CHECK: {{^}}yes_else{{$}}
+
+#ifdef UNDEFINED
+#if 1
+nested
+#endif
+  %:  else
+#elif 1
+yes_elif
+#endif
+// CHECK: {{^}}yes_elif{{$}}
+// CHECK-NOT: A
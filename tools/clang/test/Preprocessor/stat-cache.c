@@ -0,0 +1,40 @@
+// REQUIRES: shell
+// RUN: rm -rf %t && mkdir -p %t/sys
+// RUN: echo '#define PRESENT 1' > %t/sys/present.h
+// RUN: touch -t 200001010000 %t/sys
+
+// The first compilation writes the missing system header to the cache, but
+// not the one that exists.
+// RUN: %clang_cc1 -E -isystem %t/sys -fstat-cache-path=%t/stat.cache %s \
+// RUN:   | FileCheck %s -check-prefix=FIRST
+// RUN: grep -q 'sys/probe.h' %t/stat.cache
+// RUN: not grep -q 'sys/present.h' %t/stat.cache
+// FIRST: probe_missing
+// FIRST: present = 1
+
+// A later compilation takes the missing header from the cache while its
+// directory is unchanged, even if the header was created behind its back,
+// and 'stat's the header that exists, which was edited in place.
+// RUN: echo 'probe' > %t/sys/probe.h
+// RUN: echo '#define PRESENT 22' > %t/sys/present.h
+// RUN: touch -t 200001010000 %t/sys
+// RUN: %clang_cc1 -E -isystem %t/sys -fstat-cache-path=%t/stat.cache %s \
+// RUN:   | FileCheck %s -check-prefix=REUSED
+// REUSED: probe_missing
+// REUSED: present = 22
+
+// Once the directory changed, the entry is stale and is not served.
+// RUN: touch -t 200101010000 %t/sys
+// RUN: %clang_cc1 -E -isystem %t/sys -fstat-cache-path=%t/stat.cache %s \
+// RUN:   | FileCheck %s -check-prefix=STALE
+// STALE: probe_found
+// STALE: present = 22
+
+#if __has_include(<probe.h>)
+probe_found
+#else
+probe_missing
+#endif
+
+#include <present.h>
+present = PRESENT
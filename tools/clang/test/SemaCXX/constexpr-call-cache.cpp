@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -fconstexpr-steps 1000 -fconstexpr-depth 12
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only %s -fconstexpr-steps 1000 -fconstexpr-depth 12 -print-stats 2>&1 | FileCheck %s
+
+// The results of constexpr calls are reused, but a reused result still
+// counts against the step and depth limits.
+
+// CHECK: constexpr call results cached, {{[1-9][0-9]*}} calls reused a result
+
+constexpr int fib(int n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+static_assert(fib(12) == 144, "");
+static_assert(fib(12) == 144, "");
+static_assert(fib(11) == 89, "");
+
+// Takes n + 4 steps; see constexpr-steps.cpp.
+constexpr bool steps(int n) {
+  for (int k = 0; k != n; ++k) {}
+  return true; // expected-note {{step limit}}
+}
+static_assert(steps(600), "");
+constexpr bool twice = steps(600) && steps(600); // expected-error {{constant expression}} expected-note {{in call to 'steps(600)'}}
+
+constexpr int depth(int n) { return n > 1 ? depth(n - 1) : 0; } // expected-note {{exceeded maximum depth}} expected-note +{{}}
+static_assert(depth(10) == 0, "");
+constexpr int nested(int n) { return n ? nested(n - 1) : depth(10); } // expected-note +{{}}
+constexpr int tooDeep = nested(5); // expected-error {{constant expression}} expected-note {{in call to 'nested(5)'}}
+
+struct Pair { int x, y; };
+constexpr int sum(Pair p) { return p.x + p.y; }
+static_assert(sum({1, 2}) == 3 && sum({1, 2}) == 3 && sum({2, 3}) == 5, "");
+
+union U { int i; float f; };
+constexpr int get(U u) { return u.i; }
+static_assert(get(U{1}) == 1 && get(U{2}) == 2 && get(U{1}) == 1, "");
+
+// Calls taking pointers are never reused, since what they point to may
+// change between calls.
+constexpr int deref(const int *p) { return *p; }
+constexpr int one = 1, two = 2;
+static_assert(deref(&one) == 1 && deref(&two) == 2, "");
+
+constexpr int bump(int *p) { return ++*p; }
+constexpr int bumpTwice() {
+  int n = 0;
+  bump(&n);
+  return bump(&n);
+}
+static_assert(bumpTwice() == 2, "");
@@ -0,0 +1,60 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -DNO_ERRORS -print-stats %s 2>&1 \
+// RUN:     | FileCheck %s
+
+// Candidates are rejected without computing conversion sequences when the
+// kinds of the argument and parameter types show that there is none, but
+// they are diagnosed as before.
+
+// CHECK: overload candidates examined, {{[1-9][0-9]*}} viable, {{[1-9][0-9]*}} rejected without computing conversions
+
+struct S {};
+struct U {};
+struct WithConversion { operator int(); };
+
+struct Stream {
+  Stream &operator<<(bool); // expected-note {{no known conversion from 'U' to 'bool' for 1st argument}}
+  Stream &operator<<(int); // expected-note {{no known conversion from 'U' to 'int' for 1st argument}}
+  Stream &operator<<(double); // expected-note {{no known conversion from 'U' to 'double' for 1st argument}}
+  Stream &operator<<(const void *); // expected-note {{no known conversion from 'U' to 'const void *' for 1st argument}}
+};
+Stream &operator<<(Stream &, const S &); // expected-note {{no known conversion from 'U' to 'const S' for 2nd argument}}
+Stream &operator<<(Stream &, const char *); // expected-note {{no known conversion from 'U' to 'const char *' for 2nd argument}}
+
+void stream(Stream &OS, S s, U u, WithConversion w, const char *str) {
+  OS << s << w << str << 1 << 1.0 << true << &s;
+#ifndef NO_ERRORS
+  OS << u; // expected-error {{invalid operands to binary expression ('Stream' and 'U')}}
+#endif
+}
+
+void takesInt(int); // expected-note {{no known conversion from 'int *' to 'int' for 1st argument}}
+void takesInt(int, int); // expected-note {{requires 2 arguments, but 1 was provided}}
+void takesPtr(char *); // expected-note {{no known conversion from 'int' to 'char *' for 1st argument}}
+void takesPtr(char *, int); // expected-note {{requires 2 arguments, but 1 was provided}}
+
+void scalars(int *p) {
+  takesPtr(0);
+  takesPtr(nullptr);
+#ifndef NO_ERRORS
+  takesInt(p); // expected-error {{no matching function for call to 'takesInt'}}
+  takesPtr(1); // expected-error {{no matching function for call to 'takesPtr'}}
+#endif
+}
+
+// The argument's class may be incomplete, or a specialization that is only
+// instantiated while its conversions are computed.
+struct Incomplete;
+Incomplete &getIncomplete();
+void takesIncomplete(int);
+void takesIncomplete(Incomplete &);
+
+template <typename T> struct Uninstantiated { operator T(); };
+Uninstantiated<int> &getUninstantiated();
+void takesLong(long);
+void takesLong(const char *);
+
+void incomplete() {
+  takesIncomplete(getIncomplete());
+  takesLong(getUninstantiated());
+}
@@ -0,0 +1,27 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo '[{"directory":".","command":"clang++ -c %t/test.cpp","file":"%t/test.cpp"}]' | sed -e 's/\\/\//g' > %t/compile_commands.json
+// RUN: cp "%s" "%t/test.cpp"
+// RUN: clang-bench -p "%t" "%t/test.cpp" -iterations=2 -o %t/parse.json
+// RUN: FileCheck -check-prefix=PARSE %s < %t/parse.json
+// RUN: clang-bench -p "%t" "%t/test.cpp" -action=lex -iterations=1 | FileCheck -check-prefix=LEX %s
+// RUN: clang-bench -p "%t" "%t/test.cpp" -action=emit-llvm -iterations=1 | FileCheck -check-prefix=CODEGEN %s
+
+// PARSE: "action": "syntax-only",
+// PARSE: "iterations": 2,
+// PARSE: "file": "{{.*}}test.cpp",
+// PARSE: "success": true,
+// PARSE-NEXT: "phases": {"setup": {{[0-9.]+}}, "parse": {{[0-9.]+}}, "teardown": {{[0-9.]+}}},
+// PARSE-NEXT: "memory": {"ast": {{[1-9][0-9]*}}, "ast-side-tables": {{[0-9]+}}, "source-manager-content-caches": {{[1-9][0-9]*}}
+// PARSE: "success": true,
+// PARSE-NOT: "success"
+
+// LEX: "action": "lex",
+// LEX: "phases": {"setup": {{[0-9.]+}}, "lex": {{[0-9.]+}}, "teardown": {{[0-9.]+}}},
+// LEX-NEXT: "memory": {"source-manager-content-caches":
+
+// CODEGEN: "action": "emit-llvm",
+// CODEGEN: "phases": {"setup": {{[0-9.]+}}, "parse": {{[0-9.]+}}, "codegen": {{[0-9.]+}}, "teardown": {{[0-9.]+}}},
+
+template <typename T> T twice(T t) { return t + t; }
+int f() { return twice(21); }
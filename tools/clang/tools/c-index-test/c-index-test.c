@@ -2064,6 +2064,9 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   CXTranslationUnit TU;
   unsigned I, Repeats = 1;
   unsigned completionOptions = clang_defaultCodeCompleteOptions();
+  const char *filterPrefix = getenv("CINDEXTEST_COMPLETION_FILTER");
+  const char *maxResultsEnv = getenv("CINDEXTEST_COMPLETION_MAX_RESULTS");
+  unsigned maxResults = maxResultsEnv ? (unsigned)atoi(maxResultsEnv) : 0;
   
   if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
@@ -2108,9 +2111,15 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   }
 
   for (I = 0; I != Repeats; ++I) {
-    results = clang_codeCompleteAt(TU, filename, line, column,
-                                   unsaved_files, num_unsaved_files,
-                                   completionOptions);
+    if (filterPrefix || maxResults)
+      results = clang_codeCompleteAtWithFilter(TU, filename, line, column,
+                                               unsaved_files, num_unsaved_files,
+                                               completionOptions, filterPrefix,
+                                               maxResults);
+    else
+      results = clang_codeCompleteAt(TU, filename, line, column,
+                                     unsaved_files, num_unsaved_files,
+                                     completionOptions);
     if (!results) {
       fprintf(stderr, "Unable to perform code completion!\n");
       return 1;
@@ -3335,8 +3344,17 @@ static int index_compile_db(int argc, const char **argv) {
           args[a] = clang_getCString(cxargs[a]);
         }
 
-        errorCode = index_compile_args(numArgs, args, idxAction,
-                                       /*importedASTs=*/0, check_prefix);
+        if (getenv("CINDEXTEST_ACTION_PER_COMMAND")) {
+          /* Index each command with its own action, as a multi-threaded
+             indexer would, sharing the session of the first one. */
+          CXIndexAction cmdAction =
+              clang_IndexAction_createInSession(Idx, idxAction);
+          errorCode = index_compile_args(numArgs, args, cmdAction,
+                                         /*importedASTs=*/0, check_prefix);
+          clang_IndexAction_dispose(cmdAction);
+        } else
+          errorCode = index_compile_args(numArgs, args, idxAction,
+                                         /*importedASTs=*/0, check_prefix);
 
         for (a=0; a<numArgs; ++a)
           clang_disposeString(cxargs[a]);
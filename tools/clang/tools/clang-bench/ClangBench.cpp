@@ -0,0 +1,522 @@
+//===--- tools/clang-bench/ClangBench.cpp - Clang benchmark tool ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements a clang-bench tool that repeatedly runs a frontend
+//  action over the files of a compilation database and reports, for every
+//  run, the wall time spent in each phase of the frontend together with the
+//  memory held by the ASTContext, the SourceManager and the Preprocessor.
+//  The results are written as JSON so that they can be compared across
+//  builds.
+//
+//  This tool uses the Clang Tooling infrastructure, see
+//    http://clang.llvm.org/docs/HowToSetupToolingForLLVM.html
+//  for details on setting it up with LLVM source tree.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/CodeGen/CodeGenAction.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/MultiplexConsumer.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+static cl::extrahelp CommonHelp(CommonOptionsParser::HelpMessage);
+static cl::extrahelp MoreHelp(
+    "\tFor example, to time parsing and semantic analysis of every file in a\n"
+    "\tsubtree of the source tree five times, use:\n"
+    "\n"
+    "\t  find path/in/subtree -name '*.cpp'|xargs clang-bench -p build/path \\\n"
+    "\t    -action=syntax-only -iterations=5 -o results.json\n"
+    "\n"
+);
+
+namespace {
+enum BenchAction {
+  BA_Lex,
+  BA_Preprocess,
+  BA_SyntaxOnly,
+  BA_EmitPCH,
+  BA_EmitLLVM,
+  BA_EmitObj
+};
+}
+
+static cl::OptionCategory ClangBenchCategory("clang-bench options");
+static cl::opt<BenchAction> Action(
+    "action", cl::desc("Frontend action to measure:"),
+    cl::init(BA_SyntaxOnly),
+    cl::values(clEnumValN(BA_Lex, "lex", "Raw-lex the main file"),
+               clEnumValN(BA_Preprocess, "preprocess",
+                          "Preprocess without producing output"),
+               clEnumValN(BA_SyntaxOnly, "syntax-only",
+                          "Parse and perform semantic analysis"),
+               clEnumValN(BA_EmitPCH, "emit-pch",
+                          "Parse and serialize a precompiled header"),
+               clEnumValN(BA_EmitLLVM, "emit-llvm",
+                          "Parse and generate LLVM IR in memory"),
+               clEnumValN(BA_EmitObj, "emit-obj",
+                          "Parse, generate code and write an object file"),
+               clEnumValEnd),
+    cl::cat(ClangBenchCategory));
+static cl::opt<unsigned>
+Iterations("iterations", cl::desc("Number of times to run each file"),
+           cl::init(3), cl::cat(ClangBenchCategory));
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Write the JSON results to <file> "
+                             "(default: standard output)"),
+               cl::value_desc("file"), cl::init("-"),
+               cl::cat(ClangBenchCategory));
+
+static const char *getActionName(BenchAction A) {
+  switch (A) {
+  case BA_Lex:
+    return "lex";
+  case BA_Preprocess:
+    return "preprocess";
+  case BA_SyntaxOnly:
+    return "syntax-only";
+  case BA_EmitPCH:
+    return "emit-pch";
+  case BA_EmitLLVM:
+    return "emit-llvm";
+  case BA_EmitObj:
+    return "emit-obj";
+  }
+  llvm_unreachable("invalid action");
+}
+
+/// \brief Returns the name of the phase that covers the action's own
+/// ExecuteAction(), excluding any time spent in the AST consumer.
+static const char *getExecutePhaseName(BenchAction A) {
+  switch (A) {
+  case BA_Lex:
+    return "lex";
+  case BA_Preprocess:
+    return "preprocess";
+  case BA_SyntaxOnly:
+  case BA_EmitPCH:
+  case BA_EmitLLVM:
+  case BA_EmitObj:
+    return "parse";
+  }
+  llvm_unreachable("invalid action");
+}
+
+/// \brief Returns the name of the phase that covers the action's AST
+/// consumer, or null if the action does no work in its consumer.
+static const char *getConsumerPhaseName(BenchAction A) {
+  switch (A) {
+  case BA_Lex:
+  case BA_Preprocess:
+  case BA_SyntaxOnly:
+    return nullptr;
+  case BA_EmitPCH:
+    return "serialize";
+  case BA_EmitLLVM:
+  case BA_EmitObj:
+    return "codegen";
+  }
+  llvm_unreachable("invalid action");
+}
+
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+namespace {
+
+/// \brief The measurements taken for a single run of the action over one
+/// translation unit.
+struct BenchRun {
+  bool Success = false;
+  double SetupTime = 0;
+  double ExecuteTime = 0;
+  double ConsumerTime = 0;
+  double TeardownTime = 0;
+
+  bool HasAST = false;
+  size_t ASTAllocated = 0;
+  size_t ASTSideTables = 0;
+  size_t ContentCaches = 0;
+  size_t SourceManagerDataStructures = 0;
+  size_t MallocBuffers = 0;
+  size_t MMapBuffers = 0;
+  size_t PreprocessorMemory = 0;
+};
+
+struct BenchResult {
+  std::string File;
+  std::vector<BenchRun> Runs;
+};
+
+/// \brief Forwards to the action's own AST consumer, accumulating the wall
+/// time spent inside it.
+///
+/// Only the outermost callback is timed, since consumers may re-enter
+/// themselves (for instance through deserialization).
+class TimingConsumer : public MultiplexConsumer {
+  double &Time;
+  unsigned Depth = 0;
+
+  template <typename Fn> void timed(Fn F) {
+    if (Depth++) {
+      F();
+      --Depth;
+      return;
+    }
+    TimeRecord Start = TimeRecord::getCurrentTime(/*Start=*/true);
+    F();
+    Time += TimeRecord::getCurrentTime(/*Start=*/false).getWallTime() -
+            Start.getWallTime();
+    --Depth;
+  }
+
+  static std::vector<std::unique_ptr<ASTConsumer>>
+  single(std::unique_ptr<ASTConsumer> C) {
+    std::vector<std::unique_ptr<ASTConsumer>> Consumers;
+    Consumers.push_back(std::move(C));
+    return Consumers;
+  }
+
+public:
+  TimingConsumer(std::unique_ptr<ASTConsumer> C, double &Time)
+      : MultiplexConsumer(single(std::move(C))), Time(Time) {}
+
+  bool HandleTopLevelDecl(DeclGroupRef D) override {
+    bool Continue = true;
+    timed([&] { Continue = MultiplexConsumer::HandleTopLevelDecl(D); });
+    return Continue;
+  }
+  void HandleInlineMethodDefinition(CXXMethodDecl *D) override {
+    timed([&] { MultiplexConsumer::HandleInlineMethodDefinition(D); });
+  }
+  void HandleInterestingDecl(DeclGroupRef D) override {
+    timed([&] { MultiplexConsumer::HandleInterestingDecl(D); });
+  }
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    timed([&] { MultiplexConsumer::HandleTranslationUnit(Ctx); });
+  }
+  void HandleTagDeclDefinition(TagDecl *D) override {
+    timed([&] { MultiplexConsumer::HandleTagDeclDefinition(D); });
+  }
+  void HandleCXXImplicitFunctionInstantiation(FunctionDecl *D) override {
+    timed([&] {
+      MultiplexConsumer::HandleCXXImplicitFunctionInstantiation(D);
+    });
+  }
+  void HandleTopLevelDeclInObjCContainer(DeclGroupRef D) override {
+    timed([&] { MultiplexConsumer::HandleTopLevelDeclInObjCContainer(D); });
+  }
+  void CompleteTentativeDefinition(VarDecl *D) override {
+    timed([&] { MultiplexConsumer::CompleteTentativeDefinition(D); });
+  }
+  void HandleCXXStaticMemberVarInstantiation(VarDecl *D) override {
+    timed([&] {
+      MultiplexConsumer::HandleCXXStaticMemberVarInstantiation(D);
+    });
+  }
+  void HandleVTable(CXXRecordDecl *RD) override {
+    timed([&] { MultiplexConsumer::HandleVTable(RD); });
+  }
+};
+
+/// \brief Lexes the main file in raw mode without producing any output.
+class RawLexAction : public PreprocessorFrontendAction {
+protected:
+  void ExecuteAction() override {
+    Preprocessor &PP = getCompilerInstance().getPreprocessor();
+    SourceManager &SM = PP.getSourceManager();
+
+    const llvm::MemoryBuffer *FromFile = SM.getBuffer(SM.getMainFileID());
+    Lexer RawLex(SM.getMainFileID(), FromFile, SM, PP.getLangOpts());
+    Token RawTok;
+    do
+      RawLex.LexFromRawLexer(RawTok);
+    while (RawTok.isNot(tok::eof));
+  }
+};
+
+/// \brief Wraps the measured action, recording when it starts executing,
+/// the time its AST consumer takes, and the memory in use once it is done.
+class MeasuringAction : public WrapperFrontendAction {
+  BenchRun &Run;
+  TimeRecord &ExecuteStart;
+  TimeRecord &ExecuteEnd;
+
+protected:
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
+                                                 StringRef InFile) override {
+    std::unique_ptr<ASTConsumer> C =
+        WrapperFrontendAction::CreateASTConsumer(CI, InFile);
+    if (!C)
+      return nullptr;
+    return llvm::make_unique<TimingConsumer>(std::move(C), Run.ConsumerTime);
+  }
+
+  void ExecuteAction() override {
+    ExecuteStart = TimeRecord::getCurrentTime(/*Start=*/true);
+    WrapperFrontendAction::ExecuteAction();
+    ExecuteEnd = TimeRecord::getCurrentTime(/*Start=*/false);
+
+    CompilerInstance &CI = getCompilerInstance();
+    if (CI.hasASTContext()) {
+      Run.HasAST = true;
+      Run.ASTAllocated = CI.getASTContext().getASTAllocatedMemory();
+      Run.ASTSideTables = CI.getASTContext().getSideTableAllocatedMemory();
+    }
+    if (CI.hasSourceManager()) {
+      SourceManager &SM = CI.getSourceManager();
+      Run.ContentCaches = SM.getContentCacheSize();
+      Run.SourceManagerDataStructures = SM.getDataStructureSizes();
+      SourceManager::MemoryBufferSizes Buffers = SM.getMemoryBufferSizes();
+      Run.MallocBuffers = Buffers.malloc_bytes;
+      Run.MMapBuffers = Buffers.mmap_bytes;
+    }
+    if (CI.hasPreprocessor())
+      Run.PreprocessorMemory = CI.getPreprocessor().getTotalMemory();
+  }
+
+public:
+  MeasuringAction(FrontendAction *WrappedAction, BenchRun &Run,
+                  TimeRecord &ExecuteStart, TimeRecord &ExecuteEnd)
+      : WrapperFrontendAction(WrappedAction), Run(Run),
+        ExecuteStart(ExecuteStart), ExecuteEnd(ExecuteEnd) {}
+};
+
+/// \brief Runs every invocation handed to it by the ClangTool -iterations
+/// times, each on a fresh CompilerInstance, and collects the measurements.
+class BenchActionFactory : public ToolAction {
+  std::string OutputFile;
+
+  FrontendAction *createAction() {
+    switch (Action) {
+    case BA_Lex:
+      return new RawLexAction;
+    case BA_Preprocess:
+      return new PreprocessOnlyAction;
+    case BA_SyntaxOnly:
+      return new SyntaxOnlyAction;
+    case BA_EmitPCH:
+      return new GeneratePCHAction;
+    case BA_EmitLLVM:
+      return new EmitLLVMOnlyAction;
+    case BA_EmitObj:
+      return new EmitObjAction;
+    }
+    llvm_unreachable("invalid action");
+  }
+
+  bool runOnce(CompilerInvocation &Invocation, FileManager *Files,
+               std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+               DiagnosticConsumer *DiagConsumer, BenchRun &Run) {
+    CompilerInstance Compiler(PCHContainerOps);
+    Compiler.setInvocation(new CompilerInvocation(Invocation));
+    Compiler.setFileManager(Files);
+    if (!OutputFile.empty())
+      Compiler.getFrontendOpts().OutputFile = OutputFile;
+
+    TimeRecord ExecuteStart, ExecuteEnd;
+    std::unique_ptr<FrontendAction> ScopedAction(
+        new MeasuringAction(createAction(), Run, ExecuteStart, ExecuteEnd));
+
+    // Only report diagnostics from the first run; the rest would repeat them.
+    if (DiagConsumer)
+      Compiler.createDiagnostics(DiagConsumer, /*ShouldOwnClient=*/false);
+    else
+      Compiler.createDiagnostics(new IgnoringDiagConsumer,
+                                 /*ShouldOwnClient=*/true);
+    if (!Compiler.hasDiagnostics())
+      return false;
+
+    Compiler.createSourceManager(*Files);
+
+    TimeRecord Start = TimeRecord::getCurrentTime(/*Start=*/true);
+    Run.Success = Compiler.ExecuteAction(*ScopedAction);
+    TimeRecord End = TimeRecord::getCurrentTime(/*Start=*/false);
+    Files->clearStatCaches();
+
+    if (ExecuteStart.getWallTime() == 0) {
+      // The action never got to execute; attribute everything to setup.
+      Run.SetupTime = End.getWallTime() - Start.getWallTime();
+      return Run.Success;
+    }
+    Run.SetupTime = ExecuteStart.getWallTime() - Start.getWallTime();
+    Run.ExecuteTime = ExecuteEnd.getWallTime() - ExecuteStart.getWallTime() -
+                      Run.ConsumerTime;
+    Run.TeardownTime = End.getWallTime() - ExecuteEnd.getWallTime();
+    return Run.Success;
+  }
+
+public:
+  std::vector<BenchResult> Results;
+
+  BenchActionFactory() {
+    // Actions that write an output file write it to a scratch file, so that
+    // benchmarking does not leave objects next to the sources.
+    if (Action == BA_EmitPCH || Action == BA_EmitObj) {
+      SmallString<128> Path;
+      if (!llvm::sys::fs::createTemporaryFile("clang-bench", "out", Path))
+        OutputFile = Path.str();
+    }
+  }
+
+  ~BenchActionFactory() override {
+    if (!OutputFile.empty())
+      llvm::sys::fs::remove(OutputFile);
+  }
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    IntrusiveRefCntPtr<CompilerInvocation> Owned(Invocation);
+
+    BenchResult Result;
+    const FrontendOptions &FEOpts = Invocation->getFrontendOpts();
+    if (!FEOpts.Inputs.empty())
+      Result.File = FEOpts.Inputs[0].getFile();
+
+    bool Success = true;
+    for (unsigned I = 0; I != Iterations; ++I) {
+      Result.Runs.emplace_back();
+      if (!runOnce(*Invocation, Files, PCHContainerOps,
+                   I == 0 ? DiagConsumer : nullptr, Result.Runs.back()))
+        Success = false;
+    }
+    Results.push_back(std::move(Result));
+    return Success;
+  }
+};
+
+} // namespace
+
+static void writePhase(raw_ostream &OS, const char *Name, double Time,
+                       bool &First) {
+  if (!First)
+    OS << ", ";
+  First = false;
+  writeJSONString(OS, Name);
+  OS << ": " << format("%.6f", Time);
+}
+
+static void writeResults(raw_ostream &OS, ArrayRef<BenchResult> Results) {
+  const char *ExecutePhase = getExecutePhaseName(Action);
+  const char *ConsumerPhase = getConsumerPhaseName(Action);
+
+  OS << "{\n";
+  OS << "  \"action\": ";
+  writeJSONString(OS, getActionName(Action));
+  OS << ",\n";
+  OS << "  \"iterations\": " << Iterations << ",\n";
+  OS << "  \"files\": [";
+  for (unsigned F = 0, NF = Results.size(); F != NF; ++F) {
+    const BenchResult &Result = Results[F];
+    OS << (F ? ",\n" : "\n") << "    {\n";
+    OS << "      \"file\": ";
+    writeJSONString(OS, Result.File);
+    OS << ",\n";
+    OS << "      \"runs\": [";
+    for (unsigned R = 0, NR = Result.Runs.size(); R != NR; ++R) {
+      const BenchRun &Run = Result.Runs[R];
+      OS << (R ? ",\n" : "\n") << "        {\n";
+      OS << "          \"success\": " << (Run.Success ? "true" : "false")
+         << ",\n";
+
+      // Wall times, in seconds.
+      OS << "          \"phases\": {";
+      bool First = true;
+      writePhase(OS, "setup", Run.SetupTime, First);
+      writePhase(OS, ExecutePhase, Run.ExecuteTime, First);
+      if (ConsumerPhase)
+        writePhase(OS, ConsumerPhase, Run.ConsumerTime, First);
+      writePhase(OS, "teardown", Run.TeardownTime, First);
+      OS << "},\n";
+
+      // Memory, in bytes.
+      OS << "          \"memory\": {";
+      if (Run.HasAST)
+        OS << "\"ast\": " << Run.ASTAllocated
+           << ", \"ast-side-tables\": " << Run.ASTSideTables << ", ";
+      OS << "\"source-manager-content-caches\": " << Run.ContentCaches
+         << ", \"source-manager-data-structures\": "
+         << Run.SourceManagerDataStructures
+         << ", \"source-manager-malloc-buffers\": " << Run.MallocBuffers
+         << ", \"source-manager-mmap-buffers\": " << Run.MMapBuffers
+         << ", \"preprocessor\": " << Run.PreprocessorMemory << "}\n";
+      OS << "        }";
+    }
+    OS << "\n      ]\n";
+    OS << "    }";
+  }
+  OS << "\n  ]\n";
+  OS << "}\n";
+}
+
+int main(int argc, const char **argv) {
+  llvm::sys::PrintStackTraceOnErrorSignal();
+
+  // Initialize targets for code generation and clang module support.
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  CommonOptionsParser OptionsParser(argc, argv, ClangBenchCategory);
+  ClangTool Tool(OptionsParser.getCompilations(),
+                 OptionsParser.getSourcePathList());
+
+  // Clear adjusters because -fsyntax-only is inserted by the default chain.
+  Tool.clearArgumentsAdjusters();
+  Tool.appendArgumentsAdjuster(getClangStripOutputAdjuster());
+
+  // The measured action is chosen by -action rather than by the command line,
+  // but actions that do not generate code can still skip the driver's
+  // code generation options.
+  if (!getConsumerPhaseName(Action))
+    Tool.appendArgumentsAdjuster(
+        getInsertArgumentAdjuster("-fsyntax-only",
+                                  ArgumentInsertPosition::BEGIN));
+
+  BenchActionFactory Factory;
+  int Status = Tool.run(&Factory);
+
+  std::error_code EC;
+  raw_fd_ostream OS(OutputFilename, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "clang-bench: cannot open '" << OutputFilename
+                 << "': " << EC.message() << "\n";
+    return 1;
+  }
+  writeResults(OS, Factory.Results);
+  return Status;
+}
@@ -19,12 +19,16 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
+#include "clang/Format/FormattingCache.h"
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Signals.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using namespace llvm;
 
@@ -91,6 +95,16 @@ static cl::opt<bool>
                cl::desc("Dump configuration options to stdout and exit.\n"
                         "Can be used with -style option."),
                cl::cat(ClangFormatCategory));
+static cl::opt<std::string>
+    CacheFile("cache",
+              cl::desc("Reuse the line breaks of earlier runs for unchanged\n"
+                       "lines, and save them to this file."),
+              cl::cat(ClangFormatCategory));
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("Number of files to format in parallel.\n"
+                        "0 means one per hardware thread."),
+               cl::init(1), cl::cat(ClangFormatCategory));
 static cl::opt<unsigned>
     Cursor("cursor",
            cl::desc("The position of the cursor when invoking\n"
@@ -149,6 +163,8 @@ static bool fillRanges(SourceManager &Sources, FileID ID,
     return false;
   }
 
+  // Files may be formatted in parallel, so leave the options unchanged.
+  std::vector<unsigned> Offsets(::Offsets.begin(), ::Offsets.end());
   if (Offsets.empty())
     Offsets.push_back(0);
   if (Offsets.size() != Lengths.size() &&
@@ -182,28 +198,30 @@ static bool fillRanges(SourceManager &Sources, FileID ID,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(StringRef Text, raw_ostream &OS) {
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r", From)) != StringRef::npos) {
-    llvm::outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      llvm::outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      llvm::outs() << "&#13;";
+      OS << "&#13;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  llvm::outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
+// Writes the formatted file, if not edited in place, to \p OS.
 // Returns true on error.
-static bool format(StringRef FileName) {
+static bool format(StringRef FileName, raw_ostream &OS,
+                   FormattingCache *Cache) {
   FileManager Files((FileSystemOptions()));
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
@@ -227,26 +245,26 @@ static bool format(StringRef FileName) {
       Style, (FileName == "-") ? AssumeFilename : FileName, FallbackStyle);
   bool IncompleteFormat = false;
   tooling::Replacements Replaces =
-      reformat(FormatStyle, Sources, ID, Ranges, &IncompleteFormat);
+      reformat(FormatStyle, Sources, ID, Ranges, &IncompleteFormat, Cache);
   if (OutputXML) {
-    llvm::outs() << "<?xml version='1.0'?>\n<replacements "
+    OS << "<?xml version='1.0'?>\n<replacements "
                     "xml:space='preserve' incomplete_format='"
                  << (IncompleteFormat ? "true" : "false") << "'>\n";
     if (Cursor.getNumOccurrences() != 0)
-      llvm::outs() << "<cursor>"
+      OS << "<cursor>"
                    << tooling::shiftedCodePosition(Replaces, Cursor)
                    << "</cursor>\n";
 
     for (tooling::Replacements::const_iterator I = Replaces.begin(),
                                                E = Replaces.end();
          I != E; ++I) {
-      llvm::outs() << "<replacement "
+      OS << "<replacement "
                    << "offset='" << I->getOffset() << "' "
                    << "length='" << I->getLength() << "'>";
-      outputReplacementXML(I->getReplacementText());
-      llvm::outs() << "</replacement>\n";
+      outputReplacementXML(I->getReplacementText(), OS);
+      OS << "</replacement>\n";
     }
-    llvm::outs() << "</replacements>\n";
+    OS << "</replacements>\n";
   } else {
     Rewriter Rewrite(Sources, LangOptions());
     tooling::applyAllReplacements(Replaces, Rewrite);
@@ -257,11 +275,11 @@ static bool format(StringRef FileName) {
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": "
+        OS << "{ \"Cursor\": "
                << tooling::shiftedCodePosition(Replaces, Cursor)
                << ", \"IncompleteFormat\": "
                << (IncompleteFormat ? "true" : "false") << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+      Rewrite.getEditBuffer(ID).write(OS);
     }
   }
   return false;
@@ -302,23 +320,65 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  std::unique_ptr<clang::format::FormattingCache> Cache;
+  if (!CacheFile.empty()) {
+    Cache.reset(new clang::format::FormattingCache());
+    if (!Cache->load(CacheFile))
+      llvm::errs() << "warning: cannot read cache file " << CacheFile << "\n";
+  }
+
   bool Error = false;
   switch (FileNames.size()) {
   case 0:
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", outs(), Cache.get());
     break;
   case 1:
-    Error = clang::format::format(FileNames[0]);
+    Error = clang::format::format(FileNames[0], outs(), Cache.get());
     break;
-  default:
+  default: {
     if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty()) {
       llvm::errs() << "error: -offset, -length and -lines can only be used for "
                       "single file.\n";
       return 1;
     }
-    for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
+
+    unsigned Threads = NumThreads;
+    if (Threads == 0)
+      Threads = std::max(1u, std::thread::hardware_concurrency());
+    Threads = std::min<size_t>(Threads, FileNames.size());
+
+    if (Threads == 1) {
+      for (unsigned i = 0; i < FileNames.size(); ++i)
+        Error |= clang::format::format(FileNames[i], outs(), Cache.get());
+      break;
+    }
+
+    // The output of each file is buffered and written in the order of the
+    // files once all of them are formatted.
+    std::vector<std::string> Outputs(FileNames.size());
+    std::vector<char> Failed(FileNames.size(), 0);
+    std::atomic<size_t> NextFile(0);
+    auto Worker = [&]() {
+      for (size_t I = NextFile++; I < FileNames.size(); I = NextFile++) {
+        raw_string_ostream OS(Outputs[I]);
+        Failed[I] = clang::format::format(FileNames[I], OS, Cache.get());
+      }
+    };
+    std::vector<std::thread> Workers;
+    for (unsigned i = 1; i < Threads; ++i)
+      Workers.emplace_back(Worker);
+    Worker();
+    for (std::thread &W : Workers)
+      W.join();
+    for (unsigned i = 0; i < FileNames.size(); ++i) {
+      outs() << Outputs[i];
+      Error |= Failed[i];
+    }
     break;
   }
+  }
+
+  if (Cache && !Cache->save(CacheFile))
+    llvm::errs() << "warning: cannot write cache file " << CacheFile << "\n";
   return Error ? 1 : 0;
 }
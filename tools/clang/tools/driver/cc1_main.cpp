@@ -28,6 +28,7 @@
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Signals.h"
@@ -42,6 +43,11 @@ using namespace llvm::opt;
 // Main driver
 //===----------------------------------------------------------------------===//
 
+/// Whether cc1_main is running in the driver's process, and the status a
+/// fatal error ended it with.
+static bool RunningInProcess = false;
+static int InProcessFatalStatus = 0;
+
 static void LLVMErrorHandler(void *UserData, const std::string &Message,
                              bool GenCrashDiag) {
   DiagnosticsEngine &Diags = *static_cast<DiagnosticsEngine*>(UserData);
@@ -55,7 +61,21 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
-  exit(GenCrashDiag ? 70 : 1);
+  int Status = GenCrashDiag ? 70 : 1;
+
+  // In the driver's process, abandon the compile and return the status to
+  // the driver instead of exiting it.  Threads started by the compile, such
+  // as those of backend partitions, run outside the recovery context and
+  // can only exit.
+  if (RunningInProcess) {
+    if (llvm::CrashRecoveryContext *CRC =
+            llvm::CrashRecoveryContext::GetCurrent()) {
+      InProcessFatalStatus = Status;
+      llvm::remove_fatal_error_handler();
+      CRC->HandleCrash();
+    }
+  }
+  exit(Status);
 }
 
 #ifdef LINK_POLLY_INTO_TOOLS
@@ -138,3 +158,24 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
 
   return !Success;
 }
+
+/// Runs cc1_main for a driver that embeds the compiler.  A crash returns -2,
+/// like a process killed by a signal, and a fatal error returns the status
+/// the compiler would have exited with; neither ends the driver.
+int cc1_main_in_process(ArrayRef<const char *> Argv, const char *Argv0,
+                        void *MainAddr) {
+  llvm::CrashRecoveryContext::Enable();
+  llvm::CrashRecoveryContext CRC;
+  RunningInProcess = true;
+  InProcessFatalStatus = 0;
+  int Res = 0;
+  bool Completed =
+      CRC.RunSafely([&]() { Res = cc1_main(Argv, Argv0, MainAddr); });
+  RunningInProcess = false;
+  if (Completed)
+    return Res;
+
+  // The error handler refers to the abandoned compiler's diagnostics.
+  llvm::remove_fatal_error_handler();
+  return InProcessFatalStatus ? InProcessFatalStatus : -2;
+}
@@ -198,6 +198,8 @@ static void ApplyQAOverride(SmallVectorImpl<const char*> &Args,
 
 extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
                     void *MainAddr);
+extern int cc1_main_in_process(ArrayRef<const char *> Argv, const char *Argv0,
+                               void *MainAddr);
 extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
 
@@ -364,6 +366,15 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
   return 1;
 }
 
+/// Runs a -cc1 job for the driver without starting a new process.
+static int ExecuteCC1InProcess(ArrayRef<const char *> argv) {
+  StringRef Tool = argv[1] + 4;
+  if (Tool != "")
+    return ExecuteCC1Tool(argv, Tool);
+  void *GetExecutablePathVP = (void *)(intptr_t) GetExecutablePath;
+  return cc1_main_in_process(argv.slice(2), argv[0], GetExecutablePathVP);
+}
+
 int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal();
   llvm::PrettyStackTraceProgram X(argc_, argv_);
@@ -448,6 +459,7 @@ int main(int argc_, const char **argv_) {
 
   Driver TheDriver(Path, llvm::sys::getDefaultTargetTriple(), Diags);
   SetInstallDir(argv, TheDriver);
+  TheDriver.CC1Main = ExecuteCC1InProcess;
 
   llvm::InitializeAllTargets();
   ParseProgName(argv, SavedStrings);
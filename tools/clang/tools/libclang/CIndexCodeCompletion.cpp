@@ -36,6 +36,7 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
 #include <cstdlib>
@@ -521,33 +522,75 @@ static unsigned long long getContextsForContextKind(
 }
 
 namespace {
+  /// \brief Orders code-completion results from the most to the least
+  /// likely, breaking ties by name.
+  bool isBetterResult(const CodeCompletionResult *X,
+                      const CodeCompletionResult *Y) {
+    if (X->Priority != Y->Priority)
+      return X->Priority < Y->Priority;
+    return *X < *Y;
+  }
+
   class CaptureCompletionResults : public CodeCompleteConsumer {
     AllocatedCXCodeCompleteResults &AllocatedResults;
     CodeCompletionTUInfo CCTUInfo;
     SmallVector<CXCompletionResult, 16> StoredResults;
     CXTranslationUnit *TU;
+
+    /// \brief If non-empty, only results whose name starts with this prefix,
+    /// ignoring case, are captured.
+    std::string Prefix;
+
+    /// \brief If non-zero, the maximum number of results to capture.
+    unsigned MaxResults;
   public:
     CaptureCompletionResults(const CodeCompleteOptions &Opts,
                              AllocatedCXCodeCompleteResults &Results,
-                             CXTranslationUnit *TranslationUnit)
+                             CXTranslationUnit *TranslationUnit,
+                             StringRef Prefix = StringRef(),
+                             unsigned MaxResults = 0)
       : CodeCompleteConsumer(Opts, false), 
         AllocatedResults(Results), CCTUInfo(Results.CodeCompletionAllocator),
-        TU(TranslationUnit) { }
+        TU(TranslationUnit), Prefix(Prefix), MaxResults(MaxResults) { }
     ~CaptureCompletionResults() override { Finish(); }
 
+    bool isResultFilteredOut(const CodeCompletionResult &Result) override {
+      if (Prefix.empty())
+        return false;
+      std::string Saved;
+      return !Result.getOrderedName(Saved).startswith_lower(Prefix);
+    }
+
     void ProcessCodeCompleteResults(Sema &S, 
                                     CodeCompletionContext Context,
                                     CodeCompletionResult *Results,
                                     unsigned NumResults) override {
-      StoredResults.reserve(StoredResults.size() + NumResults);
-      for (unsigned I = 0; I != NumResults; ++I) {
+      // Sema already dropped most of the results that do not match the
+      // prefix; drop the rest, then keep only the best results if there are
+      // too many.  Completion strings are built for the survivors only.
+      SmallVector<CodeCompletionResult *, 16> Kept;
+      for (unsigned I = 0; I != NumResults; ++I)
+        if (!isResultFilteredOut(Results[I]))
+          Kept.push_back(&Results[I]);
+      if (MaxResults) {
+        unsigned Room = MaxResults > StoredResults.size()
+                            ? MaxResults - StoredResults.size() : 0;
+        if (Kept.size() > Room) {
+          std::partial_sort(Kept.begin(), Kept.begin() + Room, Kept.end(),
+                            isBetterResult);
+          Kept.resize(Room);
+        }
+      }
+
+      StoredResults.reserve(StoredResults.size() + Kept.size());
+      for (CodeCompletionResult *Result : Kept) {
         CodeCompletionString *StoredCompletion        
-          = Results[I].CreateCodeCompletionString(S, Context, getAllocator(),
-                                                  getCodeCompletionTUInfo(),
-                                                  includeBriefComments());
+          = Result->CreateCodeCompletionString(S, Context, getAllocator(),
+                                               getCodeCompletionTUInfo(),
+                                               includeBriefComments());
         
         CXCompletionResult R;
-        R.CursorKind = Results[I].CursorKind;
+        R.CursorKind = Result->CursorKind;
         R.CompletionString = StoredCompletion;
         StoredResults.push_back(R);
       }
@@ -654,6 +697,8 @@ struct CodeCompleteAtInfo {
   unsigned complete_column;
   ArrayRef<CXUnsavedFile> unsaved_files;
   unsigned options;
+  const char *filter_prefix;
+  unsigned max_results;
   CXCodeCompleteResults *result;
 };
 static void clang_codeCompleteAt_Impl(void *UserData) {
@@ -711,7 +756,10 @@ static void clang_codeCompleteAt_Impl(void *UserData) {
   // Create a code-completion consumer to capture the results.
   CodeCompleteOptions Opts;
   Opts.IncludeBriefComments = IncludeBriefComments;
-  CaptureCompletionResults Capture(Opts, *Results, &TU);
+  CaptureCompletionResults Capture(Opts, *Results, &TU,
+                                   CCAI->filter_prefix ? CCAI->filter_prefix
+                                                       : "",
+                                   CCAI->max_results);
 
   // Perform completion.
   AST->CodeComplete(complete_filename, complete_line, complete_column,
@@ -813,9 +861,28 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             struct CXUnsavedFile *unsaved_files,
                                             unsigned num_unsaved_files,
                                             unsigned options) {
+  return clang_codeCompleteAtWithFilter(TU, complete_filename, complete_line,
+                                        complete_column, unsaved_files,
+                                        num_unsaved_files, options, nullptr, 0);
+}
+
+CXCodeCompleteResults *
+clang_codeCompleteAtWithFilter(CXTranslationUnit TU,
+                               const char *complete_filename,
+                               unsigned complete_line,
+                               unsigned complete_column,
+                               struct CXUnsavedFile *unsaved_files,
+                               unsigned num_unsaved_files,
+                               unsigned options,
+                               const char *filter_prefix,
+                               unsigned max_results) {
   LOG_FUNC_SECTION {
     *Log << TU << ' '
          << complete_filename << ':' << complete_line << ':' << complete_column;
+    if (filter_prefix)
+      *Log << " prefix=" << filter_prefix;
+    if (max_results)
+      *Log << " max=" << max_results;
   }
 
   if (num_unsaved_files && !unsaved_files)
@@ -823,7 +890,7 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
 
   CodeCompleteAtInfo CCAI = {TU, complete_filename, complete_line,
     complete_column, llvm::makeArrayRef(unsaved_files, num_unsaved_files),
-    options, nullptr};
+    options, filter_prefix, max_results, nullptr};
 
   if (getenv("LIBCLANG_NOTHREADS")) {
     clang_codeCompleteAt_Impl(&CCAI);
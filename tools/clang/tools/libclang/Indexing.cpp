@@ -29,9 +29,9 @@
 #include "clang/Sema/SemaConsumer.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/Mutex.h"
-#include "llvm/Support/MutexGuard.h"
+#include <atomic>
 #include <cstdio>
+#include <memory>
 
 using namespace clang;
 using namespace cxtu;
@@ -109,8 +109,6 @@ public:
   }
 };
 
-typedef llvm::DenseSet<PPRegion> PPRegionSetTy;
-
 } // end anonymous namespace
 
 namespace llvm {
@@ -145,24 +143,77 @@ namespace llvm {
 
 namespace {
 
+/// \brief The regions whose function bodies were indexed in an indexing
+/// session.
+///
+/// The set is shared by all the indexing actions of the session, which may
+/// index on different threads.  Regions are only ever added, so lookups walk
+/// the buckets without taking a lock, and a new region is linked into its
+/// bucket with a compare-and-swap.
 class SessionSkipBodyData {
-  llvm::sys::Mutex Mux;
-  PPRegionSetTy ParsedRegions;
+  struct Entry {
+    PPRegion Region;
+    Entry *Next;
+  };
+
+  static const unsigned NumBuckets = 1 << 14;
+  std::atomic<Entry *> Buckets[NumBuckets];
+
+  std::atomic<Entry *> &getBucket(const PPRegion &Region) {
+    unsigned Hash = llvm::DenseMapInfo<PPRegion>::getHashValue(Region);
+    return Buckets[Hash % NumBuckets];
+  }
 
 public:
-  SessionSkipBodyData() : Mux(/*recursive=*/false) {}
+  SessionSkipBodyData() {
+    for (std::atomic<Entry *> &Bucket : Buckets)
+      Bucket.store(nullptr, std::memory_order_relaxed);
+  }
   ~SessionSkipBodyData() {
-    //llvm::errs() << "RegionData: " << Skipped.size() << " - " << Skipped.getMemorySize() << "\n";
+    for (std::atomic<Entry *> &Bucket : Buckets) {
+      Entry *E = Bucket.load(std::memory_order_relaxed);
+      while (E) {
+        Entry *Next = E->Next;
+        delete E;
+        E = Next;
+      }
+    }
   }
 
-  void copyTo(PPRegionSetTy &Set) {
-    llvm::MutexGuard MG(Mux);
-    Set = ParsedRegions;
+  bool contains(const PPRegion &Region) {
+    for (Entry *E = getBucket(Region).load(std::memory_order_acquire); E;
+         E = E->Next)
+      if (E->Region == Region)
+        return true;
+    return false;
   }
 
   void update(ArrayRef<PPRegion> Regions) {
-    llvm::MutexGuard MG(Mux);
-    ParsedRegions.insert(Regions.begin(), Regions.end());
+    for (const PPRegion &Region : Regions)
+      insert(Region);
+  }
+
+private:
+  void insert(const PPRegion &Region) {
+    std::atomic<Entry *> &Bucket = getBucket(Region);
+    Entry *Head = Bucket.load(std::memory_order_acquire);
+    std::unique_ptr<Entry> New;
+    while (true) {
+      for (Entry *E = Head; E; E = E->Next)
+        if (E->Region == Region)
+          return;
+      if (!New)
+        New.reset(new Entry{Region, nullptr});
+      New->Next = Head;
+      // On failure Head is reloaded; look for the region again, since
+      // another thread may just have added it.
+      if (Bucket.compare_exchange_weak(Head, New.get(),
+                                       std::memory_order_release,
+                                       std::memory_order_acquire)) {
+        New.release();
+        return;
+      }
+    }
   }
 };
 
@@ -171,7 +222,6 @@ class TUSkipBodyControl {
   PPConditionalDirectiveRecord &PPRec;
   Preprocessor &PP;
 
-  PPRegionSetTy ParsedRegions;
   SmallVector<PPRegion, 32> NewParsedRegions;
   PPRegion LastRegion;
   bool LastIsParsed;
@@ -180,9 +230,7 @@ public:
   TUSkipBodyControl(SessionSkipBodyData &sessionData,
                     PPConditionalDirectiveRecord &ppRec,
                     Preprocessor &pp)
-    : SessionData(sessionData), PPRec(ppRec), PP(pp) {
-    SessionData.copyTo(ParsedRegions);
-  }
+    : SessionData(sessionData), PPRec(ppRec), PP(pp) { }
 
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
     PPRegion region = getRegion(Loc, FID, FE);
@@ -193,8 +241,10 @@ public:
     if (LastRegion == region)
       return LastIsParsed;
 
+    // Regions are published when the translation unit is finished, so a
+    // region that another thread is still indexing is indexed here too.
     LastRegion = region;
-    LastIsParsed = ParsedRegions.count(region);
+    LastIsParsed = SessionData.contains(region);
     if (!LastIsParsed)
       NewParsedRegions.push_back(region);
     return LastIsParsed;
@@ -456,10 +506,13 @@ public:
 
 struct IndexSessionData {
   CXIndex CIdx;
-  std::unique_ptr<SessionSkipBodyData> SkipBodyData;
+  std::shared_ptr<SessionSkipBodyData> SkipBodyData;
 
   explicit IndexSessionData(CXIndex cIdx)
-    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
+    : CIdx(cIdx), SkipBodyData(std::make_shared<SessionSkipBodyData>()) {}
+  IndexSessionData(CXIndex cIdx,
+                   std::shared_ptr<SessionSkipBodyData> skipBodyData)
+    : CIdx(cIdx), SkipBodyData(std::move(skipBodyData)) {}
 };
 
 struct IndexSourceFileInfo {
@@ -942,6 +995,14 @@ CXIndexAction clang_IndexAction_create(CXIndex CIdx) {
   return new IndexSessionData(CIdx);
 }
 
+CXIndexAction clang_IndexAction_createInSession(CXIndex CIdx,
+                                                CXIndexAction session) {
+  if (!session)
+    return clang_IndexAction_create(CIdx);
+  return new IndexSessionData(
+      CIdx, static_cast<IndexSessionData *>(session)->SkipBodyData);
+}
+
 void clang_IndexAction_dispose(CXIndexAction idxAction) {
   if (idxAction)
     delete static_cast<IndexSessionData *>(idxAction);
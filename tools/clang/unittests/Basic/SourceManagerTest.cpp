@@ -170,6 +170,40 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineNumber) {
+  // Lines of many lengths, so that line endings fall at every position of
+  // the chunks the line table is built from, with every kind of line ending
+  // and the odd embedded null.
+  const char *const Endings[] = { "\n", "\r\n", "\r", "\n\r" };
+  std::string Source;
+  std::vector<unsigned> LineStarts;
+  for (unsigned I = 0; I != 300; ++I) {
+    LineStarts.push_back(Source.size());
+    Source.append(I % 71, 'x');
+    if (I % 13 == 0)
+      Source += '\0';
+    Source += Endings[I % 4];
+  }
+  LineStarts.push_back(Source.size());
+  Source += "int x;";
+
+  std::unique_ptr<MemoryBuffer> Buf = MemoryBuffer::getMemBufferCopy(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+
+  for (unsigned Line = 0; Line != LineStarts.size(); ++Line) {
+    bool Invalid = false;
+    EXPECT_EQ(Line + 1,
+              SourceMgr.getLineNumber(MainFileID, LineStarts[Line], &Invalid));
+    EXPECT_TRUE(!Invalid);
+    if (Line + 1 != LineStarts.size())
+      EXPECT_EQ(Line + 1, SourceMgr.getLineNumber(
+                              MainFileID, LineStarts[Line + 1] - 1, &Invalid));
+  }
+  EXPECT_EQ(LineStarts.size(),
+            SourceMgr.getLineNumber(MainFileID, Source.size(), nullptr));
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
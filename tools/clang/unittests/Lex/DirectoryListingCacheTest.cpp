@@ -0,0 +1,56 @@
+//===- unittests/Lex/DirectoryListingCacheTest.cpp - listing cache tests --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DirectoryListingCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+TEST(DirectoryListingCacheTest, ListsDirectoryContents) {
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("listing-test", Dir));
+  SmallString<128> Header(Dir);
+  llvm::sys::path::append(Header, "Header.h");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Header, EC, llvm::sys::fs::F_None);
+    ASSERT_FALSE(EC);
+  }
+
+  IntrusiveRefCntPtr<DirectoryListingCache> Cache = new DirectoryListingCache;
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = vfs::getRealFileSystem();
+  std::shared_ptr<const DirectoryListingCache::Listing> Listing =
+      Cache->getListing(*FS, Dir);
+  EXPECT_EQ(DirectoryListingCache::Listing::LK_Listed, Listing->Kind);
+  EXPECT_TRUE(Listing->mayContain("Header.h"));
+  EXPECT_TRUE(Listing->mayContain("header.h"));
+  EXPECT_FALSE(Listing->mayContain("Other.h"));
+
+  SmallString<128> Missing(Dir);
+  llvm::sys::path::append(Missing, "missing");
+  Listing = Cache->getListing(*FS, Missing);
+  EXPECT_EQ(DirectoryListingCache::Listing::LK_Missing, Listing->Kind);
+  EXPECT_FALSE(Listing->mayContain("Header.h"));
+
+  // A file has no entries.
+  Listing = Cache->getListing(*FS, Header);
+  EXPECT_FALSE(Listing->mayContain("Header.h"));
+
+  llvm::sys::fs::remove(Header);
+  llvm::sys::fs::remove(Dir);
+}
+
+} // end anonymous namespace
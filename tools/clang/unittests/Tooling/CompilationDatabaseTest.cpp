@@ -14,7 +14,10 @@
 #include "clang/Tooling/FileMatchTrie.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -112,6 +115,117 @@ TEST(JSONCompilationDatabase, GetAllCompileCommands) {
   EXPECT_EQ(Command2, Commands[1].CommandLine[0]) << ErrorMessage;
 }
 
+static void writeFile(StringRef Path, StringRef Contents) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+  ASSERT_FALSE(EC);
+  OS << Contents;
+}
+
+static std::string readFile(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return std::string();
+  return (*Buffer)->getBuffer().str();
+}
+
+TEST(JSONCompilationDatabase, LoadsFromIndex) {
+  SmallString<128> TestDir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("json-database-test", TestDir));
+  SmallString<128> DatabasePath(TestDir);
+  llvm::sys::path::append(DatabasePath, "compile_commands.json");
+  writeFile(DatabasePath, "[{\"directory\":\"//net/dir\","
+                          "\"command\":\"command \\\"with spaces\\\"\","
+                          "\"file\":\"file1\"},"
+                          " {\"directory\":\"//net/dir\","
+                          "\"command\":\"command2\","
+                          "\"file\":\"file2\"}]");
+
+  // Without UseIndex no index is written.
+  std::string ErrorMessage;
+  std::string IndexPath = JSONCompilationDatabase::getIndexPath(DatabasePath);
+  std::unique_ptr<JSONCompilationDatabase> Database =
+      JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage);
+  ASSERT_TRUE((bool)Database) << ErrorMessage;
+  EXPECT_FALSE(llvm::sys::fs::exists(IndexPath));
+
+  // The first load with UseIndex scans the database and writes the index.
+  Database = JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage,
+                                                   /*UseIndex=*/true);
+  ASSERT_TRUE((bool)Database) << ErrorMessage;
+  std::string Index = readFile(IndexPath);
+  ASSERT_FALSE(Index.empty());
+
+  // The index holds the file paths, so renaming a file in it shows whether
+  // a load used the index. The new name keeps the files in path order.
+  size_t File1 = Index.find("file1");
+  ASSERT_NE(std::string::npos, File1);
+  Index.replace(File1, 5, "file0");
+  writeFile(IndexPath, Index);
+
+  std::unique_ptr<JSONCompilationDatabase> Indexed =
+      JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage,
+                                            /*UseIndex=*/true);
+  ASSERT_TRUE((bool)Indexed) << ErrorMessage;
+  std::vector<std::string> Files = Indexed->getAllFiles();
+  ASSERT_EQ(2u, Files.size());
+  EXPECT_EQ("file0", llvm::sys::path::filename(Files[0]));
+  EXPECT_EQ("file2", llvm::sys::path::filename(Files[1]));
+  std::vector<CompileCommand> Commands = Indexed->getAllCompileCommands();
+  ASSERT_EQ(2u, Commands.size());
+  EXPECT_EQ("//net/dir", Commands[0].Directory);
+  ASSERT_EQ(2u, Commands[0].CommandLine.size());
+  EXPECT_EQ("with spaces", Commands[0].CommandLine[1]);
+  ASSERT_EQ(1u, Commands[1].CommandLine.size());
+  EXPECT_EQ("command2", Commands[1].CommandLine[0]);
+  Commands = Indexed->getCompileCommands(Files[1]);
+  ASSERT_EQ(1u, Commands.size());
+  ASSERT_EQ(1u, Commands[0].CommandLine.size());
+  EXPECT_EQ("command2", Commands[0].CommandLine[0]);
+  Commands = Indexed->getCompileCommands(Files[0]);
+  ASSERT_EQ(1u, Commands.size());
+  ASSERT_EQ(2u, Commands[0].CommandLine.size());
+  EXPECT_EQ("with spaces", Commands[0].CommandLine[1]);
+
+  // An edit that keeps the size of the database but changes its
+  // modification time invalidates the index, which is rewritten.
+  llvm::sys::fs::file_status Status;
+  ASSERT_FALSE(llvm::sys::fs::status(DatabasePath, Status));
+  std::string Contents = readFile(DatabasePath);
+  size_t Command2 = Contents.find("command2");
+  ASSERT_NE(std::string::npos, Command2);
+  Contents.replace(Command2, 8, "commandZ");
+  writeFile(DatabasePath, Contents);
+  {
+    int FD;
+    ASSERT_FALSE(llvm::sys::fs::openFileForWrite(DatabasePath, FD,
+                                                 llvm::sys::fs::F_Append));
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    llvm::sys::TimeValue ModTime = Status.getLastModificationTime();
+    ModTime += llvm::sys::TimeValue(10, 0);
+    EXPECT_FALSE(llvm::sys::fs::setLastModificationAndAccessTime(FD, ModTime));
+  }
+
+  std::unique_ptr<JSONCompilationDatabase> Edited =
+      JSONCompilationDatabase::loadFromFile(DatabasePath, ErrorMessage,
+                                            /*UseIndex=*/true);
+  ASSERT_TRUE((bool)Edited) << ErrorMessage;
+  Files = Edited->getAllFiles();
+  ASSERT_EQ(2u, Files.size());
+  EXPECT_EQ("file1", llvm::sys::path::filename(Files[0]));
+  Commands = Edited->getAllCompileCommands();
+  ASSERT_EQ(2u, Commands.size());
+  ASSERT_EQ(1u, Commands[1].CommandLine.size());
+  EXPECT_EQ("commandZ", Commands[1].CommandLine[0]);
+  EXPECT_NE(std::string::npos, readFile(IndexPath).find("file1"));
+
+  llvm::sys::fs::remove(IndexPath);
+  llvm::sys::fs::remove(DatabasePath);
+  llvm::sys::fs::remove(TestDir);
+}
+
 static CompileCommand findCompileArgsInJsonDatabase(StringRef FileName,
                                                     StringRef JSONDatabase,
                                                     std::string &ErrorMessage) {
@@ -331,6 +445,15 @@ TEST(unescapeJsonCommandLine, UnescapesBackslashCharacters) {
   EXPECT_EQ("a\"", Quote[0]);
 }
 
+TEST(unescapeJsonCommandLine, UnescapesUnicodeCharacters) {
+  std::vector<std::string> Result =
+      unescapeJsonCommandLine("a\\u0062 \\u00e9 \\ud83d\\ude00");
+  ASSERT_EQ(3ul, Result.size());
+  EXPECT_EQ("ab", Result[0]);
+  EXPECT_EQ("\xc3\xa9", Result[1]);
+  EXPECT_EQ("\xf0\x9f\x98\x80", Result[2]);
+}
+
 TEST(unescapeJsonCommandLine, DoesNotMungeSpacesBetweenQuotes) {
   std::vector<std::string> Result = unescapeJsonCommandLine("\\\"  a  b  \\\"");
   ASSERT_EQ(1ul, Result.size());
@@ -20,6 +20,7 @@
 #include "llvm/Config/llvm-config.h"
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <atomic>
 #include <string>
 
 namespace clang {
@@ -308,6 +309,63 @@ TEST(ClangToolTest, BuildASTs) {
   EXPECT_EQ(2u, ASTs.size());
 }
 
+/// Counts the invocations it runs with a syntax-only action.
+class CountingToolAction : public ToolAction {
+public:
+  explicit CountingToolAction(unsigned &Count)
+      : Count(Count), Factory(newFrontendActionFactory<SyntaxOnlyAction>()) {}
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    ++Count;
+    return Factory->runInvocation(Invocation, Files, PCHContainerOps,
+                                  DiagConsumer);
+  }
+
+private:
+  unsigned &Count;
+  std::unique_ptr<FrontendActionFactory> Factory;
+};
+
+TEST(ClangToolTest, RunInParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+
+  std::vector<std::string> Sources;
+  Sources.push_back("/a.cc");
+  Sources.push_back("/b.cc");
+  Sources.push_back("/c.cc");
+  Sources.push_back("/d.cc");
+  ClangTool Tool(Compilations, Sources);
+
+  Tool.mapVirtualFile("/a.cc", "void a() {}");
+  Tool.mapVirtualFile("/b.cc", "void b() {}");
+  Tool.mapVirtualFile("/c.cc", "void c() {}");
+  Tool.mapVirtualFile("/d.cc", "void d() {}");
+
+  std::atomic<unsigned> NumActions(0);
+  std::vector<unsigned> Counts(2, 0);
+  EXPECT_EQ(0, Tool.runInParallel(
+                   [&](unsigned ThreadIndex) -> std::unique_ptr<ToolAction> {
+                     ++NumActions;
+                     return llvm::make_unique<CountingToolAction>(
+                         Counts[ThreadIndex]);
+                   },
+                   2));
+  EXPECT_EQ(2u, NumActions);
+  EXPECT_EQ(4u, Counts[0] + Counts[1]);
+
+  Tool.mapVirtualFile("/b.cc", "int b = undeclared;");
+  Counts.assign(2, 0);
+  EXPECT_EQ(1, Tool.runInParallel(
+                   [&](unsigned ThreadIndex) -> std::unique_ptr<ToolAction> {
+                     return llvm::make_unique<CountingToolAction>(
+                         Counts[ThreadIndex]);
+                   },
+                   2));
+  EXPECT_EQ(4u, Counts[0] + Counts[1]);
+}
+
 struct TestDiagnosticConsumer : public DiagnosticConsumer {
   TestDiagnosticConsumer() : NumDiagnosticsSeen(0) {}
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,